@@ -0,0 +1,1220 @@
+#include "ConfigurationHelper.hpp"
+#include "PkgConfigHelper.hpp"
+#include "PluginHelper.hpp"
+#include "TypeRegistry.hpp"
+#include "Deployment.hpp"
+#include "Spawner.hpp"
+#include "CorbaNameService.hpp"
+#include "LoggingHelper.hpp"
+#include "OrbProfile.hpp"
+#include "PartialTaskContextProxy.hpp"
+#include "PropertySnapshot.hpp"
+#include "ConfigSectionIndex.hpp"
+#include "CompactConfig.hpp"
+#include "KnownBaseTypes.hpp"
+#include "ComponentHost.hpp"
+
+#include <typelib/registry.hh>
+#include <typelib/typemodel.hh>
+#include <typelib/value_ops.hh>
+#include <lib_config/YAMLConfiguration.hpp>
+#include <rtt/OutputPort.hpp>
+#include <rtt/InputPort.hpp>
+#include <rtt/Property.hpp>
+#include <rtt/OperationCaller.hpp>
+#include <rtt/transports/corba/TaskContextServer.hpp>
+#include <rtt/transports/corba/TaskContextProxy.hpp>
+#include <rtt/transports/corba/corba.h>
+#include <rtt/transports/mqueue/MQLib.hpp>
+
+#include <base/Time.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <cstdlib>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define xstr(s) str(s)
+#define str(s) #s
+
+/**
+ * Benchmark for the hot paths of orocos_cpp.
+ *
+ * All offline cases run on synthetic fixtures (generated pkg-config
+ * files, typelists, deployments and config files) in a temporary
+ * directory. The online cases need a name service, which can be
+ * started locally using --omninames.
+ *
+ * The cases spawn and log start the local name service themselves and
+ * use a stub deployment of the fixture. It is this executable, hosting a
+ * task with some output ports and a logger, so no installed orogen
+ * model is needed. --spawn and --log measure installed models instead.
+ *
+ * usage: benchmark [--iterations N] [--omninames] [--proxy] [--transport]
+ *                  [--orb] [--spawn model] [--log model] [case...]
+ * */
+
+//counts the heap allocations of the whole process, see countAllocations
+static std::atomic<size_t> allocationCount(0);
+
+void *operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void *p = std::malloc(size ? size : 1);
+    if(!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+using namespace orocos_cpp;
+using namespace libConfig;
+
+namespace
+{
+
+size_t iterations = 100;
+
+void report(const std::string &name, std::vector<base::Time> samples, size_t itemsPerIteration)
+{
+    if(samples.empty())
+        return;
+
+    std::sort(samples.begin(), samples.end());
+
+    base::Time sum;
+    for(const base::Time &t: samples)
+        sum = sum + t;
+
+    double mean = sum.toSeconds() / samples.size();
+    double median = samples[samples.size() / 2].toSeconds();
+
+    std::cout << std::left << std::setw(36) << name << std::right << std::fixed << std::setprecision(1)
+              << " min " << std::setw(10) << samples.front().toSeconds() * 1e6 << " us"
+              << " median " << std::setw(10) << median * 1e6 << " us"
+              << " mean " << std::setw(10) << mean * 1e6 << " us"
+              << " max " << std::setw(10) << samples.back().toSeconds() * 1e6 << " us";
+    if(mean > 0)
+        std::cout << std::setprecision(0) << " " << std::setw(12) << itemsPerIteration / mean << " items/s";
+    std::cout << std::endl;
+}
+
+std::vector<base::Time> measure(size_t count, const std::function<void ()> &func)
+{
+    //warm up caches
+    func();
+
+    std::vector<base::Time> samples;
+    samples.reserve(count);
+    for(size_t i = 0; i < count; i++)
+    {
+        base::Time start = base::Time::now();
+        func();
+        samples.push_back(base::Time::now() - start);
+    }
+    return samples;
+}
+
+/**
+ * Allocations of one call of func, after a warm up call
+ * */
+size_t countAllocations(const std::function<void ()> &func)
+{
+    func();
+    const size_t before = allocationCount.load();
+    func();
+    return allocationCount.load() - before;
+}
+
+void reportAllocations(const std::string &name, size_t allocations)
+{
+    std::cout << std::left << std::setw(36) << name << std::right << " " << std::setw(10) << allocations << " allocations" << std::endl;
+}
+
+/**
+ * Temporary directory tree, mimicking an installation
+ * */
+class Fixture
+{
+public:
+    static const size_t NUM_COMPONENTS = 200;
+    static const size_t NUM_TYPEKITS = 50;
+    static const size_t TYPES_PER_TYPEKIT = 400;
+
+    boost::filesystem::path root;
+
+    Fixture() : root(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("orocos_cpp_bench-%%%%-%%%%"))
+    {
+        boost::filesystem::create_directories(root / "lib" / "pkgconfig");
+        boost::filesystem::create_directories(root / "share" / "orogen");
+        boost::filesystem::create_directories(root / "share" / "install");
+        boost::filesystem::create_directories(root / "bin");
+        for(size_t i = 0; i < 4; i++)
+            boost::filesystem::create_directories(root / ("empty" + boost::lexical_cast<std::string>(i)));
+
+        writePkgConfigFiles();
+        writeStubDeployment();
+        writeTypelists();
+        setupEnvironment();
+    }
+
+    ~Fixture()
+    {
+        boost::system::error_code ec;
+        boost::filesystem::remove_all(root, ec);
+    }
+
+    static std::string componentName(size_t i)
+    {
+        return "bench" + boost::lexical_cast<std::string>(i);
+    }
+
+    static std::string deploymentName(size_t i)
+    {
+        return "bench_deployment_" + boost::lexical_cast<std::string>(i);
+    }
+
+    ///model of the stub deployment, see runStubDeployment
+    static std::string stubModel()
+    {
+        return "orocos_cpp_bench::Task";
+    }
+
+    static std::string stubDeploymentName()
+    {
+        return "orogen_default_orocos_cpp_bench__Task";
+    }
+
+    static std::string typeName(size_t typekit, size_t type)
+    {
+        return "/" + componentName(typekit) + "/Type" + boost::lexical_cast<std::string>(type);
+    }
+
+    /**
+     * Writes a config file with a section 'default' and the given number
+     * of additional sections 'site_<n>' of the same size
+     * */
+    std::string writeConfigFile(size_t segments, size_t pointsPerSegment, size_t extraSections = 0) const
+    {
+        std::string fileName = (root / (extraSections ? "bench_sections.yml" : "bench.yml")).string();
+        std::ofstream out(fileName.c_str());
+        for(size_t section = 0; section <= extraSections; section++)
+        {
+            out << "--- name:" << (section ? "site_" + boost::lexical_cast<std::string>(section) : std::string("default")) << std::endl;
+            out << "map:" << std::endl;
+            out << "  scale: 1.5" << std::endl;
+            out << "  segments:" << std::endl;
+            for(size_t s = 0; s < segments; s++)
+            {
+                out << "  - name: segment_" << s << std::endl;
+                out << "    fixed: [";
+                for(size_t f = 0; f < 16; f++)
+                    out << (f ? ", " : "") << f * 0.25;
+                out << "]" << std::endl;
+                out << "    points:" << std::endl;
+                for(size_t p = 0; p < pointsPerSegment; p++)
+                {
+                    out << "    - x: " << p * 0.1 << std::endl;
+                    out << "      y: " << s * 0.2 << std::endl;
+                    out << "      z: -" << p * 0.3 << std::endl;
+                    out << "      id: " << p << std::endl;
+                    out << "      mode: " << ((p % 2) ? ":MODE_A" : ":MODE_B") << std::endl;
+                }
+            }
+        }
+        return fileName;
+    }
+
+private:
+    void writeFillerLines(std::ostream &out) const
+    {
+        out << "prefix=" << root.string() << std::endl;
+        out << "exec_prefix=${prefix}" << std::endl;
+        out << "libdir=${prefix}/lib" << std::endl;
+        out << "includedir=${prefix}/include" << std::endl << std::endl;
+        out << "Name: generated" << std::endl;
+        out << "Description: synthetic pkg-config file for the orocos_cpp benchmark" << std::endl;
+        out << "Version: 0.0" << std::endl;
+        out << "Requires: orocos-rtt-gnulinux typelib" << std::endl;
+        out << "Libs: -L${libdir} -lgenerated" << std::endl;
+        out << "Cflags: -I${includedir}" << std::endl;
+    }
+
+    void writePkgConfigFiles() const
+    {
+        boost::filesystem::path pcDir = root / "lib" / "pkgconfig";
+        for(size_t i = 0; i < NUM_COMPONENTS; i++)
+        {
+            std::string typekits;
+            for(size_t t = 0; t < 8; t++)
+                typekits += (t ? " " : "") + componentName((i + t) % NUM_TYPEKITS);
+
+            {
+                std::ofstream out((pcDir / (componentName(i) + "-tasks-" xstr(OROCOS_TARGET) ".pc")).string().c_str());
+                writeFillerLines(out);
+                out << "typekits=" << typekits << std::endl;
+            }
+
+            {
+                std::string dpl = deploymentName(i);
+                std::ofstream out((pcDir / ("orogen-" + dpl + ".pc")).string().c_str());
+                writeFillerLines(out);
+                out << "typekits=" << typekits << std::endl;
+                out << "deployed_tasks=" << dpl << "_Task," << dpl << "_Logger" << std::endl;
+
+                std::ofstream exec((root / "bin" / dpl).string().c_str());
+                exec << "#!/bin/sh" << std::endl;
+            }
+        }
+    }
+
+    /**
+     * The default deployment of stubModel(), a script executing
+     * this benchmark with --stub-deployment
+     * */
+    void writeStubDeployment() const
+    {
+        const std::string dpl = stubDeploymentName();
+        {
+            std::ofstream out((root / "lib" / "pkgconfig" / ("orogen-" + dpl + ".pc")).string().c_str());
+            writeFillerLines(out);
+            out << "typekits=" << std::endl;
+            out << "deployed_tasks=" << dpl << "," << dpl << "_Logger" << std::endl;
+        }
+
+        const boost::filesystem::path script = root / "bin" / dpl;
+        {
+            std::ofstream out(script.string().c_str());
+            out << "#!/bin/sh" << std::endl;
+            out << "exec '" << boost::filesystem::read_symlink("/proc/self/exe").string() << "' --stub-deployment \"$@\"" << std::endl;
+        }
+        boost::filesystem::permissions(script, boost::filesystem::owner_all | boost::filesystem::group_read | boost::filesystem::group_exe);
+    }
+
+    void writeTypelists() const
+    {
+        for(size_t tk = 0; tk < NUM_TYPEKITS; tk++)
+        {
+            std::ofstream out((root / "share" / "orogen" / (componentName(tk) + ".typelist")).string().c_str());
+            for(size_t t = 0; t < TYPES_PER_TYPEKIT; t++)
+                out << typeName(tk, t) << " " << (t % 7 == 0) << std::endl;
+        }
+    }
+
+    void setupEnvironment() const
+    {
+        //put some empty directories in front, as found in real installations
+        std::string pkgConfigPath;
+        for(size_t i = 0; i < 4; i++)
+            pkgConfigPath += (root / ("empty" + boost::lexical_cast<std::string>(i))).string() + ":";
+        pkgConfigPath += (root / "lib" / "pkgconfig").string();
+
+        const char *oldPkgConfigPath = getenv("PKG_CONFIG_PATH");
+        if(oldPkgConfigPath)
+            pkgConfigPath += std::string(":") + oldPkgConfigPath;
+        setenv("PKG_CONFIG_PATH", pkgConfigPath.c_str(), 1);
+
+        //TypeRegistry searches in ROCK_PREFIX/../orogen
+        setenv("ROCK_PREFIX", (root / "share" / "install").string().c_str(), 1);
+
+        std::string path = (root / "bin").string();
+        const char *oldPath = getenv("PATH");
+        if(oldPath)
+            path += std::string(":") + oldPath;
+        setenv("PATH", path.c_str(), 1);
+
+        //the spawner and the logger write into the log directory of the bundle
+        if(!getenv("ROCK_BUNDLE"))
+        {
+            boost::filesystem::create_directories(root / "bundles" / "bench_bundle" / "config" / "orogen");
+            boost::filesystem::create_directories(root / "bundles" / "bench_bundle" / "logs");
+            setenv("ROCK_BUNDLE_PATH", (root / "bundles").string().c_str(), 1);
+            setenv("ROCK_BUNDLE", "bench_bundle", 1);
+        }
+    }
+};
+
+/**
+ * Task of the stub deployment, a few output ports of a type of rtt-types
+ * */
+class StubTask : public RTT::TaskContext
+{
+public:
+    static const size_t NUM_PORTS = 10;
+
+    explicit StubTask(const std::string &name) : RTT::TaskContext(name)
+    {
+        for(size_t i = 0; i < NUM_PORTS; i++)
+        {
+            outputs.push_back(new RTT::OutputPort<double>("out" + boost::lexical_cast<std::string>(i)));
+            addPort(*outputs.back());
+        }
+        addOperation("getModelName", &StubTask::getModelName, this, RTT::ClientThread);
+    }
+
+    ~StubTask()
+    {
+        ports()->clear();
+        for(RTT::OutputPort<double> *port: outputs)
+            delete port;
+    }
+
+    std::string getModelName() const
+    {
+        return Fixture::stubModel();
+    }
+
+private:
+    std::vector<RTT::OutputPort<double> *> outputs;
+};
+
+/**
+ * Main of the stub deployment. Understands the --rename arguments of
+ * the Spawner, everything else is passed to the ORB. Registers the task
+ * and a real logger at the name service, until SIGINT or SIGTERM.
+ * */
+int runStubDeployment(int argc, char **argv)
+{
+    std::string taskName = Fixture::stubDeploymentName();
+    std::string loggerName = taskName + "_Logger";
+    std::vector<char *> orbArgs(1, argv[0]);
+    for(int i = 2; i < argc; i++)
+    {
+        std::string arg(argv[i]);
+        if(arg == "--rename" && i + 1 < argc)
+        {
+            std::string rename(argv[++i]);
+            std::string::size_type pos = rename.find(':');
+            if(pos == std::string::npos)
+                continue;
+            if(rename.substr(0, pos) == taskName)
+                taskName = rename.substr(pos + 1);
+            else if(rename.substr(0, pos) == loggerName)
+                loggerName = rename.substr(pos + 1);
+            continue;
+        }
+        orbArgs.push_back(argv[i]);
+    }
+    int orbArgc = orbArgs.size();
+    orbArgs.push_back(nullptr);
+
+    try {
+        //before ComponentHost, which would initialize the ORB with the default profile
+        RTT::corba::TaskContextServer::InitOrb(orbArgc, orbArgs.data());
+        PluginHelper::loadTypekitAndTransports("rtt-types");
+
+        ComponentHost host;
+        host.createTask("logger::Logger", loggerName);
+
+        StubTask task(taskName);
+        if(!RTT::corba::TaskContextServer::Create(&task))
+            throw std::runtime_error("could not create the CORBA server of " + taskName);
+
+        host.runUntilSignal();
+    } catch (const std::exception &e)
+    {
+        std::cout << "Benchmark stub deployment: Error, " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * A nested Typelib type, containing strings, vectors, arrays, enums and numerics
+ * */
+class BenchmarkTypes
+{
+public:
+    Typelib::Registry registry;
+    const Typelib::Type *mapType;
+    const Typelib::Type *poseType;
+    const Typelib::Type *doubleVectorType;
+
+    BenchmarkTypes()
+    {
+        Typelib::Numeric *dbl = new Typelib::Numeric("/double", sizeof(double), Typelib::Numeric::Float);
+        registry.add(dbl);
+        Typelib::Numeric *int32 = new Typelib::Numeric("/int32_t", sizeof(int32_t), Typelib::Numeric::SInt);
+        registry.add(int32);
+        Typelib::Numeric *int8 = new Typelib::Numeric("/int8_t", sizeof(int8_t), Typelib::Numeric::SInt);
+        registry.add(int8);
+
+        Typelib::Enum *mode = new Typelib::Enum("/bench/Mode");
+        mode->add("MODE_A", 0);
+        mode->add("MODE_B", 1);
+        registry.add(mode);
+
+        Typelib::Compound *point = new Typelib::Compound("/bench/Point");
+        point->addField("x", *dbl, 0);
+        point->addField("y", *dbl, 8);
+        point->addField("z", *dbl, 16);
+        point->addField("id", *int32, 24);
+        point->addField("mode", *mode, 28);
+        point->setSize(32);
+        registry.add(point);
+
+        const Typelib::Type &fixed = *registry.build("/double[16]");
+        const Typelib::Container &string = Typelib::Container::createContainer(registry, "/std/string", *int8);
+        const Typelib::Container &points = Typelib::Container::createContainer(registry, "/std/vector", *point);
+
+        Typelib::Compound *segment = new Typelib::Compound("/bench/Segment");
+        size_t offset = 0;
+        segment->addField("name", string, offset);
+        offset += string.getSize();
+        segment->addField("points", points, offset);
+        offset += points.getSize();
+        segment->addField("fixed", fixed, offset);
+        offset += fixed.getSize();
+        segment->setSize(offset);
+        registry.add(segment);
+
+        const Typelib::Container &segments = Typelib::Container::createContainer(registry, "/std/vector", *segment);
+
+        Typelib::Compound *map = new Typelib::Compound("/bench/Map");
+        map->addField("segments", segments, 0);
+        map->addField("scale", *dbl, segments.getSize());
+        map->setSize(segments.getSize() + sizeof(double));
+        registry.add(map);
+
+        mapType = map;
+
+        //a pose in the layout of the base marshalling types
+        Typelib::Numeric *int64 = new Typelib::Numeric("/int64_t", sizeof(int64_t), Typelib::Numeric::SInt);
+        registry.add(int64);
+
+        Typelib::Compound *time = new Typelib::Compound("/bench/Time");
+        time->addField("microseconds", *int64, 0);
+        time->setSize(sizeof(int64_t));
+        registry.add(time);
+
+        Typelib::Compound *vector = new Typelib::Compound("/bench/Vector3");
+        vector->addField("data", *registry.build("/double[3]"), 0);
+        vector->setSize(3 * sizeof(double));
+        registry.add(vector);
+
+        Typelib::Compound *quaternion = new Typelib::Compound("/bench/Quaternion");
+        quaternion->addField("im", *registry.build("/double[3]"), 0);
+        quaternion->addField("re", *dbl, 3 * sizeof(double));
+        quaternion->setSize(4 * sizeof(double));
+        registry.add(quaternion);
+
+        Typelib::Compound *matrix = new Typelib::Compound("/bench/Matrix3");
+        matrix->addField("data", *registry.build("/double[9]"), 0);
+        matrix->setSize(9 * sizeof(double));
+        registry.add(matrix);
+
+        Typelib::Compound *pose = new Typelib::Compound("/bench/Pose");
+        offset = 0;
+        pose->addField("time", *time, offset);
+        offset += time->getSize();
+        pose->addField("frame", string, offset);
+        offset += string.getSize();
+        pose->addField("position", *vector, offset);
+        offset += vector->getSize();
+        pose->addField("orientation", *quaternion, offset);
+        offset += quaternion->getSize();
+        pose->addField("cov_position", *matrix, offset);
+        offset += matrix->getSize();
+        pose->setSize(offset);
+        registry.add(pose);
+
+        poseType = pose;
+
+        doubleVectorType = &Typelib::Container::createContainer(registry, "/std/vector", *dbl);
+    }
+};
+
+/**
+ * C++ counterpart of /bench/Pose, applied through its compiled field table
+ * */
+struct BenchPose
+{
+    base::Time time;
+    std::string frame;
+    base::Vector3d position;
+    base::Quaterniond orientation;
+    base::Matrix3d cov_position;
+};
+
+namespace orocos_cpp
+{
+template <>
+struct KnownType<BenchPose>
+{
+    template <typename Visitor>
+    static bool visitFields(BenchPose &value, Visitor &visitor)
+    {
+        return visitor.field("time", value.time)
+            && visitor.field("frame", value.frame)
+            && visitor.field("position", value.position)
+            && visitor.field("orientation", value.orientation)
+            && visitor.field("cov_position", value.cov_position);
+    }
+};
+}
+
+void benchPkgConfig(const Fixture &)
+{
+    std::vector<std::string> fields;
+    fields.push_back("typekits");
+    fields.push_back("deployed_tasks");
+
+    report("parsePkgConfig", measure(iterations, [&fields]() {
+        std::vector<std::string> values;
+        for(size_t i = 0; i < Fixture::NUM_COMPONENTS; i++)
+            PkgConfigHelper::parsePkgConfig("orogen-" + Fixture::deploymentName(i) + ".pc", fields, values);
+    }), Fixture::NUM_COMPONENTS);
+}
+
+void benchTypelist(const Fixture &)
+{
+    report("TypeRegistry::loadTypelist", measure(iterations / 10 + 1, []() {
+        TypeRegistry registry;
+        registry.loadTypelist();
+    }), Fixture::NUM_TYPEKITS * Fixture::TYPES_PER_TYPEKIT);
+
+    TypeRegistry registry;
+    registry.loadTypelist();
+
+    std::vector<std::string> names;
+    for(size_t tk = 0; tk < Fixture::NUM_TYPEKITS; tk++)
+        for(size_t t = 0; t < Fixture::TYPES_PER_TYPEKIT; t += 13)
+            names.push_back(Fixture::typeName(tk, t));
+    std::random_shuffle(names.begin(), names.end());
+
+    report("getTypekitDefiningType", measure(iterations, [&registry, &names]() {
+        std::string typekit;
+        for(const std::string &name: names)
+            if(!registry.getTypekitDefiningType(name, typekit))
+                throw std::runtime_error("Benchmark: type " + name + " not found");
+    }), names.size());
+}
+
+void benchDeployment(const Fixture &)
+{
+    report("Deployment construction", measure(iterations / 10 + 1, []() {
+        for(size_t i = 0; i < Fixture::NUM_COMPONENTS; i++)
+            Deployment dpl(Fixture::deploymentName(i));
+    }), Fixture::NUM_COMPONENTS);
+}
+
+void benchConfig(const Fixture &fixture)
+{
+    const size_t segments = 50;
+    const size_t pointsPerSegment = 200;
+    std::string fileName = fixture.writeConfigFile(segments, pointsPerSegment);
+
+    std::map<std::string, Configuration> subConfigs;
+    report("YAMLConfigParser::loadConfigFile", measure(iterations / 10 + 1, [&fileName, &subConfigs]() {
+        subConfigs.clear();
+        YAMLConfigParser parser;
+        parser.loadConfigFile(fileName, subConfigs);
+    }), segments * pointsPerSegment);
+
+    //a file with many sections, of which only two are used
+    const size_t sections = 20;
+    std::string sectionsFileName = fixture.writeConfigFile(segments / 10, pointsPerSegment, sections - 1);
+    report("loadConfigFile all sections", measure(iterations / 10 + 1, [&sectionsFileName]() {
+        std::map<std::string, Configuration> configs;
+        YAMLConfigParser parser;
+        parser.loadConfigFile(sectionsFileName, configs);
+    }), sections);
+
+    std::vector<std::string> names;
+    names.push_back("default");
+    names.push_back("site_7");
+    report("ConfigSectionIndex::loadSections", measure(iterations / 10 + 1, [&sectionsFileName, &names]() {
+        std::map<std::string, Configuration> configs;
+        if(!ConfigSectionIndex::loadSections(sectionsFileName, names, configs) || configs.size() != 2)
+            throw std::runtime_error("Benchmark: loading the config sections failed");
+    }), names.size());
+
+    //what applyConfig(file) does per call, parsing and converting the
+    //sections every time versus the cached compact form
+    std::function<void ()> uncachedSections([&sectionsFileName, &names]() {
+        std::map<std::string, Configuration> configs;
+        ConfigSectionIndex::loadSections(sectionsFileName, names, configs);
+        CompactConfig compact;
+        for(const std::string &name: names)
+            compact.addSection(configs.at(name));
+        CompactConfigValue view(compact, names);
+        if(view.getFieldNames().empty())
+            throw std::runtime_error("Benchmark: the config sections are empty");
+    });
+    ConfigurationHelper helper;
+    std::function<void ()> cachedSections([&helper, &sectionsFileName, &names]() {
+        std::shared_ptr<const CompactConfig> compact(helper.getCompactConfig(sectionsFileName, names));
+        CompactConfigValue view(*compact, names);
+        if(view.getFieldNames().empty())
+            throw std::runtime_error("Benchmark: the config sections are empty");
+    });
+    report("config sections uncached", measure(iterations / 10 + 1, uncachedSections), names.size());
+    report("getCompactConfig cached", measure(iterations, cachedSections), names.size());
+    reportAllocations("config sections uncached", countAllocations(uncachedSections));
+    reportAllocations("getCompactConfig cached", countAllocations(cachedSections));
+
+    const ConfigValue &conf(*subConfigs.at("default").getValues().at("map"));
+
+    BenchmarkTypes types;
+    std::vector<uint8_t> buffer(types.mapType->getSize());
+
+    report("applyConfOnTyplibValue", measure(iterations, [&types, &buffer, &conf]() {
+        Typelib::Value value(buffer.data(), *types.mapType);
+        Typelib::init(value);
+        bool ok = ConfigurationHelper::applyConfigValueOnTypelibValue(value, conf);
+        Typelib::destroy(value);
+        if(!ok)
+            throw std::runtime_error("Benchmark: applying the config failed");
+    }), segments * pointsPerSegment);
+
+    report("CompactConfig::addSection", measure(iterations, [&subConfigs]() {
+        CompactConfig compact;
+        compact.addSection(subConfigs.at("default"));
+    }), segments * pointsPerSegment);
+
+    CompactConfig compact;
+    compact.addSection(subConfigs.at("default"));
+    CompactConfigValue compactRoot(compact, std::vector<std::string>(1, "default"));
+    CompactConfigValue compactConf(compactRoot);
+    compactRoot.getField("map", compactConf);
+
+    report("applyConfOnTyplibValue compact", measure(iterations, [&types, &buffer, &compactConf]() {
+        Typelib::Value value(buffer.data(), *types.mapType);
+        Typelib::init(value);
+        bool ok = ConfigurationHelper::applyConfigValueOnTypelibValue(value, compactConf);
+        Typelib::destroy(value);
+        if(!ok)
+            throw std::runtime_error("Benchmark: applying the compact config failed");
+    }), segments * pointsPerSegment);
+
+    //a small fixed type, interpreted versus compiled
+    std::map<std::string, Configuration> poseConfigs;
+    YAMLConfigParser parser;
+    parser.loadConfigString("--- name:default\n"
+                            "pose:\n"
+                            "  time:\n"
+                            "    microseconds: 1000\n"
+                            "  frame: body\n"
+                            "  position:\n"
+                            "    data: [1.0, 2.0, 3.0]\n"
+                            "  orientation:\n"
+                            "    im: [0.0, 0.0, 0.0]\n"
+                            "    re: 1.0\n"
+                            "  cov_position:\n"
+                            "    data: [1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0]\n", poseConfigs);
+    CompactConfig poseCompact;
+    poseCompact.addSection(poseConfigs.at("default"));
+    CompactConfigValue poseRoot(poseCompact, std::vector<std::string>(1, "default"));
+    CompactConfigValue poseConf(poseRoot);
+    poseRoot.getField("pose", poseConf);
+
+    std::vector<uint8_t> poseBuffer(types.poseType->getSize());
+    report("applyConfOnTyplibValue pose", measure(iterations * 10, [&types, &poseBuffer, &poseConf]() {
+        Typelib::Value value(poseBuffer.data(), *types.poseType);
+        Typelib::init(value);
+        bool ok = ConfigurationHelper::applyConfigValueOnTypelibValue(value, poseConf);
+        Typelib::destroy(value);
+        if(!ok)
+            throw std::runtime_error("Benchmark: applying the pose config failed");
+    }), 1);
+
+    report("applyKnownType pose", measure(iterations * 10, [&poseConf]() {
+        BenchPose pose;
+        std::vector<std::string> errors;
+        if(!applyKnownType(pose, poseConf, errors))
+            throw std::runtime_error("Benchmark: applying the pose config failed");
+    }), 1);
+
+    //a dense numeric array
+    const size_t numbers = 1000000;
+    std::string numbersYAML("--- name:default\nvalues: [");
+    for(size_t i = 0; i < numbers; i++)
+        numbersYAML += (i ? ", " : "") + boost::lexical_cast<std::string>(i) + "." + boost::lexical_cast<std::string>(i % 1000);
+    numbersYAML += "]\n";
+    std::map<std::string, Configuration> numberConfigs;
+    parser.loadConfigString(numbersYAML, numberConfigs);
+    const ConfigValue &numbersConf(*numberConfigs.at("default").getValues().at("values"));
+
+    report("lexical_cast 1M doubles", measure(3, [&numbersConf]() {
+        double sum = 0;
+        for(const std::shared_ptr<ConfigValue> &value: dynamic_cast<const ArrayConfigValue &>(numbersConf).getValues())
+            sum += boost::lexical_cast<double>(dynamic_cast<const SimpleConfigValue &>(*value).getValue());
+        if(sum < 0)
+            throw std::runtime_error("Benchmark: unexpected sum");
+    }), numbers);
+
+    std::vector<uint8_t> vectorBuffer(types.doubleVectorType->getSize());
+    report("applyConfOnTyplibValue 1M doubles", measure(3, [&types, &vectorBuffer, &numbersConf]() {
+        Typelib::Value value(vectorBuffer.data(), *types.doubleVectorType);
+        Typelib::init(value);
+        bool ok = ConfigurationHelper::applyConfigValueOnTypelibValue(value, numbersConf);
+        Typelib::destroy(value);
+        if(!ok)
+            throw std::runtime_error("Benchmark: applying the numbers failed");
+    }), numbers);
+
+    CompactConfig numbersCompact;
+    numbersCompact.addSection(numberConfigs.at("default"));
+    CompactConfigValue numbersRoot(numbersCompact, std::vector<std::string>(1, "default"));
+    CompactConfigValue numbersCompactConf(numbersRoot);
+    numbersRoot.getField("values", numbersCompactConf);
+
+    report("applyConfOnTyplibValue compact 1M doubles", measure(3, [&types, &vectorBuffer, &numbersCompactConf]() {
+        Typelib::Value value(vectorBuffer.data(), *types.doubleVectorType);
+        Typelib::init(value);
+        bool ok = ConfigurationHelper::applyConfigValueOnTypelibValue(value, numbersCompactConf);
+        Typelib::destroy(value);
+        if(!ok)
+            throw std::runtime_error("Benchmark: applying the compact numbers failed");
+    }), numbers);
+}
+
+/**
+ * Uses the process wide caches from several threads at once, while the
+ * TypeRegistry is loaded. Build with -DSANITIZE_THREAD=ON to check this
+ * case with ThreadSanitizer.
+ * */
+void benchStress(const Fixture &)
+{
+    const size_t numThreads = std::max(4u, std::thread::hardware_concurrency());
+    TypeRegistry registry;
+    std::atomic<size_t> failures(0);
+
+    auto worker = [&registry, &failures](size_t id) {
+        for(size_t i = 0; i < iterations; i++)
+        {
+            size_t component = (id * 7 + i) % Fixture::NUM_COMPONENTS;
+            if(PluginHelper::getNeededTypekits(Fixture::componentName(component)).size() != 8)
+                failures++;
+
+            Deployment dpl(Fixture::deploymentName(component));
+            if(dpl.getNeededTypekits().size() != 8 || dpl.getTaskNames().size() != 2)
+                failures++;
+
+            std::string typekit;
+            if(!registry.getTypekitDefiningType("int", typekit) || typekit != "rtt-types")
+                failures++;
+
+            //may not be loaded yet
+            registry.getTypekitDefiningType(Fixture::typeName(component % Fixture::NUM_TYPEKITS, i % Fixture::TYPES_PER_TYPEKIT), typekit);
+        }
+    };
+
+    std::vector<base::Time> samples;
+    base::Time start = base::Time::now();
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < numThreads; i++)
+        threads.push_back(std::thread(worker, i));
+    registry.loadTypelist();
+    for(std::thread &thread: threads)
+        thread.join();
+    samples.push_back(base::Time::now() - start);
+
+    report("stress " + boost::lexical_cast<std::string>(numThreads) + " threads", samples, numThreads * iterations);
+
+    std::string typekit;
+    if(!registry.getTypekitDefiningType(Fixture::typeName(Fixture::NUM_TYPEKITS - 1, 0), typekit))
+        failures++;
+    if(failures)
+        throw std::runtime_error("Benchmark: " + boost::lexical_cast<std::string>(failures.load()) + " inconsistent results in stress test");
+}
+
+pid_t startOmniNames(const Fixture &fixture)
+{
+    const std::string port("12777");
+    boost::filesystem::path dataDir = fixture.root / "omninames";
+    boost::filesystem::create_directories(dataDir);
+
+    pid_t pid = fork();
+    if(pid < 0)
+        throw std::runtime_error("Benchmark: fork failed");
+
+    if(pid == 0)
+    {
+        execlp("omniNames", "omniNames", "-start", port.c_str(), "-datadir", dataDir.string().c_str(), (char *) nullptr);
+        std::cout << "Benchmark: Error, could not start omniNames" << std::endl;
+        _exit(EXIT_FAILURE);
+    }
+
+    //omniORB reads its configuration parameters from the environment as well
+    setenv("ORBInitRef", ("NameService=corbaname::127.0.0.1:" + port).c_str(), 1);
+    usleep(500000);
+    return pid;
+}
+
+void benchProxy()
+{
+    const size_t numPorts = 200;
+    const size_t numProperties = 200;
+
+    PluginHelper::loadTypekitAndTransports("rtt-types");
+
+    RTT::TaskContext task("orocos_cpp_bench_task");
+    std::vector<RTT::base::PortInterface *> ports;
+    std::vector<RTT::base::PropertyBase *> properties;
+    for(size_t i = 0; i < numPorts; i++)
+    {
+        RTT::base::PortInterface *port;
+        if(i % 2)
+            port = new RTT::OutputPort<double>("out" + boost::lexical_cast<std::string>(i));
+        else
+            port = new RTT::InputPort<double>("in" + boost::lexical_cast<std::string>(i));
+        task.ports()->addPort(*port);
+        ports.push_back(port);
+    }
+    for(size_t i = 0; i < numProperties; i++)
+    {
+        RTT::Property<double> *prop = new RTT::Property<double>("prop" + boost::lexical_cast<std::string>(i), "", i);
+        task.properties()->addProperty(*prop);
+        properties.push_back(prop);
+    }
+
+    RTT::corba::TaskContextServer::Create(&task, true);
+
+    report("TaskContextProxy::Create", measure(iterations / 10 + 1, [&task]() {
+        delete RTT::corba::TaskContextProxy::Create(task.getName(), false);
+    }), numPorts + numProperties);
+
+    report("PartialTaskContextProxy one port", measure(iterations, [&task]() {
+        PartialTaskContextProxy *proxy = PartialTaskContextProxy::Create(task.getName(), false);
+        proxy->fetchPort("out1");
+        delete proxy;
+    }), 1);
+
+    report("PartialTaskContextProxy output ports", measure(iterations / 10 + 1, [&task]() {
+        delete PartialTaskContextProxy::Create(task.getName(), false, PartialTaskContextProxy::OUTPUT_PORTS);
+    }), numPorts / 2);
+
+    report("PartialTaskContextProxy properties", measure(iterations / 10 + 1, [&task]() {
+        delete PartialTaskContextProxy::Create(task.getName(), false, PartialTaskContextProxy::PROPERTIES);
+    }), numProperties);
+
+    PropertySnapshot snapshot;
+    report("PropertySnapshot::addTask", measure(iterations, [&task, &snapshot]() {
+        snapshot.addTask(&task);
+    }), numProperties);
+
+    report("PropertySnapshot::restore", measure(iterations, [&task, &snapshot]() {
+        snapshot.restore(&task);
+    }), numProperties);
+
+    PartialTaskContextProxy *proxy = PartialTaskContextProxy::Create(task.getName(), false, PartialTaskContextProxy::PROPERTIES);
+    report("PropertySnapshot::restore remote", measure(iterations / 10 + 1, [proxy, &snapshot]() {
+        snapshot.restore(proxy);
+    }), numProperties);
+    delete proxy;
+
+    RTT::corba::TaskContextServer::CleanupServer(&task);
+    for(RTT::base::PortInterface *port: ports)
+    {
+        task.ports()->removePort(port->getName());
+        delete port;
+    }
+    for(RTT::base::PropertyBase *prop: properties)
+    {
+        task.properties()->removeProperty(prop);
+        delete prop;
+    }
+}
+
+void benchTransport()
+{
+    PluginHelper::loadTypekitAndTransports("rtt-types");
+
+    const size_t sampleSizes[] = {64, 4096, 1024 * 1024};
+    const int transports[] = {0, ORO_CORBA_PROTOCOL_ID, ORO_MQUEUE_PROTOCOL_ID};
+    const std::string transportNames[] = {"local", "corba", "mqueue"};
+    const size_t burst = 50;
+
+    for(size_t sampleSize: sampleSizes)
+    {
+        for(size_t t = 0; t < 3; t++)
+        {
+            std::string name = transportNames[t] + " " + boost::lexical_cast<std::string>(sampleSize) + "B";
+
+            RTT::TaskContext writerTask("orocos_cpp_bench_writer");
+            RTT::TaskContext readerTask("orocos_cpp_bench_reader");
+            RTT::OutputPort<std::vector<double> > out("out");
+            RTT::InputPort<std::vector<double> > in("in");
+            writerTask.ports()->addPort(out);
+            readerTask.ports()->addPort(in);
+
+            std::vector<double> sample(sampleSize / sizeof(double), 1.0);
+            std::vector<double> result(sample);
+            out.setDataSample(sample);
+
+            RTT::ConnPolicy policy = RTT::ConnPolicy::buffer(burst);
+            policy.transport = transports[t];
+            if(!out.connectTo(&in, policy))
+            {
+                //e.g. sample larger than /proc/sys/fs/mqueue/msgsize_max
+                std::cout << "transport " << name << ": connection failed" << std::endl;
+                continue;
+            }
+
+            report("transport " + name + " latency", measure(iterations * 10, [&out, &in, &sample, &result]() {
+                out.write(sample);
+                while(in.read(result, false) != RTT::NewData)
+                    ;
+            }), 1);
+
+            report("transport " + name + " burst", measure(iterations, [&out, &in, &sample, &result, burst]() {
+                for(size_t i = 0; i < burst; i++)
+                    out.write(sample);
+                for(size_t i = 0; i < burst; i++)
+                    while(in.read(result, false) != RTT::NewData)
+                        ;
+            }), burst);
+
+            out.disconnect();
+        }
+    }
+}
+
+double benchEcho(double value)
+{
+    return value;
+}
+
+void runOrbServer(const OrbProfile &profile, int iorFd)
+{
+    profile.initRTTOrb();
+    RTT::corba::TaskContextServer::ThreadOrb();
+    PluginHelper::loadTypekitAndTransports("rtt-types");
+
+    RTT::TaskContext task("orocos_cpp_bench_orb");
+    task.addOperation("echo", &benchEcho);
+    RTT::corba::TaskContextServer::Create(&task, false);
+
+    std::string ior = RTT::corba::TaskContextServer::getIOR(&task);
+    if(write(iorFd, ior.c_str(), ior.size()) != static_cast<ssize_t>(ior.size()))
+        _exit(EXIT_FAILURE);
+    close(iorFd);
+
+    //terminated by the benchmark process
+    while(true)
+        pause();
+}
+
+void runOrbClient(const OrbProfile &profile, const std::string &ior)
+{
+    profile.initRTTOrb();
+    PluginHelper::loadTypekitAndTransports("rtt-types");
+
+    RTT::TaskContext *proxy = RTT::corba::TaskContextProxy::Create(ior, true);
+    RTT::OperationCaller<double (double)> echo(proxy->getOperation("echo"));
+
+    report("operation round trip " + profile.name, measure(iterations * 10, [&echo]() {
+        echo(1.0);
+    }), 1);
+
+    delete proxy;
+    std::cout.flush();
+}
+
+/**
+ * The ORB can only be initialized once per process, therefore
+ * server and client of each profile run in their own processes.
+ * Must be called before the ORB of this process is initialized.
+ * */
+void benchOrbProfiles()
+{
+    const OrbProfile profiles[] = {OrbProfile(), OrbProfile::tcp(), OrbProfile::unixSocket()};
+
+    for(const OrbProfile &profile: profiles)
+    {
+        int iorPipe[2];
+        if(pipe(iorPipe))
+            throw std::runtime_error("Benchmark: pipe failed");
+
+        pid_t server = fork();
+        if(server < 0)
+            throw std::runtime_error("Benchmark: fork failed");
+        if(server == 0)
+        {
+            close(iorPipe[0]);
+            runOrbServer(profile, iorPipe[1]);
+        }
+
+        close(iorPipe[1]);
+        std::string ior;
+        char buffer[1024];
+        ssize_t len;
+        while((len = read(iorPipe[0], buffer, sizeof(buffer))) > 0)
+            ior.append(buffer, len);
+        close(iorPipe[0]);
+
+        if(!ior.empty())
+        {
+            pid_t client = fork();
+            if(client < 0)
+                throw std::runtime_error("Benchmark: fork failed");
+            if(client == 0)
+            {
+                runOrbClient(profile, ior);
+                _exit(EXIT_SUCCESS);
+            }
+            waitpid(client, nullptr, 0);
+        }
+        else
+            std::cout << "operation round trip " << profile.name << ": server failed to start" << std::endl;
+
+        kill(server, SIGTERM);
+        waitpid(server, nullptr, 0);
+    }
+}
+
+void benchSpawn(const std::string &model)
+{
+    Spawner &spawner(Spawner::getInstace());
+
+    report("spawn to ready " + model, measure(iterations / 10 + 1, [&spawner, &model]() {
+        spawner.spawnTask(model, "orocos_cpp_bench_spawn", false);
+        spawner.waitUntilAllReady(base::Time::fromSeconds(30));
+        spawner.killAll();
+    }), 1);
+
+    CorbaNameService *nameService = dynamic_cast<CorbaNameService *>(&spawner.getNameService());
+    if(nameService)
+    {
+        CorbaNameService::CacheStatistics stats(nameService->getCacheStatistics());
+        std::cout << "name service cache: " << stats.hits << " hits, " << stats.negativeHits << " negative hits, "
+                  << stats.misses << " misses, " << stats.invalidations << " invalidations" << std::endl;
+    }
+}
+
+void benchLogging(const std::string &model)
+{
+    Spawner &spawner(Spawner::getInstace());
+    spawner.spawnTask(model, "orocos_cpp_bench_log", false);
+    spawner.waitUntilAllReady(base::Time::fromSeconds(30));
+
+    LoggingHelper helper;
+    report("logger wiring " + model, measure(iterations / 10 + 1, [&helper]() {
+        helper.logTasks();
+    }), 1);
+
+    spawner.killAll();
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    //executed by the spawner through the script of the fixture
+    if(argc > 1 && std::string(argv[1]) == "--stub-deployment")
+        return runStubDeployment(argc, argv);
+
+    std::vector<std::string> cases;
+    std::vector<std::string> spawnModels;
+    std::vector<std::string> logModels;
+    bool useOmniNames = false;
+    bool proxy = false;
+    bool transport = false;
+    bool orb = false;
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg(argv[i]);
+        if(arg == "--iterations" && i + 1 < argc)
+            iterations = boost::lexical_cast<size_t>(argv[++i]);
+        else if(arg == "--omninames")
+            useOmniNames = true;
+        else if(arg == "--proxy")
+            proxy = true;
+        else if(arg == "--transport")
+            transport = true;
+        else if(arg == "--orb")
+            orb = true;
+        else if(arg == "--spawn" && i + 1 < argc)
+            spawnModels.push_back(argv[++i]);
+        else if(arg == "--log" && i + 1 < argc)
+            logModels.push_back(argv[++i]);
+        else if(arg == "spawn")
+        {
+            spawnModels.push_back(Fixture::stubModel());
+            useOmniNames = true;
+        }
+        else if(arg == "log")
+        {
+            logModels.push_back(Fixture::stubModel());
+            useOmniNames = true;
+        }
+        else if(arg == "--help" || arg == "-h")
+        {
+            std::cout << "usage: " << argv[0] << " [--iterations N] [--omninames] [--proxy] [--transport] [--orb] [--spawn model] [--log model] [pkgconfig|typelist|deployment|config|stress|spawn|log]..." << std::endl;
+            return 0;
+        }
+        else
+            cases.push_back(arg);
+    }
+
+    bool runOffline = cases.empty() && spawnModels.empty() && logModels.empty() && !proxy && !transport && !orb;
+    auto selected = [&cases, runOffline](const std::string &name) {
+        return runOffline || std::find(cases.begin(), cases.end(), name) != cases.end();
+    };
+
+    Fixture fixture;
+
+    if(selected("pkgconfig"))
+        benchPkgConfig(fixture);
+    if(selected("typelist"))
+        benchTypelist(fixture);
+    if(selected("deployment"))
+        benchDeployment(fixture);
+    if(selected("config"))
+        benchConfig(fixture);
+    if(selected("stress"))
+        benchStress(fixture);
+
+    if(orb)
+        benchOrbProfiles();
+
+    if(!proxy && !transport && spawnModels.empty() && logModels.empty())
+        return 0;
+
+    pid_t omniNames = 0;
+    if(useOmniNames)
+        omniNames = startOmniNames(fixture);
+
+    RTT::corba::TaskContextServer::InitOrb(argc, argv);
+    RTT::corba::TaskContextServer::ThreadOrb();
+
+    if(proxy)
+        benchProxy();
+    if(transport)
+        benchTransport();
+    for(const std::string &model: spawnModels)
+        benchSpawn(model);
+    for(const std::string &model: logModels)
+        benchLogging(model);
+
+    RTT::corba::TaskContextServer::ShutdownOrb();
+    RTT::corba::TaskContextServer::DestroyOrb();
+
+    if(omniNames)
+    {
+        kill(omniNames, SIGTERM);
+        waitpid(omniNames, nullptr, 0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,293 @@
+#include "CompactConfig.hpp"
+#include "Tracing.hpp"
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+
+using namespace orocos_cpp;
+using namespace libConfig;
+
+const uint32_t CompactConfig::NONE;
+const size_t CompactConfigValue::MAX_LAYERS;
+
+namespace
+{
+
+const std::string emptyString;
+
+}
+
+uint32_t CompactConfig::intern(const std::string& value)
+{
+    auto it = stringIds.find(value);
+    if(it != stringIds.end())
+        return it->second;
+
+    uint32_t id = strings.size();
+    strings.push_back(value);
+    stringIds.insert(std::make_pair(value, id));
+    return id;
+}
+
+void CompactConfig::addSection(const Configuration& config)
+{
+    OROCOS_CPP_TRACE_SCOPE("CompactConfig::addSection", config.getName());
+
+    uint32_t root = nodes.size();
+    Node node;
+    node.type = COMPLEX;
+    node.key = NONE;
+    node.value = NONE;
+    node.begin = 0;
+    node.count = 0;
+    nodes.push_back(node);
+
+    fillMap(root, config.getValues());
+
+    //a replaced section stays in the arena, but is not reachable any more
+    sections[config.getName()] = root;
+}
+
+void CompactConfig::fillMap(uint32_t index, const std::map< std::string, std::shared_ptr< ConfigValue > >& values)
+{
+    //sort the children by key id, for the binary search in findChild
+    std::vector<std::pair<uint32_t, const ConfigValue *> > children;
+    children.reserve(values.size());
+    for(const std::pair<const std::string, std::shared_ptr<ConfigValue> > &value: values)
+        children.push_back(std::make_pair(intern(value.first), value.second.get()));
+    std::sort(children.begin(), children.end(), [](const std::pair<uint32_t, const ConfigValue *> &a, const std::pair<uint32_t, const ConfigValue *> &b) {
+        return a.first < b.first;
+    });
+
+    //reserve the range first, the children of the children are appended behind
+    const uint32_t begin = nodes.size();
+    nodes[index].begin = begin;
+    nodes[index].count = children.size();
+    nodes.resize(begin + children.size());
+
+    for(size_t i = 0; i < children.size(); i++)
+    {
+        nodes[begin + i].key = children[i].first;
+        fill(begin + i, *children[i].second);
+    }
+}
+
+void CompactConfig::fill(uint32_t index, const ConfigValue& value)
+{
+    //nodes may be reallocated while filling, always access by index
+    nodes[index].value = NONE;
+    nodes[index].begin = 0;
+    nodes[index].count = 0;
+
+    switch(value.getType())
+    {
+        case ConfigValue::SIMPLE:
+            nodes[index].type = SIMPLE;
+            nodes[index].value = intern(static_cast<const SimpleConfigValue &>(value).getValue());
+            break;
+        case ConfigValue::COMPLEX:
+            nodes[index].type = COMPLEX;
+            fillMap(index, static_cast<const ComplexConfigValue &>(value).getValues());
+            break;
+        case ConfigValue::ARRAY:
+        {
+            nodes[index].type = ARRAY;
+            const std::vector<std::shared_ptr<ConfigValue> > &elements(static_cast<const ArrayConfigValue &>(value).getValues());
+            const uint32_t begin = nodes.size();
+            nodes[index].begin = begin;
+            nodes[index].count = elements.size();
+            nodes.resize(begin + elements.size());
+            for(size_t i = 0; i < elements.size(); i++)
+            {
+                nodes[begin + i].key = NONE;
+                fill(begin + i, *elements[i]);
+            }
+            break;
+        }
+    }
+}
+
+bool CompactConfig::hasSection(const std::string& name) const
+{
+    return sections.count(name);
+}
+
+uint32_t CompactConfig::getSection(const std::string& name) const
+{
+    auto it = sections.find(name);
+    if(it == sections.end())
+        return NONE;
+    return it->second;
+}
+
+std::vector< std::string > CompactConfig::getSectionNames() const
+{
+    std::vector<std::string> names;
+    for(const std::pair<const std::string, uint32_t> &section: sections)
+        names.push_back(section.first);
+    return names;
+}
+
+const std::string& CompactConfig::getString(uint32_t id) const
+{
+    if(id == NONE)
+        return emptyString;
+    return strings[id];
+}
+
+uint32_t CompactConfig::findString(const std::string& value) const
+{
+    auto it = stringIds.find(value);
+    if(it == stringIds.end())
+        return NONE;
+    return it->second;
+}
+
+uint32_t CompactConfig::findChild(uint32_t node, uint32_t key) const
+{
+    const Node &parent(nodes[node]);
+    if(parent.type != COMPLEX)
+        return NONE;
+
+    auto begin = nodes.begin() + parent.begin;
+    auto end = begin + parent.count;
+    auto it = std::lower_bound(begin, end, key, [](const Node &n, uint32_t k) {
+        return n.key < k;
+    });
+    if(it == end || it->key != key)
+        return NONE;
+    return it - nodes.begin();
+}
+
+size_t CompactConfig::getNodeCount() const
+{
+    return nodes.size();
+}
+
+CompactConfigValue::CompactConfigValue(const CompactConfig* config) : config(config), count(0), conflict(false)
+{
+}
+
+CompactConfigValue::CompactConfigValue(const CompactConfig& config, const std::vector< std::string >& sections) : config(&config), count(0), conflict(false)
+{
+    if(sections.empty())
+        throw std::runtime_error("CompactConfigValue: Error, no section given");
+
+    for(auto it = sections.rbegin(); it != sections.rend(); it++)
+    {
+        uint32_t root = config.getSection(*it);
+        if(root == CompactConfig::NONE)
+            throw std::runtime_error("CompactConfigValue: Error, there is no section named " + *it);
+        addLayer(root);
+    }
+}
+
+void CompactConfigValue::addLayer(uint32_t node)
+{
+    if(!count)
+    {
+        layers[count++] = node;
+        return;
+    }
+
+    const CompactConfig::Type top = getType();
+    const CompactConfig::Type type = static_cast<CompactConfig::Type>(config->getNode(node).type);
+    if(type != top)
+        conflict = true;
+
+    //only maps are merged, everything else is replaced by the overriding section
+    if(top != CompactConfig::COMPLEX || conflict)
+        return;
+
+    if(count == MAX_LAYERS)
+        throw std::runtime_error("CompactConfigValue: Error, more than 16 sections can not be merged");
+    layers[count++] = node;
+}
+
+CompactConfig::Type CompactConfigValue::getType() const
+{
+    return static_cast<CompactConfig::Type>(config->getNode(layers[0]).type);
+}
+
+bool CompactConfigValue::hasConflict() const
+{
+    return conflict;
+}
+
+const std::string& CompactConfigValue::getName() const
+{
+    return config->getString(config->getNode(layers[0]).key);
+}
+
+const std::string& CompactConfigValue::getValue() const
+{
+    return config->getString(config->getNode(layers[0]).value);
+}
+
+size_t CompactConfigValue::getSize() const
+{
+    const CompactConfig::Node &node(config->getNode(layers[0]));
+    if(node.type != CompactConfig::ARRAY)
+        return 0;
+    return node.count;
+}
+
+CompactConfigValue CompactConfigValue::getElement(size_t index) const
+{
+    const CompactConfig::Node &node(config->getNode(layers[0]));
+    if(node.type != CompactConfig::ARRAY || index >= node.count)
+        throw std::out_of_range("CompactConfigValue::getElement: index out of range");
+
+    CompactConfigValue element(config);
+    element.addLayer(node.begin + index);
+    return element;
+}
+
+bool CompactConfigValue::getField(const std::string& name, CompactConfigValue& field) const
+{
+    const uint32_t key = config->findString(name);
+    if(key == CompactConfig::NONE)
+        return false;
+
+    CompactConfigValue result(config);
+    for(uint32_t i = 0; i < count; i++)
+    {
+        uint32_t child = config->findChild(layers[i], key);
+        if(child != CompactConfig::NONE)
+            result.addLayer(child);
+    }
+
+    if(!result.count)
+        return false;
+
+    field = result;
+    return true;
+}
+
+size_t CompactConfigValue::getFieldCount() const
+{
+    if(count == 1)
+    {
+        const CompactConfig::Node &node(config->getNode(layers[0]));
+        return node.type == CompactConfig::COMPLEX ? node.count : 0;
+    }
+    return getFieldNames().size();
+}
+
+std::vector< std::string > CompactConfigValue::getFieldNames() const
+{
+    std::set<uint32_t> keys;
+    for(uint32_t i = 0; i < count; i++)
+    {
+        const CompactConfig::Node &node(config->getNode(layers[i]));
+        if(node.type != CompactConfig::COMPLEX)
+            continue;
+        for(uint32_t c = node.begin; c < node.begin + node.count; c++)
+            keys.insert(config->getNode(c).key);
+    }
+
+    std::vector<std::string> names;
+    for(uint32_t key: keys)
+        names.push_back(config->getString(key));
+    return names;
+}
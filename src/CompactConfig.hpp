@@ -0,0 +1,169 @@
+#ifndef COMPACTCONFIG_H
+#define COMPACTCONFIG_H
+
+#include <lib_config/Configuration.hpp>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+namespace orocos_cpp
+{
+
+/**
+ * Compact representation of configuration sections.
+ *
+ * All nodes of all sections are stored in one vector, the children
+ * of a node are stored next to each other. Keys and scalar values
+ * are interned, so every distinct string is stored once and keys
+ * are compared by id. The children of a map are sorted by key id.
+ *
+ * Use CompactConfigValue to access a merged view of several sections.
+ * */
+class CompactConfig
+{
+public:
+    enum Type
+    {
+        SIMPLE,
+        COMPLEX,
+        ARRAY,
+    };
+
+    struct Node
+    {
+        uint8_t type;
+        ///interned key within the parent map, NONE for array elements and sections
+        uint32_t key;
+        ///interned scalar, for SIMPLE nodes
+        uint32_t value;
+        ///range of the children, for COMPLEX and ARRAY nodes
+        uint32_t begin;
+        uint32_t count;
+    };
+
+    static const uint32_t NONE = 0xffffffff;
+
+    /**
+     * Adds the given section, replacing a section of the same name.
+     * */
+    void addSection(const libConfig::Configuration &config);
+
+    bool hasSection(const std::string &name) const;
+
+    /**
+     * Returns the index of the root node of the given section, or NONE
+     * */
+    uint32_t getSection(const std::string &name) const;
+    std::vector<std::string> getSectionNames() const;
+
+    const Node &getNode(uint32_t index) const
+    {
+        return nodes[index];
+    }
+
+    const std::string &getString(uint32_t id) const;
+
+    /**
+     * Returns the id of the given string, or NONE if no key
+     * or value equals the string
+     * */
+    uint32_t findString(const std::string &value) const;
+
+    /**
+     * Returns the index of the child of the given map node
+     * with the given key, or NONE
+     * */
+    uint32_t findChild(uint32_t node, uint32_t key) const;
+
+    size_t getNodeCount() const;
+
+private:
+    std::vector<Node> nodes;
+    std::vector<std::string> strings;
+    std::unordered_map<std::string, uint32_t> stringIds;
+    std::map<std::string, uint32_t> sections;
+
+    uint32_t intern(const std::string &value);
+    void fill(uint32_t index, const libConfig::ConfigValue &value);
+    void fillMap(uint32_t index, const std::map<std::string, std::shared_ptr<libConfig::ConfigValue> > &values);
+};
+
+/**
+ * Merged view on one or more sections of a CompactConfig.
+ *
+ * Nothing is copied on merging. A value holds the nodes of all
+ * sections at the same path, the last section first. Maps are merged
+ * key by key, scalars and arrays of a later section replace the ones
+ * of the earlier sections, like libConfig::Configuration::merge does.
+ *
+ * A value is a small object that is passed by value. It refers to the
+ * CompactConfig, which must outlive it.
+ * */
+class CompactConfigValue
+{
+public:
+    static const size_t MAX_LAYERS = 16;
+
+    /**
+     * Creates the merged view of the given sections, the later sections
+     * override the earlier ones. Throws if a section is unknown.
+     * */
+    CompactConfigValue(const CompactConfig &config, const std::vector<std::string> &sections);
+
+    CompactConfig::Type getType() const;
+
+    /**
+     * True if the sections disagree on the type of this value,
+     * e.g. a map in one section and a scalar in another one
+     * */
+    bool hasConflict() const;
+
+    /**
+     * Key of the value within its parent, empty for array elements
+     * */
+    const std::string &getName() const;
+
+    /**
+     * The scalar, for SIMPLE values
+     * */
+    const std::string &getValue() const;
+
+    /**
+     * Number of elements, for ARRAY values
+     * */
+    size_t getSize() const;
+    CompactConfigValue getElement(size_t index) const;
+
+    /**
+     * Looks up a field of a COMPLEX value.
+     * @return false if no section defines the field
+     * */
+    bool getField(const std::string &name, CompactConfigValue &field) const;
+
+    /**
+     * Number of distinct fields of a COMPLEX value, over all sections
+     * */
+    size_t getFieldCount() const;
+
+    /**
+     * Returns the names of all fields of a COMPLEX value, over all sections
+     * */
+    std::vector<std::string> getFieldNames() const;
+
+private:
+    explicit CompactConfigValue(const CompactConfig *config);
+
+    void addLayer(uint32_t node);
+
+    const CompactConfig *config;
+    ///nodes at this path, the overriding section first
+    uint32_t layers[MAX_LAYERS];
+    uint32_t count;
+    bool conflict;
+};
+
+}//end of namespace
+#endif // COMPACTCONFIG_H
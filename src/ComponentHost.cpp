@@ -0,0 +1,239 @@
+#include "ComponentHost.hpp"
+#include "FileNameService.hpp"
+#include "OrbProfile.hpp"
+#include "PkgConfigHelper.hpp"
+#include "PluginHelper.hpp"
+#include "Tracing.hpp"
+#include <rtt/Activity.hpp>
+#include <rtt/deployment/ComponentLoader.hpp>
+#include <rtt/transports/corba/TaskContextServer.hpp>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
+#define xstr(s) str(s)
+#define str(s) #s
+
+using namespace orocos_cpp;
+
+namespace
+{
+
+//written by the signal handler, read by the thread shutting down the ORB
+int signalPipe[2] = {-1, -1};
+
+void wakeup(int)
+{
+    const int savedErrno = errno;
+    char c = 0;
+    if(write(signalPipe[1], &c, 1) < 0)
+    {
+        //the pipe is full, the thread was woken up already
+    }
+    errno = savedErrno;
+}
+
+}
+
+ComponentHost::ComponentHost(bool registerAtNameService) : registerAtNameService(registerAtNameService), fileNameService(nullptr)
+{
+    OrbProfile::getDefault().initRTTOrb();
+}
+
+ComponentHost::~ComponentHost()
+{
+    //destroy in reverse order of creation, consumers first
+    std::vector<std::string> names(taskOrder.rbegin(), taskOrder.rend());
+    for(const std::string &name: names)
+        destroyTask(name);
+}
+
+void ComponentHost::setFileNameService(FileNameService* nameService)
+{
+    fileNameService = nameService;
+}
+
+void ComponentHost::loadComponent(const std::string& componentName)
+{
+    if(loadedComponents.count(componentName))
+        return;
+
+    OROCOS_CPP_TRACE_SCOPE("ComponentHost::loadComponent", componentName);
+
+    //the typekits need to be present before the task library is loaded
+    for(const std::string &tk: PluginHelper::getNeededTypekits(componentName))
+        PluginHelper::loadTypekitAndTransports(tk);
+
+    std::vector<std::string> pkgConfigFields;
+    pkgConfigFields.push_back("prefix");
+    pkgConfigFields.push_back("libdir");
+    std::vector<std::string> pkgConfigValues;
+
+    if(!PkgConfigHelper::parsePkgConfig(componentName + std::string("-tasks-") + xstr(OROCOS_TARGET) + std::string(".pc"), pkgConfigFields, pkgConfigValues))
+        throw std::runtime_error("ComponentHost::Error, could not load pkgConfig file for tasks of component " + componentName);
+
+    std::string libDir = pkgConfigValues[1];
+    if(!PkgConfigHelper::solveString(libDir, "${prefix}", pkgConfigValues[0]))
+        throw std::runtime_error("Internal Error while parsing pkgConfig file");
+
+    std::string library = libDir + "/lib" + componentName + "-tasks-" xstr(OROCOS_TARGET) ".so";
+    if(!RTT::ComponentLoader::Instance()->loadLibrary(library))
+        throw std::runtime_error("ComponentHost::Error, could not load task library " + library);
+
+    loadedComponents.insert(componentName);
+}
+
+RTT::TaskContext* ComponentHost::createTask(const std::string& modelName, const std::string& taskName)
+{
+    OROCOS_CPP_TRACE_SCOPE("ComponentHost::createTask", modelName);
+
+    std::string::size_type pos = modelName.find("::");
+    if(pos == std::string::npos)
+        throw std::runtime_error("ComponentHost::Error, given model name " + modelName + " is not in the format 'module::TaskSpec'");
+
+    if(tasks.count(taskName))
+        throw std::runtime_error("ComponentHost::Error, a task named " + taskName + " is already hosted");
+
+    loadComponent(modelName.substr(0, pos));
+
+    RTT::TaskContext *task = RTT::ComponentLoader::Instance()->loadComponent(taskName, modelName);
+    if(!task)
+        throw std::runtime_error("ComponentHost::Error, could not create task " + taskName + " of model " + modelName);
+
+    if(!RTT::corba::TaskContextServer::Create(task, registerAtNameService))
+    {
+        RTT::ComponentLoader::Instance()->unloadComponent(taskName);
+        throw std::runtime_error("ComponentHost::Error, could not create CORBA server for " + taskName);
+    }
+
+    if(fileNameService)
+        fileNameService->publish(taskName, RTT::corba::TaskContextServer::getIOR(task), getpid());
+
+    tasks[taskName] = task;
+    taskOrder.push_back(taskName);
+    return task;
+}
+
+void ComponentHost::setActivity(const std::string& taskName, const base::Time& period, int scheduler, int priority)
+{
+    RTT::TaskContext *task = getTask(taskName);
+    if(!task)
+        throw std::runtime_error("ComponentHost::Error, no task named " + taskName);
+
+    if(!task->setActivity(new RTT::Activity(scheduler, priority, period.toSeconds(), 0, taskName)))
+        throw std::runtime_error("ComponentHost::Error, could not set activity of " + taskName + ", it needs to be stopped");
+}
+
+bool ComponentHost::connect(const std::string& outTask, const std::string& outPort, const std::string& inTask, const std::string& inPort, RTT::ConnPolicy policy)
+{
+    OROCOS_CPP_TRACE_SCOPE("ComponentHost::connect", outTask + "." + outPort);
+
+    RTT::TaskContext *out = getTask(outTask);
+    RTT::TaskContext *in = getTask(inTask);
+    if(!out || !in)
+    {
+        std::cout << "ComponentHost::Error, " << (out ? inTask : outTask) << " is not hosted" << std::endl;
+        return false;
+    }
+
+    RTT::base::PortInterface *outP = out->ports()->getPort(outPort);
+    RTT::base::PortInterface *inP = in->ports()->getPort(inPort);
+    if(!outP || !inP)
+    {
+        std::cout << "ComponentHost::Error, port " << (outP ? inTask + "." + inPort : outTask + "." + outPort) << " does not exist" << std::endl;
+        return false;
+    }
+
+    //both ports live in this process, no transport needed
+    policy.transport = 0;
+    policy.lock_policy = RTT::ConnPolicy::LOCK_FREE;
+
+    return outP->connectTo(inP, policy);
+}
+
+RTT::TaskContext* ComponentHost::getTask(const std::string& taskName) const
+{
+    auto it = tasks.find(taskName);
+    if(it == tasks.end())
+        return nullptr;
+    return it->second;
+}
+
+std::vector< std::string > ComponentHost::getTaskNames() const
+{
+    return taskOrder;
+}
+
+bool ComponentHost::destroyTask(const std::string& taskName)
+{
+    auto it = tasks.find(taskName);
+    if(it == tasks.end())
+        return false;
+
+    RTT::TaskContext *task = it->second;
+    if(task->isRunning())
+        task->stop();
+    if(task->isConfigured())
+        task->cleanup();
+
+    if(fileNameService)
+        fileNameService->unpublish(taskName);
+
+    RTT::corba::TaskContextServer::CleanupServer(task);
+    RTT::ComponentLoader::Instance()->unloadComponent(taskName);
+
+    tasks.erase(it);
+    taskOrder.erase(std::find(taskOrder.begin(), taskOrder.end(), taskName));
+    return true;
+}
+
+void ComponentHost::run()
+{
+    RTT::corba::TaskContextServer::RunOrb();
+}
+
+void ComponentHost::shutdown()
+{
+    RTT::corba::TaskContextServer::ShutdownOrb(false);
+}
+
+void ComponentHost::runUntilSignal()
+{
+    if(pipe2(signalPipe, O_CLOEXEC))
+        throw std::runtime_error(std::string("ComponentHost::Error, could not create signal pipe : ") + strerror(errno));
+
+    //shutting the ORB down is not async signal safe, it is done by a thread
+    std::thread waiter([]() {
+        char c;
+        while(read(signalPipe[0], &c, 1) < 0 && errno == EINTR)
+            ;
+        shutdown();
+    });
+
+    struct sigaction action, oldInt, oldTerm;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = wakeup;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, &oldInt);
+    sigaction(SIGTERM, &action, &oldTerm);
+
+    //returns after the ORB completed the shutdown, including running calls
+    run();
+
+    sigaction(SIGINT, &oldInt, nullptr);
+    sigaction(SIGTERM, &oldTerm, nullptr);
+
+    //run() may also have returned because of shutdown()
+    wakeup(0);
+    waiter.join();
+
+    close(signalPipe[0]);
+    close(signalPipe[1]);
+    signalPipe[0] = signalPipe[1] = -1;
+}
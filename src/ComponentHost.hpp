@@ -0,0 +1,122 @@
+#ifndef COMPONENTHOST_H
+#define COMPONENTHOST_H
+
+#include <rtt/ConnPolicy.hpp>
+#include <rtt/TaskContext.hpp>
+#include <rtt/os/threads.hpp>
+#include <base/Time.hpp>
+#include <boost/noncopyable.hpp>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace orocos_cpp
+{
+
+class FileNameService;
+
+/**
+ * Hosts tasks of several components in the current process.
+ *
+ * The task libraries are located using the <component>-tasks-<target>.pc
+ * files and loaded through the RTT ComponentLoader, together with all
+ * needed typekits. Tasks are instantiated by model name and made
+ * available via CORBA, so that they are visible to other processes
+ * like the tasks of a spawned deployment.
+ *
+ * Connections between tasks of the same host are in-process
+ * connections using lock free buffers, the samples are neither
+ * marshalled nor passed through the kernel.
+ * */
+class ComponentHost : public boost::noncopyable
+{
+public:
+    /**
+     * @param registerAtNameService If true, the tasks are registered at
+     *        the CORBA naming service
+     * */
+    ComponentHost(bool registerAtNameService = true);
+
+    /**
+     * Stops, cleans up and unloads all hosted tasks.
+     * */
+    ~ComponentHost();
+
+    /**
+     * Additionally publishes all tasks created afterwards in the given
+     * file name service. Ownership is not taken.
+     * */
+    void setFileNameService(FileNameService *nameService);
+
+    /**
+     * Loads the task library of the given component, e.g. "camera_usb",
+     * and the typekits it needs. Does nothing if already loaded.
+     * Throws on error.
+     * */
+    void loadComponent(const std::string &componentName);
+
+    /**
+     * Creates a task of the given model, e.g. "camera_usb::Task",
+     * loading its component if needed. Throws on error.
+     *
+     * @param taskName The name of the task, also used at the name service
+     * @return The task, owned by the host
+     * */
+    RTT::TaskContext *createTask(const std::string &modelName, const std::string &taskName);
+
+    /**
+     * Replaces the activity of the given task by a thread with the given
+     * period (zero for a non periodic task), scheduler and priority.
+     * */
+    void setActivity(const std::string &taskName, const base::Time &period, int scheduler = ORO_SCHED_OTHER, int priority = RTT::os::LowestPriority);
+
+    /**
+     * Connects two ports of hosted tasks in process. The policy
+     * is forced to the local, lock free transport.
+     * @return true on success
+     * */
+    bool connect(const std::string &outTask, const std::string &outPort,
+                 const std::string &inTask, const std::string &inPort,
+                 RTT::ConnPolicy policy = RTT::ConnPolicy());
+
+    /**
+     * Returns the hosted task with the given name, or nullptr.
+     * */
+    RTT::TaskContext *getTask(const std::string &taskName) const;
+
+    std::vector<std::string> getTaskNames() const;
+
+    /**
+     * Stops, cleans up and removes the given task.
+     * */
+    bool destroyTask(const std::string &taskName);
+
+    /**
+     * Blocks and serves CORBA requests until shutdown() is called.
+     * */
+    void run();
+
+    /**
+     * Makes run() return.
+     * */
+    static void shutdown();
+
+    /**
+     * Same as run(), but also returns on SIGINT or SIGTERM. The signal
+     * handler only wakes up a thread, which shuts the ORB down. When this
+     * returns, no CORBA call is dispatched into the tasks any more, and
+     * the host may be destroyed.
+     * */
+    void runUntilSignal();
+
+private:
+    bool registerAtNameService;
+    FileNameService *fileNameService;
+    std::set<std::string> loadedComponents;
+    std::map<std::string, RTT::TaskContext *> tasks;
+    std::vector<std::string> taskOrder;
+};
+
+}//end of namespace
+#endif // COMPONENTHOST_H
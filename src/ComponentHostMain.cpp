@@ -0,0 +1,100 @@
+#include "ComponentHost.hpp"
+#include <boost/lexical_cast.hpp>
+#include <iostream>
+#include <stdexcept>
+
+/**
+ * Hosts tasks of several components in one process.
+ *
+ * usage: componentHost [--no-naming] [--period task:seconds]
+ *                      [--connect outTask.outPort:inTask.inPort] model:taskName...
+ *
+ * e.g. componentHost camera_usb::Task:camera image_preprocessing::MonoTask:preprocessing
+ *                    --connect camera.frame:preprocessing.frame_in
+ * */
+
+using namespace orocos_cpp;
+
+namespace
+{
+
+void usage(const char *name)
+{
+    std::cout << "usage: " << name << " [--no-naming] [--period task:seconds] [--connect outTask.outPort:inTask.inPort] model:taskName..." << std::endl;
+}
+
+bool splitAt(const std::string &arg, char separator, bool last, std::string &first, std::string &second)
+{
+    std::string::size_type pos = last ? arg.rfind(separator) : arg.find(separator);
+    if(pos == std::string::npos)
+        return false;
+    first = arg.substr(0, pos);
+    second = arg.substr(pos + 1);
+    return true;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    bool naming = true;
+    std::vector<std::pair<std::string, std::string> > tasks;
+    std::vector<std::string> connections;
+    std::vector<std::string> periods;
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg(argv[i]);
+        std::string model, name;
+        if(arg == "--no-naming")
+            naming = false;
+        else if(arg == "--connect" && i + 1 < argc)
+            connections.push_back(argv[++i]);
+        else if(arg == "--period" && i + 1 < argc)
+            periods.push_back(argv[++i]);
+        else if(arg != "--help" && arg != "-h" && splitAt(arg, ':', true, model, name) && !model.empty() && model.back() != ':')
+            tasks.push_back(std::make_pair(model, name));
+        else
+        {
+            usage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    ComponentHost host(naming);
+    try {
+        for(const std::pair<std::string, std::string> &task: tasks)
+        {
+            host.createTask(task.first, task.second);
+            std::cout << "Hosting " << task.second << " of model " << task.first << std::endl;
+        }
+
+        for(const std::string &period: periods)
+        {
+            std::string task, seconds;
+            if(!splitAt(period, ':', true, task, seconds))
+                throw std::runtime_error("Error, period " + period + " is not in the format task:seconds");
+            host.setActivity(task, base::Time::fromSeconds(boost::lexical_cast<double>(seconds)));
+        }
+
+        for(const std::string &connection: connections)
+        {
+            std::string out, in, outTask, outPort, inTask, inPort;
+            if(!splitAt(connection, ':', false, out, in) || !splitAt(out, '.', false, outTask, outPort) || !splitAt(in, '.', false, inTask, inPort))
+                throw std::runtime_error("Error, connection " + connection + " is not in the format outTask.outPort:inTask.inPort");
+
+            if(!host.connect(outTask, outPort, inTask, inPort))
+                throw std::runtime_error("Error, could not connect " + connection);
+        }
+    } catch (const std::exception &e)
+    {
+        std::cout << e.what() << std::endl;
+        usage(argv[0]);
+        return 1;
+    }
+
+    //the ORB is down when this returns, the host may stop and unload the tasks
+    host.runUntilSignal();
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+#ifndef CONCURRENTMAP_H
+#define CONCURRENTMAP_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace orocos_cpp
+{
+
+/**
+ * Read mostly map, that may be used from several threads.
+ *
+ * The map is published as an immutable snapshot (read-copy-update).
+ * Readers atomically fetch the current snapshot and work on it without
+ * holding any lock, so lookups never wait for each other or for a
+ * writer. Writers copy the current snapshot, modify the copy and publish
+ * it, writers are serialized by a mutex.
+ *
+ * This is meant for caches, that are filled once and read often.
+ * A snapshot stays valid as long as it is referenced, even if the map
+ * is changed meanwhile.
+ * */
+template <typename Key, typename Value>
+class ConcurrentMap
+{
+public:
+    typedef std::map<Key, Value> Map;
+    typedef std::shared_ptr<const Map> Snapshot;
+
+    ConcurrentMap() : map(std::make_shared<const Map>())
+    {
+    }
+
+    ConcurrentMap(const Map &values) : map(std::make_shared<const Map>(values))
+    {
+    }
+
+    ///copies share the current snapshot
+    ConcurrentMap(const ConcurrentMap &other) : map(other.getSnapshot())
+    {
+    }
+
+    ConcurrentMap &operator=(const ConcurrentMap &other)
+    {
+        if(this == &other)
+            return *this;
+        Snapshot snapshot(other.getSnapshot());
+        std::lock_guard<std::mutex> lock(writeMutex);
+        std::atomic_store(&map, snapshot);
+        return *this;
+    }
+
+    Snapshot getSnapshot() const
+    {
+        return std::atomic_load(&map);
+    }
+
+    bool find(const Key &key, Value &value) const
+    {
+        Snapshot snapshot(getSnapshot());
+        auto it = snapshot->find(key);
+        if(it == snapshot->end())
+            return false;
+        value = it->second;
+        return true;
+    }
+
+    bool contains(const Key &key) const
+    {
+        Snapshot snapshot(getSnapshot());
+        return snapshot->find(key) != snapshot->end();
+    }
+
+    size_t size() const
+    {
+        return getSnapshot()->size();
+    }
+
+    /**
+     * Adds the value if the key is not present yet
+     * @return false if the key was present, value is set to the present value
+     * */
+    bool insert(const Key &key, Value &value)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        auto it = map->find(key);
+        if(it != map->end())
+        {
+            value = it->second;
+            return false;
+        }
+
+        std::shared_ptr<Map> copy(std::make_shared<Map>(*map));
+        copy->insert(std::make_pair(key, value));
+        std::atomic_store(&map, Snapshot(copy));
+        return true;
+    }
+
+    /**
+     * Adds or replaces the value of the given key
+     * */
+    void set(const Key &key, const Value &value)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        std::shared_ptr<Map> copy(std::make_shared<Map>(*map));
+        (*copy)[key] = value;
+        std::atomic_store(&map, Snapshot(copy));
+    }
+
+    /**
+     * Adds all entries of values, whose keys are not present yet.
+     * Publishes one snapshot, use this for bulk loads.
+     * */
+    void insertAll(const Map &values)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        std::shared_ptr<Map> copy(std::make_shared<Map>(*map));
+        copy->insert(values.begin(), values.end());
+        std::atomic_store(&map, Snapshot(copy));
+    }
+
+    /**
+     * Adds or replaces all entries of values
+     * */
+    void setAll(const Map &values)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        std::shared_ptr<Map> copy(std::make_shared<Map>(*map));
+        for(const std::pair<const Key, Value> &entry: values)
+            (*copy)[entry.first] = entry.second;
+        std::atomic_store(&map, Snapshot(copy));
+    }
+
+    /**
+     * Calls func with a copy of the current map, and publishes the copy
+     * afterwards. Other writers wait meanwhile, readers do not.
+     * */
+    template <typename Func>
+    void update(Func func)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        std::shared_ptr<Map> copy(std::make_shared<Map>(*map));
+        func(*copy);
+        std::atomic_store(&map, Snapshot(copy));
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        std::atomic_store(&map, std::make_shared<const Map>());
+    }
+
+private:
+    std::mutex writeMutex;
+    ///only replaced through atomic_store
+    Snapshot map;
+};
+
+}//end of namespace
+#endif // CONCURRENTMAP_H
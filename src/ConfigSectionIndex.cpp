@@ -0,0 +1,296 @@
+#include "ConfigSectionIndex.hpp"
+#include "Tracing.hpp"
+#include <lib_config/YAMLConfiguration.hpp>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <stdio.h>
+#include <sys/stat.h>
+
+using namespace orocos_cpp;
+using namespace libConfig;
+
+namespace
+{
+
+const char INDEX_HEADER[] = "orocos_cpp config section index 1";
+
+/**
+ * Returns the name of the section started by the given line, or an
+ * empty string if the line does not start a named section
+ * */
+std::string getSectionName(const std::string &line)
+{
+    std::string::size_type pos = line.find_first_not_of(" \t", 3);
+    if(pos == std::string::npos || line.compare(pos, 5, "name:") != 0)
+        return std::string();
+
+    pos = line.find_first_not_of(" \t", pos + 5);
+    if(pos == std::string::npos)
+        return std::string();
+
+    std::string::size_type end = line.find_first_of(" \t\r#", pos);
+    return line.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+}
+
+}
+
+ConfigSectionIndex::ConfigSectionIndex() : fileSize(0), modificationTime(0), fullParse(true)
+{
+}
+
+bool ConfigSectionIndex::getFileStamp(const std::string& fileName, uint64_t& size, int64_t& mtime)
+{
+    struct stat st;
+    if(::stat(fileName.c_str(), &st) != 0)
+        return false;
+    size = st.st_size;
+    mtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    return true;
+}
+
+bool ConfigSectionIndex::isCurrent() const
+{
+    uint64_t size;
+    int64_t mtime;
+    return getFileStamp(fileName, size, mtime) && size == fileSize && mtime == modificationTime;
+}
+
+bool ConfigSectionIndex::open(const std::string& fileName)
+{
+    OROCOS_CPP_TRACE_SCOPE("ConfigSectionIndex::open", fileName);
+
+    this->fileName = fileName;
+    sections.clear();
+    fullParse = true;
+    if(!getFileStamp(fileName, fileSize, modificationTime))
+    {
+        std::cout << "ConfigSectionIndex::open : Error, could not stat " << fileName << std::endl;
+        return false;
+    }
+
+    if(readIndexFile())
+        return true;
+
+    if(!build())
+        return false;
+
+    writeIndexFile();
+    return true;
+}
+
+bool ConfigSectionIndex::build()
+{
+    OROCOS_CPP_TRACE_SCOPE("ConfigSectionIndex::build", fileName);
+
+    std::ifstream in(fileName.c_str(), std::ios::binary);
+    if(!in.good())
+    {
+        std::cout << "ConfigSectionIndex::build : Error, could not open " << fileName << std::endl;
+        return false;
+    }
+
+    sections.clear();
+    fullParse = false;
+
+    std::set<std::string> names;
+    std::string line;
+    uint64_t offset = 0;
+    while(std::getline(in, line))
+    {
+        const uint64_t lineOffset = offset;
+        offset += line.size() + 1;
+
+        if(line.find("<%") != std::string::npos)
+        {
+            //ERB tags are expanded on the whole file
+            fullParse = true;
+            break;
+        }
+
+        if(line.compare(0, 3, "---") == 0)
+        {
+            std::string name = getSectionName(line);
+            if(name.empty() || !names.insert(name).second)
+            {
+                fullParse = true;
+                break;
+            }
+
+            if(!sections.empty())
+                sections.back().length = lineOffset - sections.back().offset;
+
+            Section section;
+            section.name = name;
+            section.offset = lineOffset;
+            section.length = 0;
+            sections.push_back(section);
+            continue;
+        }
+
+        //only comments may precede the first section
+        if(sections.empty() && line.find_first_not_of(" \t\r") != std::string::npos && line[line.find_first_not_of(" \t\r")] != '#')
+        {
+            fullParse = true;
+            break;
+        }
+    }
+
+    if(fullParse)
+        sections.clear();
+    else if(!sections.empty())
+        sections.back().length = fileSize - sections.back().offset;
+
+    return true;
+}
+
+std::string ConfigSectionIndex::getIndexFileName(const std::string& fileName)
+{
+    boost::filesystem::path path(fileName);
+    return (path.parent_path() / ("." + path.filename().string() + ".index")).string();
+}
+
+bool ConfigSectionIndex::readIndexFile()
+{
+    std::ifstream in(getIndexFileName(fileName).c_str());
+    if(!in.good())
+        return false;
+
+    std::string header;
+    uint64_t size;
+    int64_t mtime;
+    if(!std::getline(in, header) || header != INDEX_HEADER || !(in >> size >> mtime >> fullParse))
+        return false;
+
+    if(size != fileSize || mtime != modificationTime)
+        return false;
+
+    sections.clear();
+    Section section;
+    while(in >> section.offset >> section.length >> section.name)
+    {
+        if(section.offset + section.length > fileSize)
+        {
+            sections.clear();
+            fullParse = true;
+            return false;
+        }
+        sections.push_back(section);
+    }
+
+    return in.eof();
+}
+
+void ConfigSectionIndex::writeIndexFile() const
+{
+    //the index is only a cache, the configuration directory may be read only
+    const std::string indexFileName = getIndexFileName(fileName);
+    const std::string tmpName = indexFileName + ".tmp";
+    {
+        std::ofstream out(tmpName.c_str(), std::ios::trunc);
+        if(!out.good())
+            return;
+
+        out << INDEX_HEADER << std::endl;
+        out << fileSize << " " << modificationTime << " " << fullParse << std::endl;
+        for(const Section &section: sections)
+            out << section.offset << " " << section.length << " " << section.name << std::endl;
+
+        if(!out.good())
+        {
+            remove(tmpName.c_str());
+            return;
+        }
+    }
+    if(rename(tmpName.c_str(), indexFileName.c_str()) != 0)
+        remove(tmpName.c_str());
+}
+
+bool ConfigSectionIndex::hasSection(const std::string& name) const
+{
+    for(const Section &section: sections)
+    {
+        if(section.name == name)
+            return true;
+    }
+    return false;
+}
+
+std::vector< std::string > ConfigSectionIndex::getSectionNames() const
+{
+    std::vector<std::string> names;
+    for(const Section &section: sections)
+        names.push_back(section.name);
+    return names;
+}
+
+bool ConfigSectionIndex::needsFullParse() const
+{
+    return fullParse;
+}
+
+bool ConfigSectionIndex::loadSections(const std::vector< std::string >& names, std::map< std::string, Configuration >& subConfigs) const
+{
+    OROCOS_CPP_TRACE_SCOPE("ConfigSectionIndex::loadSections", fileName);
+
+    YAMLConfigParser parser;
+    if(fullParse)
+        return parser.loadConfigFile(fileName, subConfigs);
+
+    std::ifstream in(fileName.c_str(), std::ios::binary);
+    if(!in.good())
+    {
+        std::cout << "ConfigSectionIndex::loadSections : Error, could not open " << fileName << std::endl;
+        return false;
+    }
+
+    //parse all requested sections in one go
+    std::string yaml;
+    for(const Section &section: sections)
+    {
+        if(std::find(names.begin(), names.end(), section.name) == names.end())
+            continue;
+
+        const size_t start = yaml.size();
+        yaml.resize(start + section.length);
+        in.seekg(section.offset);
+        in.read(&yaml[start], section.length);
+        if(!in.good())
+        {
+            std::cout << "ConfigSectionIndex::loadSections : Error, could not read section " << section.name << " of " << fileName << std::endl;
+            return false;
+        }
+        if(yaml.back() != '\n')
+            yaml += '\n';
+    }
+
+    if(yaml.empty())
+        return true;
+
+    return parser.loadConfigString(yaml, subConfigs);
+}
+
+bool ConfigSectionIndex::loadSections(const std::string& fileName, const std::vector< std::string >& names, std::map< std::string, Configuration >& subConfigs)
+{
+    static std::mutex cacheMutex;
+    static std::map<std::string, ConfigSectionIndex> cache;
+
+    ConfigSectionIndex index;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = cache.find(fileName);
+        if(it == cache.end() || !it->second.isCurrent())
+        {
+            if(!index.open(fileName))
+                return false;
+            cache[fileName] = index;
+        }
+        else
+            index = it->second;
+    }
+
+    return index.loadSections(names, subConfigs);
+}
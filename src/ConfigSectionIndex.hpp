@@ -0,0 +1,90 @@
+#ifndef CONFIGSECTIONINDEX_H
+#define CONFIGSECTIONINDEX_H
+
+#include <lib_config/Configuration.hpp>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace orocos_cpp
+{
+
+/**
+ * Index of the sections of a YAML configuration file.
+ *
+ * The file is scanned once for the '--- name:' lines that start a
+ * section, only the sections that are actually used are parsed
+ * afterwards. The index is cached in memory and in a file next to the
+ * configuration file (.<file name>.index), and rebuilt whenever the
+ * size or modification time of the configuration file changes.
+ *
+ * Files containing ERB tags ('<%') or sections without name are
+ * always parsed completely by YAMLConfigParser::loadConfigFile,
+ * as the tags may span several sections.
+ * */
+class ConfigSectionIndex
+{
+public:
+    struct Section
+    {
+        std::string name;
+        uint64_t offset;
+        uint64_t length;
+    };
+
+    ConfigSectionIndex();
+
+    /**
+     * Loads the cached index of the given file, or builds and caches it.
+     * @return false if the file could not be read
+     * */
+    bool open(const std::string &fileName);
+
+    bool hasSection(const std::string &name) const;
+    std::vector<std::string> getSectionNames() const;
+
+    /**
+     * True if the file can not be split into sections
+     * and needs to be parsed completely
+     * */
+    bool needsFullParse() const;
+
+    /**
+     * Parses the given sections and adds them to subConfigs. Unknown
+     * names are ignored, the caller notices them missing in subConfigs.
+     * Parses the whole file if needsFullParse() is true.
+     * @return false on parse errors
+     * */
+    bool loadSections(const std::vector<std::string> &names, std::map<std::string, libConfig::Configuration> &subConfigs) const;
+
+    /**
+     * Convenience function, opens the index of the given file using
+     * the process wide in memory cache and loads the given sections.
+     * */
+    static bool loadSections(const std::string &fileName, const std::vector<std::string> &names, std::map<std::string, libConfig::Configuration> &subConfigs);
+
+    static std::string getIndexFileName(const std::string &fileName);
+
+    /**
+     * Size and modification time (ns) of the given file, the index is
+     * rebuilt if they change
+     * @return false if the file could not be stat'ed
+     * */
+    static bool getFileStamp(const std::string &fileName, uint64_t &size, int64_t &mtime);
+
+private:
+    std::string fileName;
+    uint64_t fileSize;
+    int64_t modificationTime;
+    bool fullParse;
+    std::vector<Section> sections;
+
+    bool isCurrent() const;
+    bool build();
+    bool readIndexFile();
+    void writeIndexFile() const;
+};
+
+}//end of namespace
+#endif // CONFIGSECTIONINDEX_H
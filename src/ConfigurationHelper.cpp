@@ -1,17 +1,29 @@
 #include "ConfigurationHelper.hpp"
 #include <rtt/types/TypeInfo.hpp>
 #include <rtt/typelib/TypelibMarshaller.hpp>
+#include <typelib/value_ops.hh>
 #include <rtt/base/DataSourceBase.hpp>
 #include <rtt/transports/corba/TaskContextProxy.hpp>
 #include <rtt/types/TypekitRepository.hpp>
+#include <rtt/types/TypeInfoRepository.hpp>
 
 #include <boost/lexical_cast.hpp>
 #include <rtt/OperationCaller.hpp>
 #include <lib_config/Bundle.hpp>
 #include <string>  
 #include <limits>
+#include <algorithm>
+#include <type_traits>
 
 #include "PluginHelper.hpp"
+#include "ConfigSectionIndex.hpp"
+#include "CompactConfig.hpp"
+#include "KnownTypes.hpp"
+#include "NumberParser.hpp"
+#include "TaskModelHelper.hpp"
+#include "PartialTaskContextProxy.hpp"
+#include "Tracing.hpp"
+#include "Executor.hpp"
 #include <lib_config/YAMLConfiguration.hpp>
 
 using namespace orocos_cpp;
@@ -20,79 +32,23 @@ using namespace libConfig;
 
 
 template <typename T>
-bool applyValue(Typelib::Value &value, const SimpleConfigValue& conf)
+bool applyValue(Typelib::Value &value, const std::string &conf, const std::string &name)
 {
-    T *val = static_cast<T *>(value.getData());
-    try {
-        *val = boost::lexical_cast<T>(conf.getValue());
-    } catch (boost::bad_lexical_cast bc)
-    {
-        std::cout << "Error, could not set value " << conf.getValue() << " on property " << conf.getName() << " Bad lexical cast : " << bc.what() << std::endl;
-        std::cout << " Target Type " << value.getType().getName() << std::endl;
-        return false;
-    }
-    return true;
-}
-
-template <>
-bool applyValue<uint8_t>(Typelib::Value &value, const SimpleConfigValue& conf)
-{
-    uint8_t *val = static_cast<uint8_t *>(value.getData());
-    try {
-        *val = boost::numeric_cast<uint8_t>(boost::lexical_cast<unsigned int>(conf.getValue()));
-    } catch (boost::bad_lexical_cast bc)
-    {
-        std::cout << "Error, could not set value " << conf.getValue() << " on property " << conf.getName() << " Bad lexical cast : " << bc.what() << std::endl;
-        std::cout << " Target Type " << value.getType().getName() << std::endl;
-        return false;
-    }
-    return true;
-}
-
-template <>
-bool applyValue<int8_t>(Typelib::Value &value, const SimpleConfigValue& conf)
-{
-    int8_t *val = static_cast<int8_t *>(value.getData());
-    try {
-        *val = boost::numeric_cast<int8_t>(boost::lexical_cast<int>(conf.getValue()));
-    } catch (boost::bad_lexical_cast bc)
+    std::string error;
+    if(!parseConfigScalar(conf, *static_cast<T *>(value.getData()), error))
     {
-        std::cout << "Error, could not set value " << conf.getValue() << " on property " << conf.getName() << " Bad lexical cast : " << bc.what() << std::endl;
+        std::cout << "Error, could not set value " << conf << " on property " << name << " Bad lexical cast : " << error << std::endl;
         std::cout << " Target Type " << value.getType().getName() << std::endl;
         return false;
     }
     return true;
 }
 
-template <>
-bool applyValue<double>(Typelib::Value &value, const SimpleConfigValue& conf)
-{
-    double *val = static_cast<double *>(value.getData());
-    std::string  copy = conf.getValue();
-    std::transform(copy.begin(), copy.end(), copy.begin(), ::tolower);
-    if (copy.find("nan") != std::string::npos) {
-	*val = std::numeric_limits<double>::quiet_NaN();
-    } 
-    else 
-    {
-      try {
-	  *val = boost::lexical_cast<double>(conf.getValue());
-      } 
-      catch (boost::bad_lexical_cast bc)
-      {
-	  std::cout << "Error, could not set value " << conf.getValue() << " on property " << conf.getName() << " Bad lexical cast : " << bc.what() << std::endl;
-	  std::cout << " Target Type " << value.getType().getName() << std::endl;
-	  return false;
-      }
-    }
-    return true;
-}
-
-bool applyConfOnTypelibEnum(Typelib::Value &value, const SimpleConfigValue& conf)
+bool applyConfOnTypelibEnum(Typelib::Value &value, const std::string &conf, const std::string &name)
 {
     const Typelib::Enum *myenum = dynamic_cast<const Typelib::Enum *>(&(value.getType()));
 
-    if(conf.getValue().empty())
+    if(conf.empty())
     {
         std::cout << "Error, given enum is an empty string" << std::endl;
         return false;
@@ -100,16 +56,16 @@ bool applyConfOnTypelibEnum(Typelib::Value &value, const SimpleConfigValue& conf
     
     //values are sometimes given as RUBY constants. We need to remove the ':' in front of them
     std::string enumName;
-    if(conf.getValue().at(0) == ':')
-        enumName = conf.getValue().substr(1, conf.getValue().size());
+    if(conf.at(0) == ':')
+        enumName = conf.substr(1, conf.size());
     else
-        enumName = conf.getValue();
+        enumName = conf;
     
     std::map<std::string, int>::const_iterator it = myenum->values().find(enumName);
     
     if(it == myenum->values().end())
     {
-        std::cout << "Error : " << conf.getValue() << " is not a valid enum name " << std::endl;
+        std::cout << "Error : " << conf << " is not a valid enum name " << std::endl;
         std::cout << "Valid enum names :" << std::endl;
         for(const std::pair<std::string, int> &v : myenum->values())
         {
@@ -138,7 +94,7 @@ bool applyConfOnTypelibEnum(Typelib::Value &value, const SimpleConfigValue& conf
     return true;
 }
 
-bool applyConfOnTypelibNumeric(Typelib::Value &value, const SimpleConfigValue& conf)
+bool applyConfOnTypelibNumeric(Typelib::Value &value, const std::string &conf, const std::string &name)
 {
     const Typelib::Numeric *num = dynamic_cast<const Typelib::Numeric *>(&(value.getType()));
     
@@ -147,28 +103,28 @@ bool applyConfOnTypelibNumeric(Typelib::Value &value, const SimpleConfigValue& c
         case Typelib::Numeric::Float:
             if(num->getSize() == sizeof(float))
             {
-                return applyValue<float>(value, conf);
+                return applyValue<float>(value, conf, name);
             }
             else
             {
                 //double case
-                return applyValue<double>(value, conf);
+                return applyValue<double>(value, conf, name);
             }
             break;
         case Typelib::Numeric::SInt:
             switch(num->getSize())
             {
                 case sizeof(int8_t):
-                    return applyValue<int8_t>(value, conf);
+                    return applyValue<int8_t>(value, conf, name);
                     break;
                 case sizeof(int16_t):
-                    return applyValue<int16_t>(value, conf);
+                    return applyValue<int16_t>(value, conf, name);
                     break;
                 case sizeof(int32_t):
-                    return applyValue<int32_t>(value, conf);
+                    return applyValue<int32_t>(value, conf, name);
                     break;
                 case sizeof(int64_t):
-                    return applyValue<int64_t>(value, conf);
+                    return applyValue<int64_t>(value, conf, name);
                     break;
                 default:
                     std::cout << "Error, got integer of unexpected size " << num->getSize() << std::endl;
@@ -179,30 +135,30 @@ bool applyConfOnTypelibNumeric(Typelib::Value &value, const SimpleConfigValue& c
         case Typelib::Numeric::UInt:
         {
             //HACK typelib encodes bools as unsigned integer. Brrrrr
-            std::string lowerCase = conf.getValue();
+            std::string lowerCase = conf;
             std::transform(lowerCase.begin(), lowerCase.end(), lowerCase.begin(), ::tolower);
             if(lowerCase == "true")
             {
-                return applyConfOnTypelibNumeric(value, SimpleConfigValue("1"));
+                return applyConfOnTypelibNumeric(value, "1", name);
             }
             if(lowerCase == "false")
             {
-                return applyConfOnTypelibNumeric(value, SimpleConfigValue("0"));
+                return applyConfOnTypelibNumeric(value, "0", name);
             }
             
             switch(num->getSize())
             {
                 case sizeof(uint8_t):
-                    return applyValue<uint8_t>(value, conf);
+                    return applyValue<uint8_t>(value, conf, name);
                     break;
                 case sizeof(uint16_t):
-                    return applyValue<uint16_t>(value, conf);
+                    return applyValue<uint16_t>(value, conf, name);
                     break;
                 case sizeof(uint32_t):
-                    return applyValue<uint32_t>(value, conf);
+                    return applyValue<uint32_t>(value, conf, name);
                     break;
                 case sizeof(uint64_t):
-                    return applyValue<uint64_t>(value, conf);
+                    return applyValue<uint64_t>(value, conf, name);
                     break;
                 default:
                     std::cout << "Error, got integer of unexpected size " << num->getSize() << std::endl;
@@ -219,6 +175,278 @@ bool applyConfOnTypelibNumeric(Typelib::Value &value, const SimpleConfigValue& c
 }
 
 
+/**
+ * Decodes base64 encoded data (e.g. YAML !!binary scalars).
+ * Whitespace is ignored. The data must consist of complete quartets,
+ * and unused bits must be zero, so that arbitrary words are rejected.
+ * decoded is only changed on success.
+ * */
+bool decodeBase64(const std::string &encoded, std::vector<uint8_t> &decoded)
+{
+    static const int8_t INVALID = -1;
+    static const int8_t SKIP = -2;
+
+    struct DecodingTable
+    {
+        int8_t values[256];
+        DecodingTable()
+        {
+            std::fill(values, values + 256, INVALID);
+            const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            for(int8_t i = 0; i < 64; i++)
+                values[static_cast<uint8_t>(alphabet[i])] = i;
+            values[static_cast<uint8_t>(' ')] = SKIP;
+            values[static_cast<uint8_t>('\n')] = SKIP;
+            values[static_cast<uint8_t>('\r')] = SKIP;
+            values[static_cast<uint8_t>('\t')] = SKIP;
+        }
+    };
+    static const DecodingTable table;
+
+    std::vector<uint8_t> result;
+    result.reserve(encoded.size() / 4 * 3);
+
+    uint32_t accumulator = 0;
+    int bits = 0;
+    size_t padding = 0;
+    size_t length = 0;
+    for(const char c: encoded)
+    {
+        if(c == '=')
+        {
+            padding++;
+            length++;
+            continue;
+        }
+
+        int8_t v = table.values[static_cast<uint8_t>(c)];
+        if(v == SKIP)
+            continue;
+        if(v == INVALID || padding)
+            return false;
+
+        length++;
+        accumulator = (accumulator << 6) | v;
+        bits += 6;
+        if(bits >= 8)
+        {
+            bits -= 8;
+            result.push_back(static_cast<uint8_t>(accumulator >> bits));
+            accumulator &= (1 << bits) - 1;
+        }
+    }
+
+    //a single character of a quartet does not make a byte,
+    //the bits left over must be zero in valid data
+    if(length % 4 || padding > 2 || bits >= 6 || accumulator)
+        return false;
+
+    decoded.swap(result);
+    return true;
+}
+
+/**
+ * Scalars of an ArrayConfigValue, nullptr for elements that are no scalar
+ * */
+class ConfigElements
+{
+public:
+    explicit ConfigElements(const ArrayConfigValue &array) : values(array.getValues())
+    {
+    }
+
+    size_t size() const
+    {
+        return values.size();
+    }
+
+    const std::string *operator[](size_t index) const
+    {
+        const ConfigValue &value(*values[index]);
+        if(value.getType() != ConfigValue::SIMPLE)
+            return nullptr;
+        return &static_cast<const SimpleConfigValue &>(value).getValue();
+    }
+
+private:
+    const std::vector<std::shared_ptr<ConfigValue> > &values;
+};
+
+/**
+ * Scalars of an ARRAY CompactConfigValue, nullptr for elements that are no scalar
+ * */
+class CompactConfigElements
+{
+public:
+    explicit CompactConfigElements(const CompactConfigValue &array) : array(array)
+    {
+    }
+
+    size_t size() const
+    {
+        return array.getSize();
+    }
+
+    const std::string *operator[](size_t index) const
+    {
+        const CompactConfigValue element(array.getElement(index));
+        if(element.getType() != CompactConfig::SIMPLE)
+            return nullptr;
+        //the string is owned by the CompactConfig
+        return &element.getValue();
+    }
+
+private:
+    const CompactConfigValue &array;
+};
+
+/**
+ * Numbers that are parsed in bulk. Bools are left to the interpreter,
+ * a typelib vector of bools is a std::vector<bool>.
+ * */
+bool isBulkNumeric(const Typelib::Type &type)
+{
+    return type.getCategory() == Typelib::Type::Numeric && type.getName() != "/bool";
+}
+
+/**
+ * std::vector<uint8_t> and std::vector<int8_t>, whose storage may be
+ * accessed as std::vector<uint8_t>. Not std::vector<bool>.
+ * */
+bool isByteContainer(const Typelib::Container &cont)
+{
+    const Typelib::Type &indirect = cont.getIndirection();
+    return cont.kind() == "/std/vector" && isBulkNumeric(indirect) && indirect.getSize() == 1;
+}
+
+template <typename T, typename Elements>
+bool parseNumbers(void *data, const Elements &elements, const std::string &name)
+{
+    T *dest = static_cast<T *>(data);
+    std::string error;
+    for(size_t i = 0; i < elements.size(); i++)
+    {
+        const std::string *conf = elements[i];
+        if(!conf)
+        {
+            std::cout << "Error, element " << i << " of " << name << " is not a scalar" << std::endl;
+            return false;
+        }
+        if(parseConfigScalar(*conf, dest[i], error))
+            continue;
+
+        //HACK typelib encodes bools as unsigned integer
+        if(std::is_unsigned<T>::value)
+        {
+            std::string lowerCase = *conf;
+            std::transform(lowerCase.begin(), lowerCase.end(), lowerCase.begin(), ::tolower);
+            if(lowerCase == "true" || lowerCase == "false")
+            {
+                dest[i] = lowerCase == "true";
+                continue;
+            }
+        }
+
+        std::cout << "Error, could not set value " << *conf << " on element " << i << " of " << name << " Bad lexical cast : " << error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+template <typename T>
+void *resizeVector(void *data, size_t size)
+{
+    std::vector<T> &vector(*static_cast<std::vector<T> *>(data));
+    vector.resize(size);
+    return vector.data();
+}
+
+/**
+ * Parses an array of scalars straight into contiguous numbers of the
+ * given type, e.g. a double[N] or the storage of a std::vector<double>,
+ * without a Typelib::Value and a recursion per element.
+ * If vector is true, data is a std::vector and resized first.
+ * */
+template <typename Elements>
+bool applyConfOnNumbers(void *data, const Typelib::Numeric &num, const Elements &elements, bool vector, const std::string &name)
+{
+    OROCOS_CPP_TRACE_SCOPE("applyConfOnNumbers", name);
+
+    const size_t size = elements.size();
+    switch(num.getNumericCategory())
+    {
+        case Typelib::Numeric::Float:
+            if(num.getSize() == sizeof(float))
+                return parseNumbers<float>(vector ? resizeVector<float>(data, size) : data, elements, name);
+            return parseNumbers<double>(vector ? resizeVector<double>(data, size) : data, elements, name);
+        case Typelib::Numeric::SInt:
+            switch(num.getSize())
+            {
+                case sizeof(int8_t):
+                    return parseNumbers<int8_t>(vector ? resizeVector<int8_t>(data, size) : data, elements, name);
+                case sizeof(int16_t):
+                    return parseNumbers<int16_t>(vector ? resizeVector<int16_t>(data, size) : data, elements, name);
+                case sizeof(int32_t):
+                    return parseNumbers<int32_t>(vector ? resizeVector<int32_t>(data, size) : data, elements, name);
+                case sizeof(int64_t):
+                    return parseNumbers<int64_t>(vector ? resizeVector<int64_t>(data, size) : data, elements, name);
+            }
+            break;
+        case Typelib::Numeric::UInt:
+            switch(num.getSize())
+            {
+                case sizeof(uint8_t):
+                    return parseNumbers<uint8_t>(vector ? resizeVector<uint8_t>(data, size) : data, elements, name);
+                case sizeof(uint16_t):
+                    return parseNumbers<uint16_t>(vector ? resizeVector<uint16_t>(data, size) : data, elements, name);
+                case sizeof(uint32_t):
+                    return parseNumbers<uint32_t>(vector ? resizeVector<uint32_t>(data, size) : data, elements, name);
+                case sizeof(uint64_t):
+                    return parseNumbers<uint64_t>(vector ? resizeVector<uint64_t>(data, size) : data, elements, name);
+            }
+            break;
+        case Typelib::Numeric::NumberOfValidCategories:
+            break;
+    }
+
+    std::cout << "Error, got number of unexpected size " << num.getSize() << std::endl;
+    return false;
+}
+
+/**
+ * Bulk path for std::vector<uint8_t> and std::vector<int8_t>.
+ * A scalar config value is interpreted as base64 encoded
+ * binary data, an array as list of numbers.
+ * */
+bool applyConfOnTypelibByteContainer(Typelib::Value &value, const ConfigValue& conf)
+{
+    const Typelib::Container &cont = dynamic_cast<const Typelib::Container &>(value.getType());
+    const Typelib::Type &indirect = cont.getIndirection();
+
+    //the storage of a typelib vector is a std::vector
+    std::vector<uint8_t> &bytes(*static_cast<std::vector<uint8_t> *>(value.getData()));
+
+    if(conf.getType() == ConfigValue::SIMPLE)
+    {
+        const SimpleConfigValue &sconf = dynamic_cast<const SimpleConfigValue &>(conf);
+        if(!decodeBase64(sconf.getValue(), bytes))
+        {
+            std::cout << "Error, value of " << conf.getName() << " of type " << value.getType().getName() << " is neither an array nor valid base64 data" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    if(conf.getType() != ConfigValue::ARRAY)
+    {
+        std::cout << "Error, YAML representation << " << conf.getName() << " of type " << value.getType().getName() << " is not an array " << std::endl;
+        return false;
+    }
+
+    const ArrayConfigValue &array = dynamic_cast<const ArrayConfigValue &>(conf);
+    return applyConfOnNumbers(value.getData(), static_cast<const Typelib::Numeric &>(indirect), ConfigElements(array), true, conf.getName());
+}
+
 bool applyConfOnTyplibValue(Typelib::Value &value, const ConfigValue& conf)
 {
     switch(value.getType().getCategory())
@@ -236,6 +464,9 @@ bool applyConfOnTyplibValue(Typelib::Value &value, const ConfigValue& conf)
                 std::cout << "Error: Array " << arrayConfig.getName() << " of properties has different size than array in config file" << std::endl;
                 return false;
             }
+
+            if(isBulkNumeric(indirect))
+                return applyConfOnNumbers(value.getData(), static_cast<const Typelib::Numeric &>(indirect), ConfigElements(arrayConfig), false, conf.getName());
             
             for(size_t i = 0;i < arraySize; i++)
             {
@@ -298,14 +529,14 @@ bool applyConfOnTyplibValue(Typelib::Value &value, const ConfigValue& conf)
                     }
                     const SimpleConfigValue &sconf = dynamic_cast<const SimpleConfigValue &>(conf);
 
-                    size_t chars = sconf.getValue().size();
-                    for(size_t i = 0; i < chars; i++)
-                    {
-                    	Typelib::Value singleChar((void *)( sconf.getValue().c_str() + i), indirect);
-                        cont.push(value.getData(), singleChar);
-                    }
+                    //the storage of a typelib string is a std::string, assign in one go
+                    *static_cast<std::string *>(value.getData()) = sconf.getValue();
                     break;
                 }
+                else if(isByteContainer(cont))
+                {
+                    return applyConfOnTypelibByteContainer(value, conf);
+                }
                 else
                 {
                     if(conf.getType() != ConfigValue::ARRAY)
@@ -315,7 +546,9 @@ bool applyConfOnTyplibValue(Typelib::Value &value, const ConfigValue& conf)
                         return false;
                     }
                     const ArrayConfigValue &array = dynamic_cast<const ArrayConfigValue &>(conf);
-                    
+
+                    if(cont.kind() == "/std/vector" && isBulkNumeric(indirect))
+                        return applyConfOnNumbers(value.getData(), static_cast<const Typelib::Numeric &>(indirect), ConfigElements(array), true, conf.getName());
 
                     for(const std::shared_ptr<ConfigValue> val: array.getValues())
                     {
@@ -336,10 +569,10 @@ bool applyConfOnTyplibValue(Typelib::Value &value, const ConfigValue& conf)
             }
             break;
         case Typelib::Type::Enum:
-            return applyConfOnTypelibEnum(value, dynamic_cast<const SimpleConfigValue &>(conf));
+            return applyConfOnTypelibEnum(value, dynamic_cast<const SimpleConfigValue &>(conf).getValue(), conf.getName());
             break;
         case Typelib::Type::Numeric:
-            return applyConfOnTypelibNumeric(value, dynamic_cast<const SimpleConfigValue &>(conf));
+            return applyConfOnTypelibNumeric(value, dynamic_cast<const SimpleConfigValue &>(conf).getValue(), conf.getName());
             break;
         case Typelib::Type::Opaque:
             std::cout << "Warning, opaque is not supported" << std::endl;
@@ -354,39 +587,173 @@ bool applyConfOnTyplibValue(Typelib::Value &value, const ConfigValue& conf)
     return true;
 }
 
-bool ConfigurationHelper::applyConfToProperty(RTT::TaskContext* context, const std::string& propertyName, const libConfig::ConfigValue& value)
+/**
+ * Same as applyConfOnTyplibValue, but on a merged view of compact
+ * config sections. Nothing is copied while walking the config.
+ * */
+bool applyCompactConfOnTyplibValue(Typelib::Value &value, const CompactConfigValue& conf)
 {
-    RTT::base::PropertyBase *property = context->getProperty(propertyName);
-    if(!property)
+    if(conf.hasConflict())
     {
-        std::cout << "Error, there is no property with the name '" << propertyName << "' in the TaskContext " << context->getName() << std::endl;
-        
-        RTT::PropertyBag *bag = context->properties();
-        
-        std::cout << "Known Properties " << std::endl;
-        for(RTT::base::PropertyBase *prop: *bag)
-        {
-            std::cout << "Name " << prop->getName() << std::endl;
-        }
-        
-        
+        std::cout << "Error, the merged configurations define " << conf.getName() << " with different types" << std::endl;
         return false;
     }
 
-    //get Typelib value
-    const RTT::types::TypeInfo* typeInfo = property->getTypeInfo();
+    switch(value.getType().getCategory())
+    {
+        case Typelib::Type::Array:
+        {
+            const Typelib::Array &array = dynamic_cast<const Typelib::Array &>(value.getType());
+            const Typelib::Type &indirect = array.getIndirection();
 
-    //get data source
-    RTT::base::DataSourceBase::shared_ptr ds = property->getDataSource();
+            size_t arraySize = array.getDimension();
+
+            if(conf.getType() != CompactConfig::ARRAY || conf.getSize() != arraySize)
+            {
+                std::cout << "Error: Array " << conf.getName() << " of properties has different size than array in config file" << std::endl;
+                return false;
+            }
+
+            if(isBulkNumeric(indirect))
+                return applyConfOnNumbers(value.getData(), static_cast<const Typelib::Numeric &>(indirect), CompactConfigElements(conf), false, conf.getName());
+
+            for(size_t i = 0;i < arraySize; i++)
+            {
+                Typelib::Value v(reinterpret_cast<uint8_t *>(value.getData()) + indirect.getSize() * i, indirect);
+                if(!applyCompactConfOnTyplibValue(v, conf.getElement(i)))
+                    return false;
+            }
+        }
+        break;
+        case Typelib::Type::Compound:
+        {
+            const Typelib::Compound &comp = dynamic_cast<const Typelib::Compound &>(value.getType());
+            if(conf.getType() != CompactConfig::COMPLEX)
+            {
+                std::cout << "Error, YAML representation << " << conf.getName() << " of type " << value.getType().getName() << " is not a map " << std::endl;
+                return false;
+            }
+
+            size_t usedFields = 0;
+            CompactConfigValue fieldConf(conf);
+            for(const Typelib::Field &field: comp.getFields())
+            {
+                if(!conf.getField(field.getName(), fieldConf))
+                    continue;
+
+                usedFields++;
+                Typelib::Value fieldValue(((uint8_t *) value.getData()) + field.getOffset(), field.getType());
+                if(!applyCompactConfOnTyplibValue(fieldValue, fieldConf))
+                    return false;
+            }
+
+            if(usedFields != conf.getFieldCount())
+            {
+                std::cout << "Error :" << std::endl;
+                for(const std::string &name: conf.getFieldNames())
+                {
+                    if(!comp.getField(name))
+                        std::cout << "  " << name << std::endl;
+                }
+                std::cout << "is/are not members of " << comp.getName() << std::endl;
+                return false;
+            }
+        }
+            break;
+        case Typelib::Type::Container:
+            {
+                const Typelib::Container &cont = dynamic_cast<const Typelib::Container &>(value.getType());
+                Typelib::zero(value);
+                const Typelib::Type &indirect = cont.getIndirection();
+                if(cont.kind() == "/std/string")
+                {
+                    if(conf.getType() != CompactConfig::SIMPLE)
+                    {
+                        std::cout << "Error, got container in property, but config value " << conf.getName() << " is not a String " << std::endl;
+                        return false;
+                    }
+
+                    //the storage of a typelib string is a std::string, assign in one go
+                    *static_cast<std::string *>(value.getData()) = conf.getValue();
+                    break;
+                }
+
+                if(isByteContainer(cont))
+                {
+                    //the storage of a typelib vector is a std::vector
+                    std::vector<uint8_t> &bytes(*static_cast<std::vector<uint8_t> *>(value.getData()));
+                    if(conf.getType() == CompactConfig::SIMPLE)
+                    {
+                        if(!decodeBase64(conf.getValue(), bytes))
+                        {
+                            std::cout << "Error, value of " << conf.getName() << " of type " << value.getType().getName() << " is neither an array nor valid base64 data" << std::endl;
+                            return false;
+                        }
+                        break;
+                    }
+                }
+
+                if(conf.getType() != CompactConfig::ARRAY)
+                {
+                    std::cout << "Error, YAML representation << " << conf.getName() << " of type " << value.getType().getName() << " is not an array " << std::endl;
+                    return false;
+                }
 
-    return applyConfigValueOnDSB(ds, typeInfo, value);
+                if(cont.kind() == "/std/vector" && isBulkNumeric(indirect))
+                    return applyConfOnNumbers(value.getData(), static_cast<const Typelib::Numeric &>(indirect), CompactConfigElements(conf), true, conf.getName());
+
+                std::vector<uint8_t> buffer(indirect.getSize());
+                for(size_t i = 0; i < conf.getSize(); i++)
+                {
+                    Typelib::Value v(buffer.data(), indirect);
+                    Typelib::init(v);
+                    Typelib::zero(v);
 
+                    bool ok = applyCompactConfOnTyplibValue(v, conf.getElement(i));
+                    if(ok)
+                        cont.push(value.getData(), v);
+                    Typelib::destroy(v);
+                    if(!ok)
+                        return false;
+                }
+            }
+            break;
+        case Typelib::Type::Enum:
+        case Typelib::Type::Numeric:
+            if(conf.getType() != CompactConfig::SIMPLE)
+            {
+                std::cout << "Error, config value " << conf.getName() << " of type " << value.getType().getName() << " is not a scalar" << std::endl;
+                return false;
+            }
+            if(value.getType().getCategory() == Typelib::Type::Enum)
+                return applyConfOnTypelibEnum(value, conf.getValue(), conf.getName());
+            return applyConfOnTypelibNumeric(value, conf.getValue(), conf.getName());
+        case Typelib::Type::Opaque:
+            std::cout << "Warning, opaque is not supported" << std::endl;
+            break;
+        case Typelib::Type::Pointer:
+            std::cout << "Warning, pointer is not supported" << std::endl;
+            break;
+        default:
+            std::cout << "Warning, unknown is not supported" << std::endl;
+            break;
+    }
+    return true;
 }
 
+bool applyConf(Typelib::Value &value, const ConfigValue &conf)
+{
+    return applyConfOnTyplibValue(value, conf);
+}
 
-bool ConfigurationHelper::applyConfigValueOnDSB(RTT::base::DataSourceBase::shared_ptr dsb,
-        const RTT::types::TypeInfo* typeInfo, const libConfig::ConfigValue& value){
+bool applyConf(Typelib::Value &value, const CompactConfigValue &conf)
+{
+    return applyCompactConfOnTyplibValue(value, conf);
+}
 
+template <typename Conf>
+bool applyConfOnDSB(RTT::base::DataSourceBase::shared_ptr dsb, const RTT::types::TypeInfo* typeInfo, const Conf& value)
+{
     orogen_transports::TypelibMarshallerBase *typelibTransport =
             dynamic_cast<orogen_transports::TypelibMarshallerBase*>(
                     typeInfo->getProtocol(orogen_transports::TYPELIB_MARSHALLER_ID));
@@ -406,7 +773,7 @@ bool ConfigurationHelper::applyConfigValueOnDSB(RTT::base::DataSourceBase::share
         typelibTransport->refreshTypelibSample(handle);
     }
 
-    if(!applyConfOnTyplibValue(dest, value))
+    if(!applyConf(dest, value))
         return false;
     
 
@@ -423,20 +790,461 @@ bool ConfigurationHelper::applyConfigValueOnDSB(RTT::base::DataSourceBase::share
     return true;
 }
 
+/**
+ * Same as applyConfOnDSB, but for data sources of tasks living
+ * in this process. If the C++ type is a plain Typelib type, the
+ * configuration is applied on a copy of the storage of the data
+ * source, without creating and marshalling a sample. The copy is
+ * written back only if the whole configuration could be applied.
+ * */
+template <typename Conf>
+bool applyConfOnLocalDSB(RTT::base::DataSourceBase::shared_ptr dsb, const RTT::types::TypeInfo* typeInfo, const Conf& value)
+{
+    orogen_transports::TypelibMarshallerBase *typelibTransport =
+            dynamic_cast<orogen_transports::TypelibMarshallerBase*>(
+                    typeInfo->getProtocol(orogen_transports::TYPELIB_MARSHALLER_ID));
+
+    //opaques need the marshaller to convert between the orocos and the typelib type
+    if(!typelibTransport || !typelibTransport->isPlainTypelibType())
+        return applyConfOnDSB(dsb, typeInfo, value);
+
+    //the C++ type is the typelib type, so we can work on the native storage
+    void *data = dsb->getRawPointer();
+    if(!data)
+        return applyConfOnDSB(dsb, typeInfo, value);
+
+    const Typelib::Type *type = typelibTransport->getRegistry().get(typelibTransport->getMarshallingType());
+
+    Typelib::Value dest(data, *type);
+
+    //applied on a scratch copy first, an apply that fails halfway must
+    //leave the property untouched, like the sample of applyConfOnDSB
+    std::vector<uint8_t> buffer(type->getSize());
+    Typelib::Value scratch(buffer.data(), *type);
+    Typelib::init(scratch);
+    bool ok = false;
+    try {
+        Typelib::copy(scratch, dest);
+        ok = applyConf(scratch, value);
+        if(ok)
+            Typelib::copy(dest, scratch);
+    } catch (...)
+    {
+        Typelib::destroy(scratch);
+        throw;
+    }
+    Typelib::destroy(scratch);
+
+    if(!ok)
+        return false;
+
+    //notify the task about the change
+    dsb->updated();
+
+    return true;
+}
+
+std::string configTypeName(ConfigValue::Type type)
+{
+    switch(type)
+    {
+        case ConfigValue::SIMPLE:
+            return "a scalar";
+        case ConfigValue::COMPLEX:
+            return "a map";
+        case ConfigValue::ARRAY:
+            return "an array";
+    }
+    return "unknown";
+}
+
+template <typename T>
+bool validateScalar(const Typelib::Numeric &num, const std::string &value, std::string &error)
+{
+    T parsed;
+    std::string parseError;
+    if(!parseConfigScalar(value, parsed, parseError))
+    {
+        error = "value '" + value + "' is not a valid " + num.getName() + " : " + parseError;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Accepts exactly the values applyConfOnTypelibNumeric accepts
+ * */
+bool validateNumeric(const Typelib::Numeric &num, const std::string &value, std::string &error)
+{
+    switch(num.getNumericCategory())
+    {
+        case Typelib::Numeric::Float:
+            if(num.getSize() == sizeof(float))
+                return validateScalar<float>(num, value, error);
+            return validateScalar<double>(num, value, error);
+        case Typelib::Numeric::SInt:
+            switch(num.getSize())
+            {
+                case sizeof(int8_t):
+                    return validateScalar<int8_t>(num, value, error);
+                case sizeof(int16_t):
+                    return validateScalar<int16_t>(num, value, error);
+                case sizeof(int32_t):
+                    return validateScalar<int32_t>(num, value, error);
+                case sizeof(int64_t):
+                    return validateScalar<int64_t>(num, value, error);
+            }
+            break;
+        case Typelib::Numeric::UInt:
+        {
+            //bools are encoded as unsigned integers
+            std::string lowerCase = value;
+            std::transform(lowerCase.begin(), lowerCase.end(), lowerCase.begin(), ::tolower);
+            if(lowerCase == "true" || lowerCase == "false")
+                return true;
+
+            switch(num.getSize())
+            {
+                case sizeof(uint8_t):
+                    return validateScalar<uint8_t>(num, value, error);
+                case sizeof(uint16_t):
+                    return validateScalar<uint16_t>(num, value, error);
+                case sizeof(uint32_t):
+                    return validateScalar<uint32_t>(num, value, error);
+                case sizeof(uint64_t):
+                    return validateScalar<uint64_t>(num, value, error);
+            }
+            break;
+        }
+        case Typelib::Numeric::NumberOfValidCategories:
+            error = "internal error, invalid numeric category of " + num.getName();
+            return false;
+    }
+
+    error = "integer " + num.getName() + " has unexpected size " + boost::lexical_cast<std::string>(num.getSize());
+    return false;
+}
+
+/**
+ * Checks if the configuration could be applied on a value of the given
+ * type, without touching any value. In contrast to applyConfOnTyplibValue
+ * it does not stop on the first error, but collects all of them.
+ * */
+void validateConfOnTypelibType(const Typelib::Type &type, const ConfigValue &conf, const std::string &path, std::vector<std::string> &errors)
+{
+    switch(type.getCategory())
+    {
+        case Typelib::Type::Array:
+        {
+            if(conf.getType() != ConfigValue::ARRAY)
+            {
+                errors.push_back(path + ": expected an array for " + type.getName() + ", got " + configTypeName(conf.getType()));
+                return;
+            }
+            const Typelib::Array &array = dynamic_cast<const Typelib::Array &>(type);
+            const ArrayConfigValue &arrayConfig = dynamic_cast<const ArrayConfigValue &>(conf);
+            if(arrayConfig.getValues().size() != array.getDimension())
+            {
+                errors.push_back(path + ": array of size " + boost::lexical_cast<std::string>(arrayConfig.getValues().size())
+                                 + " given for " + type.getName());
+                return;
+            }
+            for(size_t i = 0; i < arrayConfig.getValues().size(); i++)
+                validateConfOnTypelibType(array.getIndirection(), *(arrayConfig.getValues()[i]), path + "[" + boost::lexical_cast<std::string>(i) + "]", errors);
+        }
+            break;
+        case Typelib::Type::Compound:
+        {
+            if(conf.getType() != ConfigValue::COMPLEX)
+            {
+                errors.push_back(path + ": expected a map for " + type.getName() + ", got " + configTypeName(conf.getType()));
+                return;
+            }
+            const Typelib::Compound &comp = dynamic_cast<const Typelib::Compound &>(type);
+            const ComplexConfigValue &cpx = dynamic_cast<const ComplexConfigValue &>(conf);
+            for(const std::pair<const std::string, std::shared_ptr<ConfigValue> > &entry: cpx.getValues())
+            {
+                const Typelib::Field *field = comp.getField(entry.first);
+                if(!field)
+                {
+                    errors.push_back(path + "." + entry.first + ": is not a member of " + comp.getName());
+                    continue;
+                }
+                validateConfOnTypelibType(field->getType(), *(entry.second), path + "." + entry.first, errors);
+            }
+        }
+            break;
+        case Typelib::Type::Container:
+        {
+            const Typelib::Container &cont = dynamic_cast<const Typelib::Container &>(type);
+            if(cont.kind() == "/std/string")
+            {
+                if(conf.getType() != ConfigValue::SIMPLE)
+                    errors.push_back(path + ": expected a string, got " + configTypeName(conf.getType()));
+                return;
+            }
+            if(isByteContainer(cont) && conf.getType() == ConfigValue::SIMPLE)
+            {
+                std::vector<uint8_t> decoded;
+                if(!decodeBase64(dynamic_cast<const SimpleConfigValue &>(conf).getValue(), decoded))
+                    errors.push_back(path + ": invalid base64 data for " + type.getName());
+                return;
+            }
+            if(conf.getType() != ConfigValue::ARRAY)
+            {
+                errors.push_back(path + ": expected an array for " + type.getName() + ", got " + configTypeName(conf.getType()));
+                return;
+            }
+            const ArrayConfigValue &arrayConfig = dynamic_cast<const ArrayConfigValue &>(conf);
+            for(size_t i = 0; i < arrayConfig.getValues().size(); i++)
+                validateConfOnTypelibType(cont.getIndirection(), *(arrayConfig.getValues()[i]), path + "[" + boost::lexical_cast<std::string>(i) + "]", errors);
+        }
+            break;
+        case Typelib::Type::Enum:
+        {
+            if(conf.getType() != ConfigValue::SIMPLE)
+            {
+                errors.push_back(path + ": expected an enum value of " + type.getName() + ", got " + configTypeName(conf.getType()));
+                return;
+            }
+            const Typelib::Enum &myenum = dynamic_cast<const Typelib::Enum &>(type);
+            std::string enumName = dynamic_cast<const SimpleConfigValue &>(conf).getValue();
+            if(!enumName.empty() && enumName.at(0) == ':')
+                enumName = enumName.substr(1);
+            if(myenum.values().find(enumName) == myenum.values().end())
+            {
+                std::string valid;
+                for(const std::pair<const std::string, int> &v : myenum.values())
+                    valid += " " + v.first;
+                errors.push_back(path + ": '" + enumName + "' is not a valid value of " + type.getName() + ", valid values are" + valid);
+            }
+            else if(myenum.getSize() != sizeof(int32_t))
+            {
+                errors.push_back(path + ": only 32 bit enums are supported, " + type.getName() + " is not");
+            }
+        }
+            break;
+        case Typelib::Type::Numeric:
+        {
+            if(conf.getType() != ConfigValue::SIMPLE)
+            {
+                errors.push_back(path + ": expected a number of type " + type.getName() + ", got " + configTypeName(conf.getType()));
+                return;
+            }
+            std::string error;
+            if(!validateNumeric(dynamic_cast<const Typelib::Numeric &>(type), dynamic_cast<const SimpleConfigValue &>(conf).getValue(), error))
+                errors.push_back(path + ": " + error);
+        }
+            break;
+        default:
+            //not supported by applyConfOnTyplibValue either, it is skipped with a warning
+            break;
+    }
+}
+
+const Typelib::Type *getTypelibType(const std::string &typeName)
+{
+    RTT::types::TypeInfo *typeInfo = RTT::types::TypeInfoRepository::Instance()->type(typeName);
+    if(!typeInfo)
+        return nullptr;
+
+    orogen_transports::TypelibMarshallerBase *typelibTransport =
+            dynamic_cast<orogen_transports::TypelibMarshallerBase*>(
+                    typeInfo->getProtocol(orogen_transports::TYPELIB_MARSHALLER_ID));
+    if(!typelibTransport)
+        return nullptr;
+
+    return typelibTransport->getRegistry().get(typelibTransport->getMarshallingType());
+}
+
+bool ConfigurationHelper::validateConfig(const std::string& modelName, const std::vector< std::string >& names, std::vector< std::string >& errors)
+{
+    Bundle &bundle(Bundle::getInstance());
+    return validateConfig(bundle.getConfigurationDirectory() + modelName + ".yml", modelName, names, errors);
+}
+
+bool ConfigurationHelper::validateConfig(const std::string& configFilePath, const std::string& modelName, const std::vector< std::string >& names, std::vector< std::string >& errors)
+{
+    OROCOS_CPP_TRACE_SCOPE("ConfigurationHelper::validateConfig", modelName);
+    const size_t errorsBefore = errors.size();
+
+    std::map<std::string, std::string> propertyTypes;
+    if(!TaskModelHelper::getPropertyTypes(modelName, propertyTypes))
+    {
+        errors.push_back("could not read the description of model " + modelName);
+        return false;
+    }
+
+    //parsed into a local map, validation does not change the sections
+    //used by applyConfig
+    std::map<std::string, Configuration> configs;
+    {
+        OROCOS_CPP_TRACE_SCOPE("ConfigurationHelper::loadConfigFile", configFilePath);
+        //only the requested sections are parsed
+        if(!ConfigSectionIndex::loadSections(configFilePath, names, configs))
+        {
+            errors.push_back("could not parse " + configFilePath);
+            return false;
+        }
+    }
+
+    if(names.empty())
+        errors.push_back("no configuration section given");
+    for(const std::string &name: names)
+    {
+        if(configs.find(name) == configs.end())
+            errors.push_back("section '" + name + "' not found in " + configFilePath);
+    }
+    if(errors.size() != errorsBefore)
+        return false;
+
+    Configuration config("Merged");
+    if(!mergeConfig(configs, names, config))
+    {
+        errors.push_back("merging of the sections of " + configFilePath + " failed");
+        return false;
+    }
+
+    //load everything needed to resolve the property types
+    if(!PluginHelper::hasTypekit("rtt-types"))
+        PluginHelper::loadTypekitAndTransports("rtt-types");
+    PluginHelper::loadAllTypekitsForModel(modelName);
+
+    for(const std::pair<const std::string, std::shared_ptr<ConfigValue> > &entry: config.getValues())
+    {
+        auto it = propertyTypes.find(entry.first);
+        if(it == propertyTypes.end())
+        {
+            errors.push_back(entry.first + ": there is no property with this name in model " + modelName);
+            continue;
+        }
+
+        const Typelib::Type *type = getTypelibType(it->second);
+        if(!type)
+        {
+            errors.push_back(entry.first + ": could not resolve type " + it->second + " from the loaded typekits");
+            continue;
+        }
+
+        std::shared_ptr<KnownTypeHandler> knownType = KnownTypeRegistry::getInstance().get(RTT::types::TypeInfoRepository::Instance()->type(it->second));
+        if(knownType)
+        {
+            knownType->validate(*(entry.second), entry.first, errors);
+            continue;
+        }
+
+        validateConfOnTypelibType(*type, *(entry.second), entry.first, errors);
+    }
+
+    return errors.size() == errorsBefore;
+}
+
+bool ConfigurationHelper::applyConfigValueOnTypelibValue(Typelib::Value& value, const ConfigValue& conf)
+{
+    return applyConfOnTyplibValue(value, conf);
+}
+
+bool ConfigurationHelper::applyConfigValueOnTypelibValue(Typelib::Value& value, const CompactConfigValue& conf)
+{
+    return applyCompactConfOnTyplibValue(value, conf);
+}
+
+RTT::base::PropertyBase *ConfigurationHelper::findProperty(RTT::TaskContext* context, const std::string& propertyName)
+{
+    RTT::base::PropertyBase *property = context->getProperty(propertyName);
+    PartialTaskContextProxy *partialProxy = dynamic_cast<PartialTaskContextProxy *>(context);
+    if(!property && partialProxy)
+        property = partialProxy->fetchProperty(propertyName);
+    if(!property)
+    {
+        std::cout << "Error, there is no property with the name '" << propertyName << "' in the TaskContext " << context->getName() << std::endl;
+        
+        RTT::PropertyBag *bag = context->properties();
+        
+        std::cout << "Known Properties " << std::endl;
+        for(RTT::base::PropertyBase *prop: *bag)
+        {
+            std::cout << "Name " << prop->getName() << std::endl;
+        }
+    }
+    return property;
+}
 
-
-bool ConfigurationHelper::mergeConfig(const std::vector< std::string >& names, Configuration& result)
+bool ConfigurationHelper::applyConfToProperty(RTT::TaskContext* context, const std::string& propertyName, const ConfigValue& value)
 {
+    OROCOS_CPP_TRACE_SCOPE("ConfigurationHelper::applyConfToProperty", propertyName);
+    RTT::base::PropertyBase *property = findProperty(context, propertyName);
+    if(!property)
+        return false;
+
+    const RTT::types::TypeInfo* typeInfo = property->getTypeInfo();
+    RTT::base::DataSourceBase::shared_ptr ds = property->getDataSource();
+
+    //the task lives in our process, we may write directly into the property
+    if(!PartialTaskContextProxy::isProxy(context))
+        return applyConfOnLocalDSB(ds, typeInfo, value);
+
+    return applyConfOnDSB(ds, typeInfo, value);
+}
+
+bool ConfigurationHelper::applyConfToProperty(RTT::TaskContext* context, const std::string& propertyName, const CompactConfigValue& value)
+{
+    OROCOS_CPP_TRACE_SCOPE("ConfigurationHelper::applyConfToProperty", propertyName);
+    RTT::base::PropertyBase *property = findProperty(context, propertyName);
+    if(!property)
+        return false;
+
+    //get Typelib value
+    const RTT::types::TypeInfo* typeInfo = property->getTypeInfo();
+
+    //get data source
+    RTT::base::DataSourceBase::shared_ptr ds = property->getDataSource();
+
+    //types with a compiled field table skip the Typelib interpreter
+    std::shared_ptr<KnownTypeHandler> knownType = KnownTypeRegistry::getInstance().get(typeInfo);
+    if(knownType && knownType->accepts(ds))
+    {
+        std::vector<std::string> errors;
+        if(knownType->apply(ds, value, errors))
+            return true;
+        for(const std::string &error: errors)
+            std::cout << "Error, " << error << std::endl;
+        return false;
+    }
+
+    //the task lives in our process, we may write directly into the property
+    if(!PartialTaskContextProxy::isProxy(context))
+        return applyConfOnLocalDSB(ds, typeInfo, value);
+
+    return applyConfOnDSB(ds, typeInfo, value);
+
+}
+
+bool ConfigurationHelper::applyConfigValueOnDSB(RTT::base::DataSourceBase::shared_ptr dsb,
+        const RTT::types::TypeInfo* typeInfo, const libConfig::ConfigValue& value)
+{
+    return applyConfOnDSB(dsb, typeInfo, value);
+}
+
+bool ConfigurationHelper::applyConfigValueOnDSB(RTT::base::DataSourceBase::shared_ptr dsb,
+        const RTT::types::TypeInfo* typeInfo, const CompactConfigValue& value)
+{
+    return applyConfOnDSB(dsb, typeInfo, value);
+}
+
+bool ConfigurationHelper::mergeConfig(const std::map< std::string, Configuration >& configs, const std::vector< std::string >& names, Configuration& result)
+{
+    OROCOS_CPP_TRACE_SCOPE("ConfigurationHelper::mergeConfig");
     if(names.empty())
         throw std::runtime_error("Error given config array was empty");
     
-    std::map<std::string, Configuration>::const_iterator entry = subConfigs.find(names.front());
+    std::map<std::string, Configuration>::const_iterator entry = configs.find(names.front());
 
-    if(entry == subConfigs.end())
+    if(entry == configs.end())
     {
         std::cout << "Error, config " << names.front() << " not found " << std::endl;
         std::cout << "Known configs:" << std::endl;
-        for(std::map<std::string, Configuration>::const_iterator it = subConfigs.begin(); it != subConfigs.end(); it++)
+        for(std::map<std::string, Configuration>::const_iterator it = configs.begin(); it != configs.end(); it++)
         {
             std::cout << "    \"" << it->first << "\"" << std::endl;
         }
@@ -451,9 +1259,9 @@ bool ConfigurationHelper::mergeConfig(const std::vector< std::string >& names, C
     
     for(; it != names.end(); it++)
     {
-        entry = subConfigs.find(*it);
+        entry = configs.find(*it);
 
-        if(entry == subConfigs.end())
+        if(entry == configs.end())
         {
             std::cout << "Error, merge failed config " << *it << " not found " << std::endl;
             return false;
@@ -471,53 +1279,189 @@ bool ConfigurationHelper::mergeConfig(const std::vector< std::string >& names, C
 
 bool ConfigurationHelper::applyConfig(RTT::TaskContext* context, const Configuration& config)
 {
-    std::map<std::string, std::shared_ptr<ConfigValue> >::const_iterator propIt;
-    for(propIt = config.getValues().begin(); propIt != config.getValues().end(); propIt++)
+    //applied as is, converting a single tree into the compact form costs more than it saves
+    for(const std::pair<const std::string, std::shared_ptr<ConfigValue> > &entry: config.getValues())
     {
-        if(!applyConfToProperty(context, propIt->first, *(propIt->second)))
+        if(!applyConfToProperty(context, entry.first, *entry.second))
         {
-            std::cout << "ERROR configuration of " << propIt->first << " failed" << std::endl;
-            throw std::runtime_error("ERROR configuration of "  + propIt->first + " failed for context " + context->getName());
+            std::cout << "ERROR configuration of " << entry.first << " failed" << std::endl;
+            throw std::runtime_error("ERROR configuration of "  + entry.first + " failed for context " + context->getName());
             return false;
         }
     }
 
-    return true;    
+    return true;
 }
 
+bool ConfigurationHelper::applyConfig(RTT::TaskContext* context, const CompactConfigValue& config)
+{
+    CompactConfigValue propertyConf(config);
+    for(const std::string &name: config.getFieldNames())
+    {
+        config.getField(name, propertyConf);
+        if(!applyConfToProperty(context, name, propertyConf))
+        {
+            std::cout << "ERROR configuration of " << name << " failed" << std::endl;
+            throw std::runtime_error("ERROR configuration of "  + name + " failed for context " + context->getName());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+std::shared_ptr<const CompactConfig> ConfigurationHelper::getCompactConfig(const std::string& configFilePath, const std::vector< std::string >& names)
+{
+    //an unreadable file keeps the zero stamp, parsing reports the error
+    uint64_t size = 0;
+    int64_t modificationTime = 0;
+    ConfigSectionIndex::getFileStamp(configFilePath, size, modificationTime);
+
+    //the common case, the sections were requested before, nothing is copied
+    std::shared_ptr<const ConfigFile> file;
+    if(subConfigs.find(configFilePath, file) && file->size == size && file->modificationTime == modificationTime)
+    {
+        std::map<std::vector<std::string>, std::shared_ptr<const CompactConfig> >::const_iterator it = file->compacts.find(names);
+        if(it != file->compacts.end())
+            return it->second;
+    }
+    else
+        file.reset();
+
+    //parsing and converting is done without holding the lock of the map,
+    //tasks using other files or sections are configured meanwhile
+    std::map<std::string, std::shared_ptr<const Configuration> > sections;
+    std::vector<std::string> unparsed;
+    for(const std::string &name: names)
+    {
+        if(file)
+        {
+            std::map<std::string, std::shared_ptr<const Configuration> >::const_iterator it = file->sections.find(name);
+            if(it != file->sections.end())
+            {
+                sections[name] = it->second;
+                continue;
+            }
+            if(file->missing.count(name))
+                continue;
+        }
+        unparsed.push_back(name);
+    }
+
+    std::set<std::string> missing;
+    if(!unparsed.empty())
+    {
+        std::map<std::string, Configuration> parsed;
+        if(!ConfigSectionIndex::loadSections(configFilePath, unparsed, parsed))
+            throw std::runtime_error("ConfigurationHelper::getCompactConfig : Error, could not parse " + configFilePath);
+
+        //files without index are parsed completely, all sections are kept
+        for(const std::pair<const std::string, Configuration> &section: parsed)
+            sections[section.first] = std::make_shared<const Configuration>(section.second);
+        for(const std::string &name: unparsed)
+        {
+            if(!parsed.count(name))
+                missing.insert(name);
+        }
+    }
+
+    std::shared_ptr<CompactConfig> compact(std::make_shared<CompactConfig>());
+    for(const std::string &name: names)
+    {
+        std::map<std::string, std::shared_ptr<const Configuration> >::const_iterator it = sections.find(name);
+        if(it != sections.end() && !compact->hasSection(name))
+            compact->addSection(*it->second);
+    }
+
+    //the entry is copied, tasks that are configured meanwhile
+    //keep using the sections they already have
+    std::shared_ptr<const CompactConfig> result(compact);
+    subConfigs.update([&](std::map<std::string, std::shared_ptr<const ConfigFile> > &files) {
+        std::shared_ptr<const ConfigFile> &entry(files[configFilePath]);
+        std::shared_ptr<ConfigFile> updated;
+        if(entry && entry->size == size && entry->modificationTime == modificationTime)
+        {
+            //another thread may have converted the same sections meanwhile
+            std::map<std::vector<std::string>, std::shared_ptr<const CompactConfig> >::const_iterator it = entry->compacts.find(names);
+            if(it != entry->compacts.end())
+            {
+                result = it->second;
+                return;
+            }
+            updated = std::make_shared<ConfigFile>(*entry);
+        }
+        else
+        {
+            updated = std::make_shared<ConfigFile>();
+            updated->size = size;
+            updated->modificationTime = modificationTime;
+        }
+
+        updated->sections.insert(sections.begin(), sections.end());
+        updated->missing.insert(missing.begin(), missing.end());
+        updated->compacts[names] = result;
+        entry = updated;
+    });
+    return result;
+}
 
 bool ConfigurationHelper::applyConfig(const std::string& configFilePath, RTT::TaskContext* context, const std::vector< std::string >& names)
 {
-    YAMLConfigParser parser;
-    parser.loadConfigFile(configFilePath, subConfigs);
-    
-    Configuration config("Merged");
-    if(!mergeConfig(names, config))
+    std::shared_ptr<const CompactConfig> compact;
     {
-        throw std::runtime_error("Error, merging of configuarations for context " + context->getName() + " failed ");
-        return false;
+        OROCOS_CPP_TRACE_SCOPE("ConfigurationHelper::loadConfigFile", configFilePath);
+        //only the requested sections are parsed and converted, and only once
+        compact = getCompactConfig(configFilePath, names);
+    }
+
+    if(names.empty())
+        throw std::runtime_error("Error given config array was empty");
+
+    for(const std::string &name: names)
+    {
+        if(!compact->hasSection(name))
+        {
+            std::cout << "Error, config " << name << " not found " << std::endl;
+            std::cout << "Known configs:" << std::endl;
+            for(const std::string &known: compact->getSectionNames())
+            {
+                std::cout << "    \"" << known << "\"" << std::endl;
+            }
+            throw std::runtime_error("Error, merging of configuarations for context " + context->getName() + " failed ");
+        }
     }
-    
-    //finally apply:
-    return applyConfig(context, config);
 
+    //finally apply, the sections are merged as overlays of the shared nodes
+    return applyConfig(context, CompactConfigValue(*compact, names));
 }
 
 bool ConfigurationHelper::applyConfig(RTT::TaskContext* context, const std::vector< std::string >& names)
 {
+    OROCOS_CPP_TRACE_SCOPE("ConfigurationHelper::applyConfig", context->getName());
     Bundle &bundle(Bundle::getInstance());
     
     //we need to figure out the model name first
-    RTT::OperationInterfacePart *op = context->getOperation("getModelName");
-    if(!op)
-        throw std::runtime_error("Could not get model name of task");
-    
-    RTT::OperationCaller< ::std::string() >  caller(op);
-    std::string modelName = caller();
+    std::string modelName;
+    PartialTaskContextProxy *partialProxy = dynamic_cast<PartialTaskContextProxy *>(context);
+    if(partialProxy)
+    {
+        modelName = partialProxy->getModelName();
+    }
+    else
+    {
+        RTT::OperationInterfacePart *op = context->getOperation("getModelName");
+        if(!op)
+            throw std::runtime_error("Could not get model name of task");
+
+        RTT::OperationCaller< ::std::string() >  caller(op);
+        modelName = caller();
+    }
 
     bool syncNeeded = PluginHelper::loadAllTypekitsForModel(modelName);
     
-    //this is not a prox, we don't need to sync
+    //this is not a prox, we don't need to sync. Partial proxies fetch
+    //the properties on demand, after the typekits are loaded
     if(!dynamic_cast<RTT::corba::TaskContextProxy *>(context))
     {
         syncNeeded = false;
@@ -525,12 +1469,11 @@ bool ConfigurationHelper::applyConfig(RTT::TaskContext* context, const std::vect
     
     if(syncNeeded)
     {
-        try {
-            context = RTT::corba::TaskContextProxy::Create(context->getName(), false);
-        } catch(...)
-        {
-            throw std::runtime_error("ConfigurationHelper::applyConfig: Error, could not create Proxy for " + context->getName());
-        }
+        //only the properties are needed
+        std::string taskName = context->getName();
+        context = PartialTaskContextProxy::Create(taskName, false);
+        if(!context)
+            throw std::runtime_error("ConfigurationHelper::applyConfig: Error, could not create Proxy for " + taskName);
     }
     
     if(modelName.empty())
@@ -544,6 +1487,20 @@ bool ConfigurationHelper::applyConfig(RTT::TaskContext* context, const std::vect
     return ret;
 }
 
+std::future<bool> ConfigurationHelper::applyConfigAsync(const std::string& configFilePath, RTT::TaskContext* context, const std::vector< std::string >& names)
+{
+    return Executor::getDefault().submit([this, configFilePath, context, names]() {
+        return applyConfig(configFilePath, context, names);
+    });
+}
+
+std::future<bool> ConfigurationHelper::applyConfigAsync(RTT::TaskContext* context, const std::vector< std::string >& names)
+{
+    return Executor::getDefault().submit([this, context, names]() {
+        return applyConfig(context, names);
+    });
+}
+
 bool ConfigurationHelper::applyConfig(RTT::TaskContext* context, const std::string& conf1)
 {
     std::vector<std::string> configs;
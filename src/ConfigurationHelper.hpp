@@ -2,6 +2,9 @@
 
 #include <rtt/TaskContext.hpp>
 #include <lib_config/Configuration.hpp>
+#include "ConcurrentMap.hpp"
+#include <future>
+#include <set>
 
 
 //forwards:
@@ -13,6 +16,9 @@ namespace Typelib{
 namespace orocos_cpp
 {
 
+class CompactConfig;
+class CompactConfigValue;
+
 class ConfigurationHelper
 {
 public:
@@ -24,12 +30,47 @@ public:
      * \return True on success otherwise false.
      */
     bool applyConfig(RTT::TaskContext *context, const libConfig::Configuration &config);
+
+    /**
+     * Applies a merged view of compact config sections to the task.
+     * Each field of the view is written to the property of the same name.
+     */
+    bool applyConfig(RTT::TaskContext *context, const CompactConfigValue &config);
     bool applyConfig(const std::string &configFilePath, RTT::TaskContext *context, const std::vector<std::string> &names);
+
+    /**
+     * Returns the compact form of the given sections of the file, sections
+     * the file does not define are left out. Each section is parsed once,
+     * and each combination of sections converted once, the result is
+     * shared until the file changes. Throws if the file can not be parsed.
+     */
+    std::shared_ptr<const CompactConfig> getCompactConfig(const std::string &configFilePath, const std::vector<std::string> &names);
     bool applyConfig(RTT::TaskContext *context, const std::vector<std::string> &names);
     bool applyConfig(RTT::TaskContext *context, const std::string &conf1);
     bool applyConfig(RTT::TaskContext *context, const std::string &conf1, const std::string &conf2);
     bool applyConfig(RTT::TaskContext *context, const std::string &conf1, const std::string &conf2, const std::string &conf3);
     bool applyConfig(RTT::TaskContext *context, const std::string &conf1, const std::string &conf2, const std::string &conf3, const std::string &conf4);
+
+    /**
+     * Asynchronous variants of applyConfig, executed by Executor::getDefault().
+     * The helper and the context must stay valid until the future is ready.
+     * Exceptions of applyConfig are rethrown by std::future::get.
+     */
+    std::future<bool> applyConfigAsync(const std::string &configFilePath, RTT::TaskContext *context, const std::vector<std::string> &names);
+    std::future<bool> applyConfigAsync(RTT::TaskContext *context, const std::vector<std::string> &names);
+
+    /**
+     * Pre-flight check of a configuration, without any running task.
+     * Resolves the property types of the model from its orogen description
+     * and the typekits, and checks every value of the merged sections
+     * (property and field names, enum values, array sizes, numeric ranges).
+     * \param modelName The task model, e.g. "hokuyo::Task"
+     * \param names The config sections that would be applied
+     * \param errors All detected errors are appended to this vector
+     * \return True if the configuration is valid
+     */
+    bool validateConfig(const std::string &modelName, const std::vector<std::string> &names, std::vector<std::string> &errors);
+    bool validateConfig(const std::string &configFilePath, const std::string &modelName, const std::vector<std::string> &names, std::vector<std::string> &errors);
     /**
      * @brief Function applying configuration value on a DataSourceBase object.
      * @param dsb The shared pointer object pointing to the DataSourceBase object. This will be modified!
@@ -39,11 +80,42 @@ public:
      */
     bool applyConfigValueOnDSB(RTT::base::DataSourceBase::shared_ptr dsb,
             const RTT::types::TypeInfo* typeInfo, const libConfig::ConfigValue& value);
+    bool applyConfigValueOnDSB(RTT::base::DataSourceBase::shared_ptr dsb,
+            const RTT::types::TypeInfo* typeInfo, const CompactConfigValue& value);
+
+    /**
+     * @brief Function applying a configuration value on a Typelib value.
+     * @param value The Typelib value that will be modified. Containers in the value must be initialized.
+     * @param conf Is the ConfigValue object which will be applied.
+     * @return True on success, false if an error was detected.
+     */
+    static bool applyConfigValueOnTypelibValue(Typelib::Value &value, const libConfig::ConfigValue &conf);
+    static bool applyConfigValueOnTypelibValue(Typelib::Value &value, const CompactConfigValue &conf);
 
 private:
-    std::map<std::string, libConfig::Configuration> subConfigs;
-    bool mergeConfig(const std::vector<std::string> &names, libConfig::Configuration &result);
+    ///parsed sections of one configuration file
+    struct ConfigFile
+    {
+        ConfigFile() : size(0), modificationTime(0) {}
+
+        ///stamp of the file when it was parsed, the sections are dropped if it changes
+        uint64_t size;
+        int64_t modificationTime;
+        ///parsed sections, shared by the copies of the entry
+        std::map<std::string, std::shared_ptr<const libConfig::Configuration> > sections;
+        ///requested sections the file does not define, they are not parsed again
+        std::set<std::string> missing;
+        ///compact forms by the requested sections, views on them may outlive the entry
+        std::map<std::vector<std::string>, std::shared_ptr<const CompactConfig> > compacts;
+    };
+
+    typedef ConcurrentMap<std::string, std::shared_ptr<const ConfigFile> > ConfigMap;
+    ///parsed sections by file name, shared by all threads using this helper
+    ConfigMap subConfigs;
+    static bool mergeConfig(const std::map<std::string, libConfig::Configuration> &configs, const std::vector<std::string> &names, libConfig::Configuration &result);
+    static RTT::base::PropertyBase *findProperty(RTT::TaskContext* context, const std::string &propertyName);
     bool applyConfToProperty(RTT::TaskContext* context, const std::string &propertyName, const libConfig::ConfigValue &value);
+    bool applyConfToProperty(RTT::TaskContext* context, const std::string &propertyName, const CompactConfigValue &value);
 };
 
 }//end of namespace
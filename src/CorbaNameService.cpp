@@ -3,24 +3,104 @@
 #include <rtt/transports/corba/TaskContextC.h>
 #include <stdexcept>
 #include <iostream>
+#include "Tracing.hpp"
+#include "OrbProfile.hpp"
 
 using namespace orocos_cpp;
 
-CorbaNameService::CorbaNameService(std::string name_service_ip, std::string name_service_port) : ip(name_service_ip), port(name_service_port)
+CorbaNameService::CorbaNameService(std::string name_service_ip, std::string name_service_port) : ip(name_service_ip), port(name_service_port),
+    positiveTTL(base::Time::fromSeconds(5)), negativeTTL(base::Time::fromMilliseconds(50)), cacheStatistics(),
+    watchInterval(base::Time::fromMilliseconds(200)), stopWatching(false), pollNow(false)
 {
 }
 
+CorbaNameService::~CorbaNameService()
+{
+    {
+        std::lock_guard<std::mutex> lock(watchMutex);
+        stopWatching = true;
+    }
+    watchCondition.notify_all();
+    if(watchThread.joinable())
+        watchThread.join();
+}
+
+void CorbaNameService::setCacheTTL(const base::Time& positive, const base::Time& negative)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    positiveTTL = positive;
+    negativeTTL = negative;
+    cache.clear();
+}
+
+bool CorbaNameService::findCached(const std::string& taskName, CacheEntry& entry)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cache.find(taskName);
+    if(it == cache.end())
+    {
+        cacheStatistics.misses++;
+        return false;
+    }
+
+    if(it->second.expires < base::Time::now())
+    {
+        cache.erase(it);
+        cacheStatistics.misses++;
+        return false;
+    }
+
+    entry = it->second;
+    if(entry.registered)
+        cacheStatistics.hits++;
+    else
+        cacheStatistics.negativeHits++;
+    return true;
+}
+
+void CorbaNameService::store(const std::string& taskName, const CacheEntry& entry)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    const base::Time &ttl(entry.registered ? positiveTTL : negativeTTL);
+    if(ttl.isNull())
+        return;
+
+    CacheEntry &cached(cache[taskName]);
+    cached = entry;
+    cached.expires = base::Time::now() + ttl;
+}
+
+void CorbaNameService::invalidate(const std::string& taskName)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cacheStatistics.invalidations += cache.erase(taskName);
+}
+
+void CorbaNameService::invalidateAll()
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cacheStatistics.invalidations += cache.size();
+    cache.clear();
+}
+
+CorbaNameService::CacheStatistics CorbaNameService::getCacheStatistics() const
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return cacheStatistics;
+}
+
 bool CorbaNameService::initOrb()
 {
     if ( !CORBA::is_nil(orb) )
         return false;
 
     try {
-        int argc = 0;
-        char **argv = nullptr;
-        
+        std::vector<std::string> args;
+        std::vector<char *> argv;
+        int argc = OrbProfile::getDefault().getArgv(args, argv);
+
         // First initialize the ORB, that will remove some arguments...
-        orb = CORBA::ORB_init (argc, const_cast<char**>(argv),
+        orb = CORBA::ORB_init (argc, argv.data(),
                                 "omniORB4");
     }
     catch (CORBA::Exception &e) {
@@ -39,6 +119,10 @@ bool CorbaNameService::isConnected()
 
 bool CorbaNameService::connect()
 {
+    OROCOS_CPP_TRACE_SCOPE("CorbaNameService::connect");
+    //the cached references may stem from another naming server
+    invalidateAll();
+
     if(CORBA::is_nil(orb))
     {
         if(!initOrb())
@@ -82,6 +166,7 @@ bool CorbaNameService::connect()
 
 std::vector< std::string > CorbaNameService::getRegisteredTasks()
 {
+    OROCOS_CPP_TRACE_SCOPE("CorbaNameService::getRegisteredTasks");
     if(CORBA::is_nil(orb))
     {
         throw std::runtime_error("CorbaNameService::Error, called getRegisteredTasks() without connection " );
@@ -138,64 +223,380 @@ std::vector< std::string > CorbaNameService::getRegisteredTasks()
 
 bool CorbaNameService::isRegistered(const std::string& taskName)
 {
+    OROCOS_CPP_TRACE_SCOPE("CorbaNameService::isRegistered", taskName);
     if(CORBA::is_nil(orb))
     {
        throw std::runtime_error("CorbaNameService::Error, called getTaskContext() without connection " );
     }
 
+    CacheEntry entry;
+    return lookup(taskName, entry);
+}
+
+bool CorbaNameService::isAlive(CORBA::Object_ptr object)
+{
+    try {
+        RTT::corba::CTaskContext_var task = RTT::corba::CTaskContext::_narrow(object);
+        if(CORBA::is_nil(task))
+            return false;
+        CORBA::String_var nm = task->getName();
+        return true;
+    } catch (...)
+    {
+        return false;
+    }
+}
+
+bool CorbaNameService::lookup(const std::string& taskName, CacheEntry& entry)
+{
+    if(findCached(taskName, entry))
+    {
+        //the naming server is skipped, but a crashed task must not be
+        //reported as registered, so found tasks are asked for their name
+        if(!entry.registered || isAlive(entry.object.in()))
+            return entry.registered;
+        invalidate(taskName);
+    }
+
+    return resolveRegistration(taskName, entry);
+}
+
+bool CorbaNameService::resolveRegistration(const std::string& taskName, CacheEntry &entry)
+{
+    OROCOS_CPP_TRACE_SCOPE("CorbaNameService::resolveRegistration", taskName);
     CosNaming::Name serverName;
     serverName.length(2);
     serverName[0].id = CORBA::string_dup("TaskContexts");
     serverName[1].id = CORBA::string_dup( taskName.c_str() );
 
+    entry.registered = false;
     try {
         // Get object reference
         CORBA::Object_var task_object = rootContext->resolve(serverName);
-        if(CORBA::is_nil(task_object))
-            return false;
+        if(!CORBA::is_nil(task_object))
+        {
+            RTT::corba::CTaskContext_var mtask = RTT::corba::CTaskContext::_narrow (task_object.in ());
+            if ( !CORBA::is_nil( mtask ) ) {
+                // force connect to object.
+                //this needs to be done. If not, we may return a ghost task
+                CORBA::String_var nm = mtask->getName(); 
 
-        RTT::corba::CTaskContext_var mtask = RTT::corba::CTaskContext::_narrow (task_object.in ());
-        if ( CORBA::is_nil( mtask ) ) {
-            return false;
+                CORBA::String_var ior = orb->object_to_string(task_object);
+                entry.ior = ior.in();
+                entry.object = task_object;
+                entry.registered = true;
+            }
         }
-        
-        // force connect to object.
-        //this needs to be done. If not, we may return a ghost task
-        CORBA::String_var nm = mtask->getName(); 
     } catch (...)
     {
-        return false;
     }
-    
-    return true;
+
+    store(taskName, entry);
+    return entry.registered;
+}
+
+std::string CorbaNameService::getIOR(const std::string& taskName)
+{
+    if(CORBA::is_nil(orb))
+    {
+        throw std::runtime_error("CorbaNameService::Error, called getIOR() without connection " );
+    }
+
+    CacheEntry entry;
+    return lookup(taskName, entry) ? entry.ior : std::string();
 }
 
 RTT::TaskContext* CorbaNameService::getTaskContext(const std::string& taskName)
 {
+    OROCOS_CPP_TRACE_SCOPE("CorbaNameService::getTaskContext", taskName);
     if(CORBA::is_nil(orb))
     {
         throw std::runtime_error("CorbaNameService::Error, called getTaskContext() without connection " );
     }
 
-    CosNaming::Name serverName;
-    serverName.length(2);
-    serverName[0].id = CORBA::string_dup("TaskContexts");
-    serverName[1].id = CORBA::string_dup( taskName.c_str() );
+    //missing tasks are looked up again, the caller expects to get one
+    CacheEntry entry;
+    bool cached = findCached(taskName, entry) && entry.registered;
+    while(true)
+    {
+        if(!cached)
+        {
+            CosNaming::Name serverName;
+            serverName.length(2);
+            serverName[0].id = CORBA::string_dup("TaskContexts");
+            serverName[1].id = CORBA::string_dup( taskName.c_str() );
+
+            // Get object reference
+            CORBA::Object_var task_object = rootContext->resolve(serverName);
+            CORBA::String_var s = orb->object_to_string(task_object);
+            entry.ior = s.in();
+            entry.object = task_object;
+            entry.registered = true;
+        }
+
+        RTT::TaskContext *ret = nullptr;
+
+        try
+        {
+            OROCOS_CPP_TRACE_SCOPE("TaskContextProxy::Create", taskName);
+            ret = RTT::corba::TaskContextProxy::Create(entry.ior, true);
+        }
+        catch (...)
+        {
+        }
+
+        if(ret)
+        {
+            if(!cached)
+                store(taskName, entry);
+            return ret;
+        }
+
+        invalidate(taskName);
+        if(!cached)
+        {
+            std::cout << "Ghost " << taskName << std::endl;
+            return nullptr;
+        }
 
-    // Get object reference
-    CORBA::Object_var task_object = rootContext->resolve(serverName);
-    CORBA::String_var s = orb->object_to_string(task_object);
+        //the cached IOR may belong to a task that was restarted
+        //meanwhile, ask the naming server once more
+        cached = false;
+    }
+}
 
-    RTT::TaskContext *ret = nullptr;
-        
-    try
+std::vector< bool > CorbaNameService::areRegistered(const std::vector< std::string >& names, size_t maxConcurrency)
+{
+    OROCOS_CPP_TRACE_SCOPE("CorbaNameService::areRegistered");
+    if(CORBA::is_nil(orb))
     {
-        ret = RTT::corba::TaskContextProxy::Create(s.in(), true);;
+        throw std::runtime_error("CorbaNameService::Error, called areRegistered() without connection " );
     }
-    catch (...)
+
+    //missing tasks are answered from the cache, found tasks need
+    //the liveness check or a lookup, which run concurrently
+    std::vector<char> registered(names.size(), false);
+    std::vector<size_t> lookups;
+    for(size_t i = 0; i < names.size(); i++)
     {
-        std::cout << "Ghost " << taskName << std::endl;
+        CacheEntry entry;
+        if(findCached(names[i], entry) && !entry.registered)
+            continue;
+        lookups.push_back(i);
+    }
+
+    runConcurrently(lookups.size(), maxConcurrency, [this, &names, &lookups, &registered](size_t i) {
+        CacheEntry entry;
+        registered[lookups[i]] = lookup(names[lookups[i]], entry);
+    });
+
+    return std::vector<bool>(registered.begin(), registered.end());
+}
+
+std::vector< NameService::TaskLookup > CorbaNameService::getTaskContexts(const std::vector< std::string >& names, size_t maxConcurrency)
+{
+    OROCOS_CPP_TRACE_SCOPE("CorbaNameService::getTaskContexts");
+    std::vector<TaskLookup> results(names.size());
+    const bool connected = !CORBA::is_nil(orb);
+    runConcurrently(names.size(), maxConcurrency, [this, connected, &names, &results](size_t i) {
+        TaskLookup &result(results[i]);
+        result.taskName = names[i];
+        result.task = nullptr;
+        if(!connected)
+        {
+            result.error = "not connected to the naming service";
+            return;
+        }
+
+        try {
+            //resolve and proxy creation of one task run in the same thread,
+            //cached IORs skip the resolve
+            result.task = getTaskContext(names[i]);
+            if(!result.task)
+                result.error = "task " + names[i] + " is registered, but not reachable";
+        } catch (const CosNaming::NamingContext::NotFound &)
+        {
+            result.error = "task " + names[i] + " is not registered";
+        } catch (const CORBA::Exception &e)
+        {
+            result.error = std::string("CORBA exception ") + e._name() + " while resolving " + names[i];
+        } catch (const std::exception &e)
+        {
+            result.error = e.what();
+        } catch (...)
+        {
+            result.error = "unknown error while resolving " + names[i];
+        }
+    });
+    return results;
+}
+
+void CorbaNameService::setWatchInterval(const base::Time& interval)
+{
+    std::lock_guard<std::mutex> lock(watchMutex);
+    watchInterval = interval;
+}
+
+int CorbaNameService::watch(const WatchCallback& callback)
+{
+    if(CORBA::is_nil(orb))
+    {
+        throw std::runtime_error("CorbaNameService::Error, called watch() without connection " );
+    }
+
+    int id = watchDispatcher.add(callback);
+
+    {
+        std::lock_guard<std::mutex> lock(watchMutex);
+        pollNow = true;
+        if(!watchThread.joinable())
+            watchThread = std::thread(&CorbaNameService::watchLoop, this);
+    }
+    watchCondition.notify_all();
+
+    return id;
+}
+
+void CorbaNameService::unwatch(int watchId)
+{
+    //the poller idles without watchers, it may be the caller
+    watchDispatcher.remove(watchId);
+}
+
+bool CorbaNameService::listRegistrations(WatchDispatcher::Snapshot& snapshot)
+{
+    OROCOS_CPP_TRACE_SCOPE("CorbaNameService::listRegistrations");
+    snapshot.clear();
+
+    CosNaming::Name contextName;
+    contextName.length(1);
+    contextName[0].id = CORBA::string_dup("TaskContexts");
+
+    try {
+        CosNaming::NamingContext_var tasks;
+        try {
+            CORBA::Object_var tasksObj = rootContext->resolve(contextName);
+            tasks = CosNaming::NamingContext::_narrow(tasksObj);
+        } catch (const CosNaming::NamingContext::NotFound &)
+        {
+            //nothing was ever registered
+            return true;
+        }
+        if(CORBA::is_nil(tasks))
+            return true;
+
+        CosNaming::BindingList_var bindings;
+        CosNaming::BindingIterator_var bindingIt;
+        tasks->list(1000, bindings, bindingIt);
+
+        std::vector<std::string> names;
+        for(CORBA::ULong i = 0; i < bindings->length(); i++)
+            names.push_back(bindings[i].binding_name[0].id.in());
+        if(!CORBA::is_nil(bindingIt))
+        {
+            while(bindingIt->next_n(1000, bindings))
+            {
+                for(CORBA::ULong i = 0; i < bindings->length(); i++)
+                    names.push_back(bindings[i].binding_name[0].id.in());
+            }
+            bindingIt->destroy();
+        }
+
+        for(const std::string &name: names)
+        {
+            CosNaming::Name serverName;
+            serverName.length(1);
+            serverName[0].id = CORBA::string_dup(name.c_str());
+            try {
+                CORBA::Object_var taskObj = tasks->resolve(serverName);
+                CORBA::String_var ior = orb->object_to_string(taskObj);
+                snapshot[name] = ior.in();
+            } catch (const CosNaming::NamingContext::NotFound &)
+            {
+                //unregistered meanwhile
+            }
+        }
+    } catch (const CORBA::Exception &e)
+    {
+        std::cout << "CorbaNameService::listRegistrations : Error, could not list the tasks : " << e._name() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void CorbaNameService::dropDeadRegistrations(const WatchDispatcher::Snapshot& previous, WatchDispatcher::Snapshot& snapshot, WatchDispatcher::Snapshot& dead)
+{
+    //bindings that are gone need no check any more
+    for(WatchDispatcher::Snapshot::iterator it = dead.begin(); it != dead.end();)
+    {
+        if(snapshot.find(it->first) == snapshot.end())
+            it = dead.erase(it);
+        else
+            it++;
+    }
+
+    for(WatchDispatcher::Snapshot::iterator it = snapshot.begin(); it != snapshot.end();)
+    {
+        //unchanged bindings were checked when they appeared
+        WatchDispatcher::Snapshot::const_iterator known = previous.find(it->first);
+        if(known != previous.end() && known->second == it->second)
+        {
+            it++;
+            continue;
+        }
+
+        //a stale binding is only asked once, a restarted task registers a new IOR
+        WatchDispatcher::Snapshot::const_iterator stale = dead.find(it->first);
+        bool alive = false;
+        if(stale == dead.end() || stale->second != it->second)
+        {
+            try {
+                CORBA::Object_var object = orb->string_to_object(it->second.c_str());
+                alive = isAlive(object.in());
+            } catch (...)
+            {
+            }
+        }
+
+        if(alive)
+        {
+            dead.erase(it->first);
+            it++;
+        }
+        else
+        {
+            dead[it->first] = it->second;
+            it = snapshot.erase(it);
+        }
+    }
+}
+
+void CorbaNameService::watchLoop()
+{
+    WatchDispatcher::Snapshot previous;
+    WatchDispatcher::Snapshot dead;
+    std::unique_lock<std::mutex> lock(watchMutex);
+    while(!stopWatching)
+    {
+        pollNow = false;
+        lock.unlock();
+
+        WatchDispatcher::Snapshot snapshot;
+        if(!watchDispatcher.empty() && listRegistrations(snapshot))
+        {
+            dropDeadRegistrations(previous, snapshot, dead);
+
+            //anything that changed, is looked up again
+            for(const ChangeEvent &event: WatchDispatcher::diff(previous, snapshot))
+                invalidate(event.taskName);
+            previous = snapshot;
+
+            watchDispatcher.publish(snapshot);
+        }
+
+        lock.lock();
+        watchCondition.wait_for(lock, std::chrono::microseconds(watchInterval.toMicroseconds()), [this]() {
+            return stopWatching || pollNow;
+        });
     }
-    
-    return ret;
 }
@@ -2,26 +2,152 @@
 #define CORBANAMESERVICE_H
 
 #include "NameService.hpp"
+#include "WatchDispatcher.hpp"
+#include <base/Time.hpp>
 #include <omniORB4/CORBA.h>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <stdint.h>
 
 namespace orocos_cpp
 {
 
+/**
+ * Name service backed by the CORBA naming service.
+ *
+ * Lookups are cached: a task that was found is remembered together
+ * with its object reference and IOR for the positive TTL, a task that
+ * was not found for the negative TTL. Within the TTL, the naming server
+ * is not asked. isRegistered still asks a found task for its name, so
+ * a crashed task is not reported as registered, and getTaskContext
+ * creates the proxy directly from the cached IOR. If that fails, the
+ * entry is dropped and the task is resolved once more, as it may have
+ * been restarted. Entries are also dropped on invalidate() or connect().
+ *
+ * Watching is implemented by a poller thread, that lists the
+ * registrations once per watch interval and diffs them against the
+ * previous list. Each round costs one list and one resolve per task at
+ * the naming server. Only tasks whose binding is new or changed are
+ * contacted, bindings left behind by crashed tasks are not reported.
+ * A task that crashes later is reported as removed only once its
+ * binding is removed or replaced. Changes found by the poller also
+ * drop the affected cache entries.
+ * */
 class CorbaNameService : public NameService
 {
 public:
+    struct CacheStatistics
+    {
+        ///lookups answered from a positive entry
+        uint64_t hits;
+        ///lookups answered from a negative entry
+        uint64_t negativeHits;
+        ///lookups that went to the naming server
+        uint64_t misses;
+        ///entries dropped because of errors or invalidate()
+        uint64_t invalidations;
+    };
+
     CorbaNameService(std::string name_service_ip="",std::string name_service_port = "");
-    virtual ~CorbaNameService() {};
+    virtual ~CorbaNameService();
     virtual bool connect();
     virtual bool isConnected();
     virtual std::vector< std::string > getRegisteredTasks();
     virtual bool isRegistered(const std::string& taskName);
     virtual RTT::TaskContext* getTaskContext(const std::string& taskName);
+    virtual void invalidate(const std::string &taskName);
+    virtual std::vector<bool> areRegistered(const std::vector<std::string> &names, size_t maxConcurrency = DEFAULT_BATCH_CONCURRENCY);
+    virtual std::vector<TaskLookup> getTaskContexts(const std::vector<std::string> &names, size_t maxConcurrency = DEFAULT_BATCH_CONCURRENCY);
+    virtual int watch(const WatchCallback &callback);
+    virtual void unwatch(int watchId);
+
+    /**
+     * Returns the IOR of the given task, or an empty string
+     * if it is not registered
+     * */
+    std::string getIOR(const std::string &taskName);
+
+    /**
+     * Sets how often the registrations are listed while somebody
+     * watches. Default is 200 milliseconds.
+     * */
+    void setWatchInterval(const base::Time &interval);
+
+    /**
+     * Sets how long lookups are cached, a zero time disables the cache.
+     * Default is 5 seconds for found and 50 milliseconds for missing
+     * tasks, so that polling for a starting task is not delayed much.
+     * */
+    void setCacheTTL(const base::Time &positive, const base::Time &negative);
+
+    void invalidateAll();
+
+    CacheStatistics getCacheStatistics() const;
     
 private:
+    struct CacheEntry
+    {
+        bool registered;
+        std::string ior;
+        CORBA::Object_var object;
+        base::Time expires;
+    };
+
     bool initOrb();
+
+    /**
+     * Returns the cached entry, if it did not expire
+     * */
+    bool findCached(const std::string &taskName, CacheEntry &entry);
+    void store(const std::string &taskName, const CacheEntry &entry);
+
+    /**
+     * Asks the naming server and the task, and caches the result.
+     * The result is returned in entry as well.
+     * */
+    bool resolveRegistration(const std::string &taskName, CacheEntry &entry);
+
+    /**
+     * Answers from the cache if the task is missing there or still
+     * alive, resolves it otherwise
+     * */
+    bool lookup(const std::string &taskName, CacheEntry &entry);
+    static bool isAlive(CORBA::Object_ptr object);
+
+    /**
+     * Lists all registered tasks with their IORs
+     * @return false if the naming server could not be asked
+     * */
+    bool listRegistrations(WatchDispatcher::Snapshot &snapshot);
+
+    /**
+     * Removes the new and changed bindings from snapshot, whose task
+     * does not answer. These are remembered in dead with their IOR,
+     * so that they are not asked again while the binding stays the same.
+     * */
+    void dropDeadRegistrations(const WatchDispatcher::Snapshot &previous, WatchDispatcher::Snapshot &snapshot, WatchDispatcher::Snapshot &dead);
+    void watchLoop();
+
     std::string ip;
     std::string port;
+
+    mutable std::mutex cacheMutex;
+    std::map<std::string, CacheEntry> cache;
+    base::Time positiveTTL;
+    base::Time negativeTTL;
+    CacheStatistics cacheStatistics;
+
+    WatchDispatcher watchDispatcher;
+    std::mutex watchMutex;
+    std::condition_variable watchCondition;
+    std::thread watchThread;
+    base::Time watchInterval;
+    bool stopWatching;
+    ///a watcher was added, poll without waiting for the interval
+    bool pollNow;
+
     CORBA::Object_var rootObj;
     CosNaming::NamingContext_var rootContext;
     CORBA::ORB_var orb;
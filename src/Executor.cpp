@@ -0,0 +1,154 @@
+#include "Executor.hpp"
+#include "Tracing.hpp"
+#include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <stdlib.h>
+
+using namespace orocos_cpp;
+
+namespace
+{
+
+size_t getDefaultThreadCount()
+{
+    const char *threads = getenv("OROCOS_CPP_EXECUTOR_THREADS");
+    if(threads)
+    {
+        try {
+            size_t count = boost::lexical_cast<size_t>(threads);
+            if(count)
+                return count;
+        } catch (const boost::bad_lexical_cast &)
+        {
+        }
+        std::cout << "Executor::getDefault : Warning, ignoring invalid OROCOS_CPP_EXECUTOR_THREADS " << threads << std::endl;
+    }
+
+    //the jobs mostly wait for remote calls
+    return std::max(8u, 2 * std::thread::hardware_concurrency());
+}
+
+}
+
+Executor::Executor(size_t numThreads) : stopping(false), maxQueueDepth(0), running(0), started(0), completed(0),
+                                        queueLatencySum(0), maxQueueLatency(0), executionTimeSum(0), maxExecutionTime(0)
+{
+    numThreads = std::max<size_t>(numThreads, 1);
+    for(size_t i = 0; i < numThreads; i++)
+        threads.push_back(std::thread(&Executor::run, this));
+}
+
+Executor::~Executor()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        //destroying the jobs breaks the promises of submit()
+        queue.clear();
+    }
+    jobAvailable.notify_all();
+
+    for(std::thread &thread: threads)
+        thread.join();
+}
+
+Executor& Executor::getDefault()
+{
+    static Executor executor(getDefaultThreadCount());
+    return executor;
+}
+
+void Executor::post(const std::function< void () >& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(stopping)
+            throw std::runtime_error("Executor::post : Error, the executor is shutting down");
+
+        Job entry;
+        entry.func = job;
+        entry.queued = base::Time::now();
+        queue.push_back(entry);
+        maxQueueDepth = std::max(maxQueueDepth, queue.size());
+    }
+    jobAvailable.notify_one();
+}
+
+void Executor::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while(true)
+    {
+        jobAvailable.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if(stopping)
+            return;
+
+        Job job(queue.front());
+        queue.pop_front();
+
+        const base::Time start = base::Time::now();
+        const int64_t latency = (start - job.queued).toMicroseconds();
+        started++;
+        queueLatencySum += latency;
+        maxQueueLatency = std::max(maxQueueLatency, latency);
+        running++;
+        lock.unlock();
+
+        try {
+            OROCOS_CPP_TRACE_SCOPE("Executor::run");
+            job.func();
+        } catch (const std::exception &e)
+        {
+            std::cout << "Executor::run : Error, job threw " << e.what() << std::endl;
+        } catch (...)
+        {
+            std::cout << "Executor::run : Error, job threw an unknown exception" << std::endl;
+        }
+
+        const int64_t duration = (base::Time::now() - start).toMicroseconds();
+
+        //release the captures of the job outside of the lock
+        job.func = std::function<void ()>();
+
+        lock.lock();
+        running--;
+        completed++;
+        executionTimeSum += duration;
+        maxExecutionTime = std::max(maxExecutionTime, duration);
+    }
+}
+
+size_t Executor::getThreadCount() const
+{
+    return threads.size();
+}
+
+Executor::Statistics Executor::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Statistics stats;
+    stats.queueDepth = queue.size();
+    stats.maxQueueDepth = maxQueueDepth;
+    stats.running = running;
+    stats.completed = completed;
+    //latencies are summed when a job starts, execution times when it ends
+    stats.meanQueueLatency = base::Time::fromMicroseconds(started ? queueLatencySum / static_cast<int64_t>(started) : 0);
+    stats.maxQueueLatency = base::Time::fromMicroseconds(maxQueueLatency);
+    stats.meanExecutionTime = base::Time::fromMicroseconds(completed ? executionTimeSum / static_cast<int64_t>(completed) : 0);
+    stats.maxExecutionTime = base::Time::fromMicroseconds(maxExecutionTime);
+    return stats;
+}
+
+void Executor::resetStatistics()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    maxQueueDepth = queue.size();
+    completed = 0;
+    queueLatencySum = 0;
+    maxQueueLatency = 0;
+    executionTimeSum = 0;
+    maxExecutionTime = 0;
+    started = 0;
+}
@@ -0,0 +1,116 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <base/Time.hpp>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <stdint.h>
+
+namespace orocos_cpp
+{
+
+/**
+ * Thread pool executing the asynchronous variants of the helpers,
+ * e.g. ConfigurationHelper::applyConfigAsync.
+ *
+ * Most jobs block on CORBA round trips, not on the CPU, therefore
+ * the default executor has more threads than there are cores. Its
+ * size can be set using the environment variable
+ * OROCOS_CPP_EXECUTOR_THREADS.
+ *
+ * On destruction the running jobs are finished, queued jobs are
+ * dropped. Their futures report std::future_errc::broken_promise.
+ * */
+class Executor
+{
+public:
+    struct Statistics
+    {
+        ///jobs waiting for a thread
+        size_t queueDepth;
+        size_t maxQueueDepth;
+        ///jobs being executed
+        size_t running;
+        uint64_t completed;
+        ///time from submission until a thread picked the job up
+        base::Time meanQueueLatency;
+        base::Time maxQueueLatency;
+        ///time the job itself took
+        base::Time meanExecutionTime;
+        base::Time maxExecutionTime;
+    };
+
+    /**
+     * @param numThreads number of worker threads, at least one
+     * */
+    explicit Executor(size_t numThreads);
+    ~Executor();
+
+    /**
+     * The executor shared by all helpers
+     * */
+    static Executor &getDefault();
+
+    /**
+     * Queues the job, for callers that report completion themselves,
+     * e.g. through a callback. Exceptions thrown by the job are
+     * caught and printed.
+     * */
+    void post(const std::function<void ()> &job);
+
+    /**
+     * Queues the job. The future returns the result of the job or
+     * rethrows its exception.
+     * */
+    template <typename Func>
+    std::future<typename std::result_of<Func()>::type> submit(Func func)
+    {
+        typedef typename std::result_of<Func()>::type Result;
+        std::shared_ptr<std::packaged_task<Result ()> > task(std::make_shared<std::packaged_task<Result ()> >(func));
+        std::future<Result> future(task->get_future());
+        post([task]() { (*task)(); });
+        return future;
+    }
+
+    size_t getThreadCount() const;
+
+    Statistics getStatistics() const;
+    void resetStatistics();
+
+private:
+    Executor(const Executor &);
+    Executor &operator=(const Executor &);
+
+    struct Job
+    {
+        std::function<void ()> func;
+        base::Time queued;
+    };
+
+    void run();
+
+    mutable std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::deque<Job> queue;
+    bool stopping;
+    std::vector<std::thread> threads;
+
+    size_t maxQueueDepth;
+    size_t running;
+    uint64_t started;
+    uint64_t completed;
+    int64_t queueLatencySum;
+    int64_t maxQueueLatency;
+    int64_t executionTimeSum;
+    int64_t maxExecutionTime;
+};
+
+}//end of namespace
+#endif // EXECUTOR_H
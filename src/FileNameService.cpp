@@ -0,0 +1,450 @@
+#include "FileNameService.hpp"
+#include "Tracing.hpp"
+#include "OrbProfile.hpp"
+#include <rtt/transports/corba/TaskContextProxy.hpp>
+#include <rtt/transports/corba/TaskContextServer.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+using namespace orocos_cpp;
+
+namespace
+{
+
+const std::string IOR_ENDING(".ior");
+
+bool isIORFile(const std::string &fileName)
+{
+    //temporary files of publish() start with a dot
+    return fileName.size() > IOR_ENDING.size() && fileName[0] != '.'
+        && fileName.compare(fileName.size() - IOR_ENDING.size(), IOR_ENDING.size(), IOR_ENDING) == 0;
+}
+
+std::string taskNameFromFile(const std::string &fileName)
+{
+    return fileName.substr(0, fileName.size() - IOR_ENDING.size());
+}
+
+}
+
+FileNameService::FileNameService(const std::string& directoryName) : directory(directoryName), inotifyFd(-1), stopWatching(false)
+{
+    if(directory.empty())
+    {
+        const char *envDir = getenv("OROCOS_CPP_NAMESERVICE_DIR");
+        if(envDir && *envDir)
+            directory = envDir;
+        else
+            directory = "/tmp/orocos_cpp-" + boost::lexical_cast<std::string>(getuid());
+    }
+}
+
+FileNameService::~FileNameService()
+{
+    stopWatching = true;
+    if(watchThread.joinable())
+        watchThread.join();
+
+    for(const std::string &task: publishedTasks)
+        unlink(getFileName(task).c_str());
+
+    if(inotifyFd >= 0)
+        close(inotifyFd);
+}
+
+const std::string& FileNameService::getDirectory() const
+{
+    return directory;
+}
+
+std::string FileNameService::getFileName(const std::string& taskName) const
+{
+    return directory + "/" + taskName + IOR_ENDING;
+}
+
+bool FileNameService::connect()
+{
+    OROCOS_CPP_TRACE_SCOPE("FileNameService::connect", directory);
+
+    if(inotifyFd >= 0)
+        return true;
+
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(directory, ec);
+    if(!boost::filesystem::is_directory(directory))
+    {
+        std::cout << "FileNameService::Error, could not create directory " << directory << std::endl;
+        return false;
+    }
+
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(inotifyFd < 0)
+    {
+        std::cout << "FileNameService::Error, inotify_init failed : " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    if(inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) < 0)
+    {
+        std::cout << "FileNameService::Error, could not watch " << directory << " : " << strerror(errno) << std::endl;
+        close(inotifyFd);
+        inotifyFd = -1;
+        return false;
+    }
+
+    //the proxies need an orb, initialize it if nobody else did
+    OrbProfile::getDefault().initRTTOrb();
+
+    //the watch is set up, now nothing gets lost between scan and events
+    scanDirectory();
+
+    return true;
+}
+
+bool FileNameService::isConnected()
+{
+    return inotifyFd >= 0;
+}
+
+void FileNameService::scanDirectory()
+{
+    scanDirectory(entries);
+}
+
+void FileNameService::scanDirectory(std::map< std::string, FileNameService::Entry >& result) const
+{
+    result.clear();
+    for(boost::filesystem::directory_iterator it(directory); it != boost::filesystem::directory_iterator(); it++)
+    {
+        std::string fileName = it->path().filename().string();
+        if(!isIORFile(fileName))
+            continue;
+
+        Entry entry;
+        std::string taskName = taskNameFromFile(fileName);
+        if(readEntry(taskName, entry))
+            result[taskName] = entry;
+    }
+}
+
+bool FileNameService::readEntry(const std::string& taskName, FileNameService::Entry& entry) const
+{
+    std::ifstream in(getFileName(taskName).c_str());
+    if(!in.good())
+        return false;
+
+    in >> entry.pid >> entry.ior;
+    return !in.fail() && !entry.ior.empty();
+}
+
+bool FileNameService::isAlive(const FileNameService::Entry& entry) const
+{
+    return kill(entry.pid, 0) == 0 || errno == EPERM;
+}
+
+void FileNameService::processEvents(int timeoutMs)
+{
+    if(inotifyFd < 0)
+        throw std::runtime_error("FileNameService::Error, called without connection");
+
+    pollfd pfd;
+    pfd.fd = inotifyFd;
+    pfd.events = POLLIN;
+    if(poll(&pfd, 1, timeoutMs) <= 0)
+        return;
+
+    char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    while(true)
+    {
+        ssize_t len = read(inotifyFd, buffer, sizeof(buffer));
+        if(len <= 0)
+            break;
+
+        for(char *ptr = buffer; ptr < buffer + len; )
+        {
+            const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(ptr);
+            ptr += sizeof(struct inotify_event) + event->len;
+
+            if(event->mask & IN_Q_OVERFLOW)
+            {
+                scanDirectory();
+                continue;
+            }
+
+            if(!event->len || !isIORFile(event->name))
+                continue;
+
+            std::string taskName = taskNameFromFile(event->name);
+            if(event->mask & (IN_DELETE | IN_MOVED_FROM))
+            {
+                entries.erase(taskName);
+                continue;
+            }
+
+            Entry entry;
+            if(readEntry(taskName, entry))
+                entries[taskName] = entry;
+        }
+    }
+}
+
+std::vector< std::string > FileNameService::getRegisteredTasks()
+{
+    processEvents(0);
+
+    std::vector<std::string> ret;
+    for(const std::pair<const std::string, Entry> &entry: entries)
+    {
+        if(isAlive(entry.second))
+            ret.push_back(entry.first);
+    }
+    return ret;
+}
+
+bool FileNameService::isRegistered(const std::string& taskName)
+{
+    processEvents(0);
+
+    auto it = entries.find(taskName);
+    if(it == entries.end())
+        return false;
+
+    if(!isAlive(it->second))
+    {
+        //leftover of a crashed process
+        unlink(getFileName(taskName).c_str());
+        entries.erase(it);
+        return false;
+    }
+
+    return true;
+}
+
+std::string FileNameService::getIOR(const std::string& taskName)
+{
+    if(!isRegistered(taskName))
+        return std::string();
+
+    return entries[taskName].ior;
+}
+
+bool FileNameService::waitForRegistration(const std::string& taskName, const base::Time& timeout)
+{
+    base::Time end = base::Time::now() + timeout;
+    while(!isRegistered(taskName))
+    {
+        base::Time remaining = end - base::Time::now();
+        if(remaining.toMicroseconds() <= 0)
+            return false;
+
+        processEvents(static_cast<int>(remaining.toMilliseconds()) + 1);
+    }
+    return true;
+}
+
+RTT::TaskContext* FileNameService::getTaskContext(const std::string& taskName)
+{
+    OROCOS_CPP_TRACE_SCOPE("FileNameService::getTaskContext", taskName);
+
+    std::string ior = getIOR(taskName);
+    if(ior.empty())
+        return nullptr;
+
+    RTT::TaskContext *ret = nullptr;
+    try
+    {
+        OROCOS_CPP_TRACE_SCOPE("TaskContextProxy::Create", taskName);
+        ret = RTT::corba::TaskContextProxy::Create(ior, true);
+    }
+    catch (...)
+    {
+        std::cout << "Ghost " << taskName << std::endl;
+    }
+
+    return ret;
+}
+
+std::vector< bool > FileNameService::areRegistered(const std::vector< std::string >& names, size_t maxConcurrency)
+{
+    std::vector<bool> registered;
+    for(const std::string &name: names)
+        registered.push_back(isRegistered(name));
+    return registered;
+}
+
+std::vector< NameService::TaskLookup > FileNameService::getTaskContexts(const std::vector< std::string >& names, size_t maxConcurrency)
+{
+    OROCOS_CPP_TRACE_SCOPE("FileNameService::getTaskContexts");
+
+    //the entries are not thread safe, read all IORs first
+    std::vector<std::string> iors;
+    for(const std::string &name: names)
+        iors.push_back(getIOR(name));
+
+    std::vector<TaskLookup> results(names.size());
+    runConcurrently(names.size(), maxConcurrency, [&names, &iors, &results](size_t i) {
+        TaskLookup &result(results[i]);
+        result.taskName = names[i];
+        result.task = nullptr;
+        if(iors[i].empty())
+        {
+            result.error = "task " + names[i] + " is not registered";
+            return;
+        }
+
+        try
+        {
+            OROCOS_CPP_TRACE_SCOPE("TaskContextProxy::Create", names[i]);
+            result.task = RTT::corba::TaskContextProxy::Create(iors[i], true);
+        }
+        catch (...)
+        {
+        }
+
+        if(!result.task)
+            result.error = "task " + names[i] + " is registered, but not reachable";
+    });
+    return results;
+}
+
+int FileNameService::watch(const WatchCallback& callback)
+{
+    if(inotifyFd < 0)
+        throw std::runtime_error("FileNameService::Error, called watch() without connection");
+
+    int id = watchDispatcher.add(callback);
+    if(watchThread.joinable())
+        return id;
+
+    //a watch of its own, the entries of the lookups are not thread safe
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(fd < 0 || inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) < 0)
+    {
+        std::string error(strerror(errno));
+        if(fd >= 0)
+            close(fd);
+        watchDispatcher.remove(id);
+        throw std::runtime_error("FileNameService::Error, could not watch " + directory + " : " + error);
+    }
+
+    watchThread = std::thread(&FileNameService::watchLoop, this, fd);
+    return id;
+}
+
+void FileNameService::unwatch(int watchId)
+{
+    watchDispatcher.remove(watchId);
+}
+
+void FileNameService::watchLoop(int fd)
+{
+    std::map<std::string, Entry> known;
+    scanDirectory(known);
+
+    while(!stopWatching)
+    {
+        //drop the tasks of crashed processes
+        for(auto it = known.begin(); it != known.end(); )
+        {
+            if(isAlive(it->second))
+            {
+                it++;
+                continue;
+            }
+            it = known.erase(it);
+        }
+
+        //published also if nothing changed, new watchers get their initial events
+        WatchDispatcher::Snapshot snapshot;
+        for(const std::pair<const std::string, Entry> &entry: known)
+            snapshot[entry.first] = entry.second.ior;
+        watchDispatcher.publish(snapshot);
+
+        pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        if(poll(&pfd, 1, 500) <= 0)
+            continue;
+
+        char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+        ssize_t len;
+        while((len = read(fd, buffer, sizeof(buffer))) > 0)
+        {
+            for(char *ptr = buffer; ptr < buffer + len; )
+            {
+                const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(ptr);
+                ptr += sizeof(struct inotify_event) + event->len;
+
+                if(event->mask & IN_Q_OVERFLOW)
+                {
+                    scanDirectory(known);
+                    continue;
+                }
+
+                if(!event->len || !isIORFile(event->name))
+                    continue;
+
+                std::string taskName = taskNameFromFile(event->name);
+                Entry entry;
+                if(event->mask & (IN_DELETE | IN_MOVED_FROM))
+                    known.erase(taskName);
+                else if(readEntry(taskName, entry))
+                    known[taskName] = entry;
+            }
+        }
+    }
+
+    close(fd);
+}
+
+bool FileNameService::publish(RTT::TaskContext* task)
+{
+    if(!RTT::corba::TaskContextServer::Create(task, false))
+    {
+        std::cout << "FileNameService::Error, could not create CORBA server for " << task->getName() << std::endl;
+        return false;
+    }
+
+    return publish(task->getName(), RTT::corba::TaskContextServer::getIOR(task), getpid());
+}
+
+bool FileNameService::publish(const std::string& taskName, const std::string& ior, pid_t pid)
+{
+    //write to a temporary file and rename it, so that readers never see partial entries
+    std::string tmpFile = directory + "/." + taskName + IOR_ENDING + "." + boost::lexical_cast<std::string>(getpid());
+    {
+        std::ofstream out(tmpFile.c_str());
+        out << pid << std::endl << ior << std::endl;
+        if(!out.good())
+        {
+            std::cout << "FileNameService::Error, could not write " << tmpFile << std::endl;
+            return false;
+        }
+    }
+
+    if(rename(tmpFile.c_str(), getFileName(taskName).c_str()))
+    {
+        std::cout << "FileNameService::Error, could not publish " << taskName << " : " << strerror(errno) << std::endl;
+        unlink(tmpFile.c_str());
+        return false;
+    }
+
+    publishedTasks.insert(taskName);
+    return true;
+}
+
+bool FileNameService::unpublish(const std::string& taskName)
+{
+    publishedTasks.erase(taskName);
+    entries.erase(taskName);
+    return unlink(getFileName(taskName).c_str()) == 0;
+}
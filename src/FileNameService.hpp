@@ -0,0 +1,124 @@
+#ifndef FILENAMESERVICE_H
+#define FILENAMESERVICE_H
+
+#include "NameService.hpp"
+#include "WatchDispatcher.hpp"
+#include <base/Time.hpp>
+#include <sys/types.h>
+#include <atomic>
+#include <map>
+#include <set>
+#include <thread>
+
+namespace orocos_cpp
+{
+
+/**
+ * Name service for tasks running on a single host.
+ *
+ * Tasks publish their IOR as file <taskName>.ior into a shared
+ * directory. The directory is watched using inotify, so lookups
+ * are answered from memory, without a round trip to a naming
+ * server, and registrations are noticed without polling.
+ *
+ * Each file contains the pid of the process serving the task,
+ * entries of dead processes are ignored and removed.
+ *
+ * Watchers are notified by a thread with its own inotify watch on the
+ * directory. It also checks the processes of the known tasks twice a
+ * second, to report tasks of crashed processes as removed.
+ * */
+class FileNameService : public NameService
+{
+public:
+    /**
+     * @param directory The directory the IORs are published in. If empty, the
+     *        environment variable OROCOS_CPP_NAMESERVICE_DIR is used, and if
+     *        that is not set /tmp/orocos_cpp-<uid>
+     * */
+    FileNameService(const std::string &directory = std::string());
+    virtual ~FileNameService();
+
+    virtual bool connect();
+    virtual bool isConnected();
+    virtual std::vector< std::string > getRegisteredTasks();
+    virtual bool isRegistered(const std::string& taskName);
+    virtual RTT::TaskContext* getTaskContext(const std::string& taskName);
+
+    /**
+     * Answered from memory, without additional threads
+     * */
+    virtual std::vector<bool> areRegistered(const std::vector<std::string> &names, size_t maxConcurrency = DEFAULT_BATCH_CONCURRENCY);
+
+    /**
+     * Looks up the IORs in memory, only the proxies are created concurrently
+     * */
+    virtual std::vector<TaskLookup> getTaskContexts(const std::vector<std::string> &names, size_t maxConcurrency = DEFAULT_BATCH_CONCURRENCY);
+
+    virtual int watch(const WatchCallback &callback);
+    virtual void unwatch(int watchId);
+
+    /**
+     * Makes the given task available via CORBA (without registering
+     * it at the CORBA naming service) and publishes its IOR.
+     * */
+    bool publish(RTT::TaskContext *task);
+
+    /**
+     * Publishes the IOR of a task served by the process with the given pid.
+     * */
+    bool publish(const std::string &taskName, const std::string &ior, pid_t pid);
+
+    /**
+     * Removes the entry of the given task.
+     * */
+    bool unpublish(const std::string &taskName);
+
+    /**
+     * Returns the IOR of the given task, or an empty string
+     * if it is not registered
+     * */
+    std::string getIOR(const std::string &taskName);
+
+    /**
+     * Blocks until the task is registered or the timeout expired.
+     * @return true if the task is registered
+     * */
+    bool waitForRegistration(const std::string &taskName, const base::Time &timeout);
+
+    const std::string &getDirectory() const;
+
+private:
+    struct Entry
+    {
+        std::string ior;
+        pid_t pid;
+    };
+
+    std::string getFileName(const std::string &taskName) const;
+    bool readEntry(const std::string &taskName, Entry &entry) const;
+    bool isAlive(const Entry &entry) const;
+
+    /**
+     * Reads pending inotify events and updates the entries.
+     * Waits up to timeoutMs for the first event.
+     * */
+    void processEvents(int timeoutMs);
+    void scanDirectory();
+    void scanDirectory(std::map<std::string, Entry> &result) const;
+    void watchLoop(int fd);
+
+    std::string directory;
+    int inotifyFd;
+    std::map<std::string, Entry> entries;
+
+    //tasks published by this instance, removed on destruction
+    std::set<std::string> publishedTasks;
+
+    WatchDispatcher watchDispatcher;
+    std::thread watchThread;
+    std::atomic<bool> stopWatching;
+};
+
+}//end of namespace
+#endif // FILENAMESERVICE_H
@@ -0,0 +1,74 @@
+#ifndef KNOWNBASETYPES_H
+#define KNOWNBASETYPES_H
+
+#include "KnownTypes.hpp"
+#include <base/Eigen.hpp>
+#include <base/Time.hpp>
+#include <base/samples/RigidBodyState.hpp>
+
+namespace orocos_cpp
+{
+
+/**
+ * Field tables of the hot types of base. The Eigen types are described
+ * in the layout of their marshalling wrappers, which is what the
+ * configuration files and the Typelib dumps use.
+ * */
+
+template <>
+struct KnownType<base::Time>
+{
+    template <typename Visitor>
+    static bool visitFields(base::Time &value, Visitor &visitor)
+    {
+        return visitor.field("microseconds", value.microseconds);
+    }
+};
+
+template <typename Scalar, int Rows, int Cols, int Options, int MaxRows, int MaxCols>
+struct KnownType<Eigen::Matrix<Scalar, Rows, Cols, Options, MaxRows, MaxCols> >
+{
+    static_assert(Rows > 0 && Cols > 0, "only fixed size matrices have a known layout");
+
+    template <typename Visitor>
+    static bool visitFields(Eigen::Matrix<Scalar, Rows, Cols, Options, MaxRows, MaxCols> &value, Visitor &visitor)
+    {
+        return visitor.array("data", value.data(), Rows * Cols);
+    }
+};
+
+template <typename Scalar, int Options>
+struct KnownType<Eigen::Quaternion<Scalar, Options> >
+{
+    template <typename Visitor>
+    static bool visitFields(Eigen::Quaternion<Scalar, Options> &value, Visitor &visitor)
+    {
+        //Eigen stores x, y, z, w
+        Scalar *coeffs = value.coeffs().data();
+        return visitor.array("im", coeffs, 3)
+            && visitor.field("re", coeffs[3]);
+    }
+};
+
+template <>
+struct KnownType<base::samples::RigidBodyState>
+{
+    template <typename Visitor>
+    static bool visitFields(base::samples::RigidBodyState &value, Visitor &visitor)
+    {
+        return visitor.field("time", value.time)
+            && visitor.field("sourceFrame", value.sourceFrame)
+            && visitor.field("targetFrame", value.targetFrame)
+            && visitor.field("position", value.position)
+            && visitor.field("cov_position", value.cov_position)
+            && visitor.field("orientation", value.orientation)
+            && visitor.field("cov_orientation", value.cov_orientation)
+            && visitor.field("velocity", value.velocity)
+            && visitor.field("cov_velocity", value.cov_velocity)
+            && visitor.field("angular_velocity", value.angular_velocity)
+            && visitor.field("cov_angular_velocity", value.cov_angular_velocity);
+    }
+};
+
+}//end of namespace
+#endif // KNOWNBASETYPES_H
@@ -0,0 +1,233 @@
+#include "KnownTypes.hpp"
+#include "KnownBaseTypes.hpp"
+#include <rtt/types/TypeInfo.hpp>
+#include <typelib/typemodel.hh>
+#include <iostream>
+
+using namespace orocos_cpp;
+using namespace libConfig;
+
+namespace
+{
+
+const std::string emptyString;
+
+bool matchFields(const Typelib::Compound &comp, const std::vector<KnownTypeField> &fields, size_t &index);
+
+bool matchType(const Typelib::Type &type, const KnownTypeField &known, const std::vector<KnownTypeField> &fields, size_t &index)
+{
+    switch(known.kind)
+    {
+        case KnownTypeField::INTEGER:
+        case KnownTypeField::FLOAT:
+        {
+            if(type.getCategory() != Typelib::Type::Numeric || type.getSize() != known.size)
+                return false;
+            const bool isFloat = static_cast<const Typelib::Numeric &>(type).getNumericCategory() == Typelib::Numeric::Float;
+            return isFloat == (known.kind == KnownTypeField::FLOAT);
+        }
+        case KnownTypeField::STRING:
+            return type.getCategory() == Typelib::Type::Container
+                && static_cast<const Typelib::Container &>(type).kind() == "/std/string";
+        case KnownTypeField::COMPOUND:
+            if(type.getCategory() != Typelib::Type::Compound)
+                return false;
+            if(!matchFields(static_cast<const Typelib::Compound &>(type), fields, index))
+                return false;
+            return index < fields.size() && fields[index++].kind == KnownTypeField::END_COMPOUND;
+        case KnownTypeField::END_COMPOUND:
+            break;
+    }
+    return false;
+}
+
+/**
+ * Checks that the fields of the known type at index have the names,
+ * order and kinds of the fields of the Typelib compound
+ * */
+bool matchFields(const Typelib::Compound &comp, const std::vector<KnownTypeField> &fields, size_t &index)
+{
+    for(const Typelib::Field &field: comp.getFields())
+    {
+        if(index >= fields.size() || fields[index].name != field.getName())
+            return false;
+
+        const KnownTypeField &known(fields[index++]);
+        const Typelib::Type *type = &field.getType();
+        if(known.arraySize)
+        {
+            if(type->getCategory() != Typelib::Type::Array || static_cast<const Typelib::Array *>(type)->getDimension() != known.arraySize)
+                return false;
+            type = &static_cast<const Typelib::Array *>(type)->getIndirection();
+        }
+
+        if(!matchType(*type, known, fields, index))
+            return false;
+    }
+    return true;
+}
+
+}
+
+CompactConfig::Type LibConfigNode::getType() const
+{
+    switch(value->getType())
+    {
+        case ConfigValue::SIMPLE:
+            return CompactConfig::SIMPLE;
+        case ConfigValue::COMPLEX:
+            return CompactConfig::COMPLEX;
+        case ConfigValue::ARRAY:
+            break;
+    }
+    return CompactConfig::ARRAY;
+}
+
+const std::string& LibConfigNode::getName() const
+{
+    return value->getName();
+}
+
+const std::string& LibConfigNode::getValue() const
+{
+    if(value->getType() != ConfigValue::SIMPLE)
+        return emptyString;
+    return static_cast<const SimpleConfigValue *>(value)->getValue();
+}
+
+size_t LibConfigNode::getSize() const
+{
+    if(value->getType() != ConfigValue::ARRAY)
+        return 0;
+    return static_cast<const ArrayConfigValue *>(value)->getValues().size();
+}
+
+LibConfigNode LibConfigNode::getElement(size_t index) const
+{
+    if(index >= getSize())
+        throw std::out_of_range("LibConfigNode::getElement: index out of range");
+    return LibConfigNode(*static_cast<const ArrayConfigValue *>(value)->getValues()[index]);
+}
+
+bool LibConfigNode::getField(const std::string& name, LibConfigNode& field) const
+{
+    if(value->getType() != ConfigValue::COMPLEX)
+        return false;
+
+    const std::map<std::string, std::shared_ptr<ConfigValue> > &values(static_cast<const ComplexConfigValue *>(value)->getValues());
+    auto it = values.find(name);
+    if(it == values.end())
+        return false;
+
+    field.value = it->second.get();
+    return true;
+}
+
+size_t LibConfigNode::getFieldCount() const
+{
+    if(value->getType() != ConfigValue::COMPLEX)
+        return 0;
+    return static_cast<const ComplexConfigValue *>(value)->getValues().size();
+}
+
+std::vector< std::string > LibConfigNode::getFieldNames() const
+{
+    std::vector<std::string> names;
+    if(value->getType() != ConfigValue::COMPLEX)
+        return names;
+    for(const std::pair<const std::string, std::shared_ptr<ConfigValue> > &entry: static_cast<const ComplexConfigValue *>(value)->getValues())
+        names.push_back(entry.first);
+    return names;
+}
+
+KnownTypeHandler::KnownTypeHandler() : state(UNCHECKED)
+{
+}
+
+bool KnownTypeHandler::isUsable(const RTT::types::TypeInfo* typeInfo)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if(state == UNCHECKED)
+    {
+        state = check(typeInfo) ? USABLE : UNUSABLE;
+        if(state == UNUSABLE)
+            std::cout << "KnownTypeHandler::isUsable : Warning, the field table of " << typeInfo->getTypeName()
+                      << " does not match the typekit, using the Typelib interpreter" << std::endl;
+    }
+    return state == USABLE;
+}
+
+bool KnownTypeHandler::check(const RTT::types::TypeInfo* typeInfo)
+{
+    orogen_transports::TypelibMarshallerBase *marshaller =
+            dynamic_cast<orogen_transports::TypelibMarshallerBase *>(typeInfo->getProtocol(orogen_transports::TYPELIB_MARSHALLER_ID));
+    if(!marshaller)
+        return false;
+
+    const Typelib::Type *type = marshaller->getRegistry().get(marshaller->getMarshallingType());
+    if(!type || type->getCategory() != Typelib::Type::Compound)
+        return false;
+
+    std::vector<KnownTypeField> fields;
+    getLayout(fields);
+    size_t index = 0;
+    if(!matchFields(static_cast<const Typelib::Compound &>(*type), fields, index) || index != fields.size())
+        return false;
+
+    //padding and opaque conversions are not visible in the field table,
+    //so compare the dumps of a sample as well
+    std::vector<uint8_t> typelibDump;
+    std::vector<uint8_t> knownDump;
+    return dumpThroughMarshaller(marshaller, *type, typelibDump, knownDump) && typelibDump == knownDump;
+}
+
+KnownTypeRegistry& KnownTypeRegistry::getInstance()
+{
+    static KnownTypeRegistry instance;
+    return instance;
+}
+
+KnownTypeRegistry::KnownTypeRegistry() : enabled(true)
+{
+    add<base::Time>("/base/Time");
+
+    add<base::Vector2d>("/base/Vector2d");
+    add<base::Vector3d>("/base/Vector3d");
+    add<base::Vector3d>("/base/Position");
+    add<base::Vector4d>("/base/Vector4d");
+    add<base::Matrix2d>("/base/Matrix2d");
+    add<base::Matrix3d>("/base/Matrix3d");
+    add<base::Matrix4d>("/base/Matrix4d");
+    add<base::Quaterniond>("/base/Quaterniond");
+    add<base::Quaterniond>("/base/Orientation");
+
+    add<base::samples::RigidBodyState>("/base/samples/RigidBodyState");
+}
+
+std::shared_ptr<KnownTypeHandler> KnownTypeRegistry::get(const RTT::types::TypeInfo* typeInfo)
+{
+    if(!typeInfo)
+        return nullptr;
+
+    std::shared_ptr<KnownTypeHandler> handler;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(!enabled)
+            return nullptr;
+        auto it = handlers.find(typeInfo->getTypeName());
+        if(it == handlers.end())
+            return nullptr;
+        handler = it->second;
+    }
+
+    if(!handler->isUsable(typeInfo))
+        return nullptr;
+
+    return handler;
+}
+
+void KnownTypeRegistry::setEnabled(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    this->enabled = enabled;
+}
@@ -0,0 +1,592 @@
+#ifndef KNOWNTYPES_H
+#define KNOWNTYPES_H
+
+#include "CompactConfig.hpp"
+#include "NumberParser.hpp"
+#include <rtt/base/DataSourceBase.hpp>
+#include <rtt/internal/DataSources.hpp>
+#include <rtt/typelib/TypelibMarshallerBase.hpp>
+#include <typelib/value_ops.hh>
+#include <boost/lexical_cast.hpp>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <stdint.h>
+
+namespace orocos_cpp
+{
+
+/**
+ * Describes the fields of a C++ type whose layout is known at compile
+ * time. Specializations provide
+ *
+ *   template <typename Visitor>
+ *   static bool visitFields(T &value, Visitor &visitor);
+ *
+ * which calls visitor.field(name, member) for every field and
+ * visitor.array(name, pointer, size) for fixed size arrays, in the
+ * order of the fields of the Typelib type. Every operation on the type
+ * (applying configurations, validating, dumping) is one visitor, so the
+ * compiler generates straight line code per type and operation.
+ *
+ * Fields may be numbers, std::string or types with a KnownType
+ * specialization themselves.
+ * */
+template <typename T>
+struct KnownType;
+
+/**
+ * Read access to a libConfig::ConfigValue with the interface of
+ * CompactConfigValue, so that one applier handles both representations.
+ * */
+class LibConfigNode
+{
+public:
+    explicit LibConfigNode(const libConfig::ConfigValue &value) : value(&value)
+    {
+    }
+
+    CompactConfig::Type getType() const;
+    bool hasConflict() const
+    {
+        return false;
+    }
+    const std::string &getName() const;
+    const std::string &getValue() const;
+    size_t getSize() const;
+    LibConfigNode getElement(size_t index) const;
+    bool getField(const std::string &name, LibConfigNode &field) const;
+    size_t getFieldCount() const;
+    std::vector<std::string> getFieldNames() const;
+
+private:
+    const libConfig::ConfigValue *value;
+};
+
+/**
+ * Applies a configuration on a known type. Errors are collected
+ * with the path of the offending value, the first error stops.
+ * */
+template <typename Node>
+class KnownTypeApplier
+{
+public:
+    KnownTypeApplier(const Node &node, const std::string &path, std::vector<std::string> &errors) : node(node), path(path), errors(errors), usedFields(0)
+    {
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value, bool>::type apply(T &value)
+    {
+        if(!checkType(CompactConfig::SIMPLE, "a scalar"))
+            return false;
+        std::string error;
+        if(!parseConfigScalar(node.getValue(), value, error))
+            return fail("could not convert " + node.getValue() + " : " + error);
+        return true;
+    }
+
+    bool apply(std::string &value)
+    {
+        if(!checkType(CompactConfig::SIMPLE, "a string"))
+            return false;
+        value = node.getValue();
+        return true;
+    }
+
+    template <typename T>
+    typename std::enable_if<!std::is_arithmetic<T>::value, bool>::type apply(T &value)
+    {
+        if(!checkType(CompactConfig::COMPLEX, "a map"))
+            return false;
+        usedFields = 0;
+        if(!KnownType<T>::visitFields(value, *this))
+            return false;
+        if(usedFields != node.getFieldCount())
+            return fail("unknown fields in the configuration");
+        return true;
+    }
+
+    template <typename M>
+    bool field(const char *name, M &member)
+    {
+        Node child(node);
+        if(!node.getField(name, child))
+            return true;
+        usedFields++;
+        KnownTypeApplier<Node> applier(child, path + "." + name, errors);
+        return applier.apply(member);
+    }
+
+    template <typename M>
+    bool array(const char *name, M *data, size_t size)
+    {
+        Node child(node);
+        if(!node.getField(name, child))
+            return true;
+        usedFields++;
+        KnownTypeApplier<Node> arrayApplier(child, path + "." + name, errors);
+        if(!arrayApplier.checkType(CompactConfig::ARRAY, "an array"))
+            return false;
+        if(child.getSize() != size)
+            return arrayApplier.fail("expected " + boost::lexical_cast<std::string>(size) + " elements, got " + boost::lexical_cast<std::string>(child.getSize()));
+        for(size_t i = 0; i < size; i++)
+        {
+            KnownTypeApplier<Node> applier(child.getElement(i), path + "." + name + "[" + boost::lexical_cast<std::string>(i) + "]", errors);
+            if(!applier.apply(data[i]))
+                return false;
+        }
+        return true;
+    }
+
+private:
+    Node node;
+    std::string path;
+    std::vector<std::string> &errors;
+    size_t usedFields;
+
+    bool fail(const std::string &error)
+    {
+        errors.push_back(path + ": " + error);
+        return false;
+    }
+
+    bool checkType(CompactConfig::Type type, const char *expected)
+    {
+        if(node.hasConflict())
+            return fail("the merged configurations define this value with different types");
+        if(node.getType() != type)
+            return fail(std::string("expected ") + expected);
+        return true;
+    }
+};
+
+/**
+ * Writes a known type in the format of Typelib::dump: numbers
+ * in host byte order without padding, strings and containers
+ * as 64 bit element count followed by the elements.
+ * */
+class KnownTypeDumper
+{
+public:
+    explicit KnownTypeDumper(std::vector<uint8_t> &buffer) : buffer(buffer)
+    {
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value, bool>::type dump(const T &value)
+    {
+        append(&value, sizeof(T));
+        return true;
+    }
+
+    bool dump(const std::string &value)
+    {
+        uint64_t size = value.size();
+        append(&size, sizeof(size));
+        append(value.data(), value.size());
+        return true;
+    }
+
+    template <typename T>
+    typename std::enable_if<!std::is_arithmetic<T>::value, bool>::type dump(const T &value)
+    {
+        //the visitor interface is shared with the appliers, dumping does not modify
+        return KnownType<T>::visitFields(const_cast<T &>(value), *this);
+    }
+
+    template <typename M>
+    bool field(const char *, M &member)
+    {
+        return dump(member);
+    }
+
+    template <typename M>
+    bool array(const char *, M *data, size_t size)
+    {
+        if(std::is_arithmetic<M>::value)
+        {
+            append(data, sizeof(M) * size);
+            return true;
+        }
+        for(size_t i = 0; i < size; i++)
+            dump(data[i]);
+        return true;
+    }
+
+private:
+    std::vector<uint8_t> &buffer;
+
+    void append(const void *data, size_t size)
+    {
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    }
+};
+
+/**
+ * Reads a known type written by KnownTypeDumper or Typelib::dump
+ * */
+class KnownTypeLoader
+{
+public:
+    KnownTypeLoader(const std::vector<uint8_t> &buffer) : buffer(buffer), offset(0)
+    {
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value, bool>::type load(T &value)
+    {
+        return read(&value, sizeof(T));
+    }
+
+    bool load(std::string &value)
+    {
+        uint64_t size;
+        if(!read(&size, sizeof(size)) || size > buffer.size() - offset)
+            return false;
+        value.assign(reinterpret_cast<const char *>(buffer.data()) + offset, size);
+        offset += size;
+        return true;
+    }
+
+    template <typename T>
+    typename std::enable_if<!std::is_arithmetic<T>::value, bool>::type load(T &value)
+    {
+        return KnownType<T>::visitFields(value, *this);
+    }
+
+    template <typename M>
+    bool field(const char *, M &member)
+    {
+        return load(member);
+    }
+
+    template <typename M>
+    bool array(const char *, M *data, size_t size)
+    {
+        if(std::is_arithmetic<M>::value)
+            return read(data, sizeof(M) * size);
+        for(size_t i = 0; i < size; i++)
+        {
+            if(!load(data[i]))
+                return false;
+        }
+        return true;
+    }
+
+    ///true if the whole buffer was consumed
+    bool isComplete() const
+    {
+        return offset == buffer.size();
+    }
+
+private:
+    const std::vector<uint8_t> &buffer;
+    size_t offset;
+
+    bool read(void *data, size_t size)
+    {
+        if(size > buffer.size() - offset)
+            return false;
+        memcpy(data, buffer.data() + offset, size);
+        offset += size;
+        return true;
+    }
+};
+
+/**
+ * Kind of a field as seen by the layout check
+ * */
+struct KnownTypeField
+{
+    enum Kind
+    {
+        INTEGER,
+        FLOAT,
+        STRING,
+        COMPOUND,
+        END_COMPOUND,
+    };
+
+    std::string name;
+    Kind kind;
+    size_t size;
+    ///number of elements of fixed size arrays, 0 otherwise
+    size_t arraySize;
+};
+
+/**
+ * Lists the fields of a known type in visiting order, depth first.
+ * Compound fields are followed by their fields and an END_COMPOUND entry.
+ * */
+class KnownTypeLayout
+{
+public:
+    explicit KnownTypeLayout(std::vector<KnownTypeField> &fields) : fields(fields)
+    {
+    }
+
+    template <typename M>
+    bool field(const char *name, M &member)
+    {
+        add(name, member, 0);
+        return true;
+    }
+
+    template <typename M>
+    bool array(const char *name, M *data, size_t size)
+    {
+        add(name, *data, size);
+        return true;
+    }
+
+private:
+    std::vector<KnownTypeField> &fields;
+
+    template <typename M>
+    typename std::enable_if<std::is_arithmetic<M>::value>::type add(const char *name, M &, size_t arraySize)
+    {
+        push(name, std::is_floating_point<M>::value ? KnownTypeField::FLOAT : KnownTypeField::INTEGER, sizeof(M), arraySize);
+    }
+
+    void add(const char *name, std::string &, size_t arraySize)
+    {
+        push(name, KnownTypeField::STRING, 0, arraySize);
+    }
+
+    template <typename M>
+    typename std::enable_if<!std::is_arithmetic<M>::value>::type add(const char *name, M &member, size_t arraySize)
+    {
+        push(name, KnownTypeField::COMPOUND, 0, arraySize);
+        KnownType<M>::visitFields(member, *this);
+        push("", KnownTypeField::END_COMPOUND, 0, 0);
+    }
+
+    void push(const char *name, KnownTypeField::Kind kind, size_t size, size_t arraySize)
+    {
+        KnownTypeField field;
+        field.name = name;
+        field.kind = kind;
+        field.size = size;
+        field.arraySize = arraySize;
+        fields.push_back(field);
+    }
+};
+
+/**
+ * Type erased operations on one known type, working on RTT data sources.
+ *
+ * A handler is only used after its field table was checked against
+ * the Typelib type of the loaded typekit, so a C++ type that does not
+ * match the typekit falls back to the Typelib interpreter.
+ * */
+class KnownTypeHandler
+{
+public:
+    KnownTypeHandler();
+    virtual ~KnownTypeHandler() {}
+
+    /**
+     * Checks the field table against the marshalling type of the
+     * typekit. The check is done on the first call only.
+     * */
+    bool isUsable(const RTT::types::TypeInfo *typeInfo);
+
+    /**
+     * True if the data source holds the C++ type of this handler
+     * */
+    virtual bool accepts(const RTT::base::DataSourceBase::shared_ptr &ds) const = 0;
+
+    /**
+     * Reads the data source, applies the configuration and writes it back
+     * */
+    virtual bool apply(const RTT::base::DataSourceBase::shared_ptr &ds, const CompactConfigValue &conf, std::vector<std::string> &errors) const = 0;
+
+    /**
+     * Checks if the configuration could be applied on the type
+     * */
+    virtual void validate(const libConfig::ConfigValue &conf, const std::string &path, std::vector<std::string> &errors) const = 0;
+
+    /**
+     * Appends the Typelib dump of the value of the data source
+     * */
+    virtual bool dump(const RTT::base::DataSourceBase::shared_ptr &ds, std::vector<uint8_t> &buffer) const = 0;
+
+    /**
+     * Writes a Typelib dump into the data source
+     * */
+    virtual bool load(const RTT::base::DataSourceBase::shared_ptr &ds, const std::vector<uint8_t> &buffer) const = 0;
+
+protected:
+    virtual void getLayout(std::vector<KnownTypeField> &fields) const = 0;
+
+    /**
+     * Converts a default constructed value through the marshaller and
+     * dumps the resulting Typelib sample, for comparison with dump()
+     * */
+    virtual bool dumpThroughMarshaller(orogen_transports::TypelibMarshallerBase *marshaller, const Typelib::Type &type, std::vector<uint8_t> &typelibDump, std::vector<uint8_t> &knownDump) const = 0;
+
+private:
+    enum State
+    {
+        UNCHECKED,
+        USABLE,
+        UNUSABLE,
+    };
+
+    std::mutex mutex;
+    State state;
+
+    bool check(const RTT::types::TypeInfo *typeInfo);
+};
+
+template <typename T>
+class KnownTypeHandlerImpl : public KnownTypeHandler
+{
+public:
+    virtual bool accepts(const RTT::base::DataSourceBase::shared_ptr &ds) const
+    {
+        return RTT::internal::AssignableDataSource<T>::narrow(ds.get());
+    }
+
+    virtual bool apply(const RTT::base::DataSourceBase::shared_ptr &ds, const CompactConfigValue &conf, std::vector<std::string> &errors) const
+    {
+        RTT::internal::AssignableDataSource<T> *typed = RTT::internal::AssignableDataSource<T>::narrow(ds.get());
+        if(!typed)
+            return false;
+
+        //start from the current value, the configuration may only set some fields
+        T value = typed->get();
+        KnownTypeApplier<CompactConfigValue> applier(conf, conf.getName(), errors);
+        if(!applier.apply(value))
+            return false;
+        typed->set(value);
+        return true;
+    }
+
+    virtual void validate(const libConfig::ConfigValue &conf, const std::string &path, std::vector<std::string> &errors) const
+    {
+        T value = T();
+        LibConfigNode node(conf);
+        KnownTypeApplier<LibConfigNode> applier(node, path, errors);
+        applier.apply(value);
+    }
+
+    virtual bool dump(const RTT::base::DataSourceBase::shared_ptr &ds, std::vector<uint8_t> &buffer) const
+    {
+        RTT::internal::DataSource<T> *typed = RTT::internal::DataSource<T>::narrow(ds.get());
+        if(!typed)
+            return false;
+        T value = typed->get();
+        KnownTypeDumper dumper(buffer);
+        return dumper.dump(value);
+    }
+
+    virtual bool load(const RTT::base::DataSourceBase::shared_ptr &ds, const std::vector<uint8_t> &buffer) const
+    {
+        RTT::internal::AssignableDataSource<T> *typed = RTT::internal::AssignableDataSource<T>::narrow(ds.get());
+        if(!typed)
+            return false;
+        T value = typed->get();
+        KnownTypeLoader loader(buffer);
+        if(!loader.load(value) || !loader.isComplete())
+            return false;
+        typed->set(value);
+        return true;
+    }
+
+protected:
+    virtual void getLayout(std::vector<KnownTypeField> &fields) const
+    {
+        T value = T();
+        KnownTypeLayout layout(fields);
+        KnownType<T>::visitFields(value, layout);
+    }
+
+    virtual bool dumpThroughMarshaller(orogen_transports::TypelibMarshallerBase *marshaller, const Typelib::Type &type, std::vector<uint8_t> &typelibDump, std::vector<uint8_t> &knownDump) const
+    {
+        T value = T();
+        typename RTT::internal::ValueDataSource<T>::shared_ptr ds(new RTT::internal::ValueDataSource<T>(value));
+
+        orogen_transports::TypelibMarshallerBase::Handle *handle = marshaller->createSample();
+        bool success = marshaller->readDataSource(*ds, handle);
+        if(success)
+        {
+            marshaller->refreshTypelibSample(handle);
+            Typelib::dump(Typelib::Value(marshaller->getTypelibSample(handle), type), typelibDump);
+        }
+        marshaller->deleteHandle(handle);
+
+        KnownTypeDumper dumper(knownDump);
+        dumper.dump(value);
+        return success;
+    }
+};
+
+/**
+ * Process wide registry of the known types, by RTT type name.
+ *
+ * The types of base (base::Time, the Eigen vectors, matrices and
+ * quaternions, base::samples::RigidBodyState) are registered by
+ * default. Further types are added by specializing KnownType and
+ * calling add<T>(typeName).
+ * */
+class KnownTypeRegistry
+{
+public:
+    static KnownTypeRegistry &getInstance();
+
+    template <typename T>
+    void add(const std::string &typeName)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        handlers[typeName] = std::make_shared<KnownTypeHandlerImpl<T> >();
+    }
+
+    /**
+     * Returns the handler of the given type, or nullptr if the type
+     * is not known or does not match the layout of the typekit
+     * */
+    std::shared_ptr<KnownTypeHandler> get(const RTT::types::TypeInfo *typeInfo);
+
+    /**
+     * Enables or disables all handlers, for comparing against the
+     * Typelib interpreter. Enabled by default.
+     * */
+    void setEnabled(bool enabled);
+
+private:
+    KnownTypeRegistry();
+
+    std::mutex mutex;
+    std::map<std::string, std::shared_ptr<KnownTypeHandler> > handlers;
+    bool enabled;
+};
+
+/**
+ * Applies a configuration directly on a C++ value of a known type.
+ * @return false on errors, which are appended to errors
+ * */
+template <typename T>
+bool applyKnownType(T &value, const libConfig::ConfigValue &conf, std::vector<std::string> &errors)
+{
+    LibConfigNode node(conf);
+    KnownTypeApplier<LibConfigNode> applier(node, conf.getName(), errors);
+    return applier.apply(value);
+}
+
+template <typename T>
+bool applyKnownType(T &value, const CompactConfigValue &conf, std::vector<std::string> &errors)
+{
+    KnownTypeApplier<CompactConfigValue> applier(conf, conf.getName(), errors);
+    return applier.apply(value);
+}
+
+}//end of namespace
+
+#endif // KNOWNTYPES_H
@@ -0,0 +1,444 @@
+#include "LifecycleOrchestrator.hpp"
+#include "Tracing.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+
+using namespace orocos_cpp;
+
+struct LifecycleOrchestrator::Node
+{
+    Node() : task(nullptr), pending(0), started(false), finished(false) {};
+
+    RTT::TaskContext *task;
+    ///tasks whose transition waits for this one
+    std::vector<Node *> successors;
+    ///number of predecessors that did not finish yet
+    size_t pending;
+    bool started;
+    bool finished;
+    std::chrono::steady_clock::time_point deadline;
+    TimelineEntry entry;
+};
+
+namespace
+{
+
+bool isInTargetState(RTT::TaskContext *task, LifecycleOrchestrator::Transition transition)
+{
+    switch(transition)
+    {
+        case LifecycleOrchestrator::CONFIGURE:
+            return task->isConfigured();
+        case LifecycleOrchestrator::START:
+            return task->isRunning();
+        case LifecycleOrchestrator::STOP:
+            return !task->isRunning();
+        case LifecycleOrchestrator::CLEANUP:
+            return !task->isConfigured();
+    }
+    return false;
+}
+
+RTT::base::TaskCore::TaskState getTargetState(LifecycleOrchestrator::Transition transition)
+{
+    switch(transition)
+    {
+        case LifecycleOrchestrator::CONFIGURE:
+        case LifecycleOrchestrator::STOP:
+            return RTT::base::TaskCore::Stopped;
+        case LifecycleOrchestrator::START:
+            return RTT::base::TaskCore::Running;
+        case LifecycleOrchestrator::CLEANUP:
+            return RTT::base::TaskCore::PreOperational;
+    }
+    return RTT::base::TaskCore::Init;
+}
+
+bool performTransition(RTT::TaskContext *task, LifecycleOrchestrator::Transition transition)
+{
+    switch(transition)
+    {
+        case LifecycleOrchestrator::CONFIGURE:
+            return task->configure();
+        case LifecycleOrchestrator::START:
+            return task->start();
+        case LifecycleOrchestrator::STOP:
+            return task->stop();
+        case LifecycleOrchestrator::CLEANUP:
+            return task->cleanup();
+    }
+    return false;
+}
+
+}
+
+LifecycleOrchestrator::LifecycleOrchestrator() : timeout(base::Time::fromSeconds(30)), maxParallel(0)
+{
+}
+
+void LifecycleOrchestrator::addTask(RTT::TaskContext* task)
+{
+    if(!task)
+        throw std::runtime_error("LifecycleOrchestrator::addTask : Error, given task is null");
+
+    const std::string name(task->getName());
+    if(tasks.count(name))
+        throw std::runtime_error("LifecycleOrchestrator::addTask : Error, a task named " + name + " was already added");
+
+    tasks[name] = task;
+    taskOrder.push_back(name);
+}
+
+void LifecycleOrchestrator::addDependency(const std::string& task, const std::string& dependsOn)
+{
+    if(!tasks.count(task) || !tasks.count(dependsOn))
+        throw std::runtime_error("LifecycleOrchestrator::addDependency : Error, task " + (tasks.count(task) ? dependsOn : task) + " was not added");
+    if(task == dependsOn)
+        throw std::runtime_error("LifecycleOrchestrator::addDependency : Error, task " + task + " can not depend on itself");
+
+    dependencies[task].insert(dependsOn);
+}
+
+void LifecycleOrchestrator::setTimeout(const base::Time& timeout)
+{
+    this->timeout = timeout;
+}
+
+void LifecycleOrchestrator::setMaxParallel(size_t maxParallel)
+{
+    this->maxParallel = maxParallel;
+}
+
+void LifecycleOrchestrator::setHook(const Hook& hook)
+{
+    this->hook = hook;
+}
+
+std::vector< std::string > LifecycleOrchestrator::getSortedTasks() const
+{
+    //depth first search, dependencies before dependents
+    std::vector<std::string> sorted;
+    std::set<std::string> done;
+    std::set<std::string> visiting;
+
+    std::function<void (const std::string &)> visit = [&](const std::string &name) {
+        if(done.count(name))
+            return;
+        if(visiting.count(name))
+            throw std::runtime_error("LifecycleOrchestrator : Error, the dependencies of task " + name + " contain a cycle");
+        visiting.insert(name);
+
+        auto it = dependencies.find(name);
+        if(it != dependencies.end())
+        {
+            for(const std::string &dep: it->second)
+                visit(dep);
+        }
+
+        visiting.erase(name);
+        done.insert(name);
+        sorted.push_back(name);
+    };
+
+    for(const std::string &name: taskOrder)
+        visit(name);
+
+    return sorted;
+}
+
+bool LifecycleOrchestrator::run(LifecycleOrchestrator::Transition transition)
+{
+    OROCOS_CPP_TRACE_SCOPE("LifecycleOrchestrator::run", toString(transition));
+
+    std::vector<std::string> sorted = getSortedTasks();
+    const bool reverse = (transition == STOP || transition == CLEANUP);
+    if(reverse)
+        std::reverse(sorted.begin(), sorted.end());
+
+    std::map<std::string, Node> nodes;
+    for(const std::string &name: sorted)
+    {
+        Node &node(nodes[name]);
+        node.task = tasks.at(name);
+        node.entry.taskName = name;
+        node.entry.transition = transition;
+        node.entry.result = NOT_RUN;
+    }
+
+    for(const std::pair<const std::string, std::set<std::string> > &dep: dependencies)
+    {
+        for(const std::string &other: dep.second)
+        {
+            Node &before(nodes[reverse ? dep.first : other]);
+            Node &after(nodes[reverse ? other : dep.first]);
+            before.successors.push_back(&after);
+            after.pending++;
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable finishedCond;
+    std::vector<std::thread> workers;
+    //number of threads that did not return yet, including timed out ones
+    size_t active = 0;
+
+    auto work = [&](Node *node) {
+        OROCOS_CPP_TRACE_SCOPE("LifecycleOrchestrator::transition", node->entry.taskName);
+
+        Result result = SUCCESS;
+        std::string error;
+        try {
+            if(isInTargetState(node->task, transition))
+                result = SKIPPED;
+            else if(hook && !hook(node->task, transition))
+            {
+                result = FAILED;
+                error = "hook failed";
+            }
+            else if(!performTransition(node->task, transition))
+            {
+                result = FAILED;
+                error = toString(transition) + " returned false";
+            }
+            else
+            {
+                base::Time remaining;
+                if(!timeout.isNull())
+                {
+                    remaining = base::Time::fromMicroseconds(std::chrono::duration_cast<std::chrono::microseconds>(node->deadline - std::chrono::steady_clock::now()).count());
+                    if(remaining.toMicroseconds() <= 0)
+                        remaining = base::Time::fromMicroseconds(1);
+                }
+
+                if(!waitForState(node->task, getTargetState(transition), remaining))
+                {
+                    result = FAILED;
+                    error = "task did not reach the target state";
+                }
+            }
+        } catch (const std::exception &e)
+        {
+            result = FAILED;
+            error = e.what();
+        } catch (...)
+        {
+            result = FAILED;
+            error = "unknown exception";
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        active--;
+        if(!node->finished)
+        {
+            node->finished = true;
+            node->entry.result = result;
+            node->entry.error = error;
+            node->entry.end = base::Time::now();
+            if(result == SUCCESS || result == SKIPPED)
+            {
+                for(Node *successor: node->successors)
+                    successor->pending--;
+            }
+        }
+        finishedCond.notify_all();
+    };
+
+    runStart = base::Time::now();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while(true)
+    {
+        for(const std::string &name: sorted)
+        {
+            Node &node(nodes[name]);
+            if(node.started || node.pending || (maxParallel && active >= maxParallel))
+                continue;
+
+            node.started = true;
+            node.entry.start = base::Time::now();
+            node.deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeout.toMicroseconds());
+            active++;
+            workers.push_back(std::thread(work, &node));
+        }
+
+        if(!active)
+            break;
+
+        bool anyRunning = false;
+        std::chrono::steady_clock::time_point nextDeadline = std::chrono::steady_clock::time_point::max();
+        for(std::pair<const std::string, Node> &n: nodes)
+        {
+            if(n.second.started && !n.second.finished)
+            {
+                anyRunning = true;
+                nextDeadline = std::min(nextDeadline, n.second.deadline);
+            }
+        }
+
+        if(!anyRunning || timeout.isNull())
+        {
+            //only timed out calls are left, or there are no deadlines
+            finishedCond.wait(lock);
+            continue;
+        }
+
+        if(finishedCond.wait_until(lock, nextDeadline) != std::cv_status::timeout)
+            continue;
+
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        for(std::pair<const std::string, Node> &n: nodes)
+        {
+            Node &node(n.second);
+            if(node.started && !node.finished && node.deadline <= now)
+            {
+                std::cout << "LifecycleOrchestrator : Error, " << toString(transition) << " of task " << n.first
+                          << " did not finish within " << timeout.toSeconds() << " seconds" << std::endl;
+                node.finished = true;
+                node.entry.result = TIMEOUT;
+                node.entry.error = "timeout";
+                node.entry.end = base::Time::now();
+            }
+        }
+    }
+    lock.unlock();
+
+    for(std::thread &worker: workers)
+        worker.join();
+
+    runEnd = base::Time::now();
+
+    bool success = true;
+    timeline.clear();
+    for(const std::string &name: sorted)
+    {
+        const TimelineEntry &entry(nodes[name].entry);
+        if(entry.result != SUCCESS && entry.result != SKIPPED)
+        {
+            success = false;
+            if(entry.result == FAILED)
+                std::cout << "LifecycleOrchestrator : Error, " << toString(transition) << " of task " << name << " failed : " << entry.error << std::endl;
+        }
+        timeline.push_back(entry);
+    }
+
+    //tasks that were not run have a null start time and end up first, move them to the end
+    std::stable_sort(timeline.begin(), timeline.end(), [](const TimelineEntry &a, const TimelineEntry &b) {
+        if(a.start.isNull() != b.start.isNull())
+            return b.start.isNull();
+        return a.start < b.start;
+    });
+
+    return success;
+}
+
+bool LifecycleOrchestrator::configure()
+{
+    return run(CONFIGURE);
+}
+
+bool LifecycleOrchestrator::start()
+{
+    return run(START);
+}
+
+bool LifecycleOrchestrator::stop()
+{
+    return run(STOP);
+}
+
+bool LifecycleOrchestrator::cleanup()
+{
+    return run(CLEANUP);
+}
+
+bool LifecycleOrchestrator::waitForState(RTT::TaskContext* task, RTT::base::TaskCore::TaskState state, const base::Time& timeout)
+{
+    const base::Time deadline = base::Time::now() + timeout;
+    while(true)
+    {
+        RTT::base::TaskCore::TaskState current = task->getTaskState();
+        if(current == state)
+            return true;
+        if(current == RTT::base::TaskCore::Exception || current == RTT::base::TaskCore::FatalError)
+            return false;
+        if(!timeout.isNull() && base::Time::now() > deadline)
+            return false;
+        usleep(10000);
+    }
+}
+
+std::vector< LifecycleOrchestrator::TimelineEntry > LifecycleOrchestrator::getTimeline() const
+{
+    return timeline;
+}
+
+std::string LifecycleOrchestrator::dumpTimeline() const
+{
+    std::ostringstream out;
+    out << std::left << std::setw(32) << "task" << std::setw(11) << "transition" << std::setw(10) << "result"
+        << std::right << std::setw(10) << "start s" << std::setw(12) << "duration s" << "  error" << std::endl;
+
+    base::Time sum;
+    for(const TimelineEntry &entry: timeline)
+    {
+        out << std::left << std::setw(32) << entry.taskName << std::setw(11) << toString(entry.transition) << std::setw(10) << toString(entry.result);
+        if(!entry.start.isNull())
+        {
+            const base::Time duration = entry.end - entry.start;
+            sum = sum + duration;
+            out << std::right << std::fixed << std::setprecision(3) << std::setw(10) << (entry.start - runStart).toSeconds()
+                << std::setw(12) << duration.toSeconds();
+        }
+        else
+            out << std::right << std::setw(10) << "-" << std::setw(12) << "-";
+        if(!entry.error.empty())
+            out << "  " << entry.error;
+        out << std::endl;
+    }
+
+    out << std::fixed << std::setprecision(3) << "wall time " << (runEnd - runStart).toSeconds()
+        << " s, sum of transitions " << sum.toSeconds() << " s" << std::endl;
+    return out.str();
+}
+
+std::string LifecycleOrchestrator::toString(LifecycleOrchestrator::Transition transition)
+{
+    switch(transition)
+    {
+        case CONFIGURE:
+            return "configure";
+        case START:
+            return "start";
+        case STOP:
+            return "stop";
+        case CLEANUP:
+            return "cleanup";
+    }
+    return "unknown";
+}
+
+std::string LifecycleOrchestrator::toString(LifecycleOrchestrator::Result result)
+{
+    switch(result)
+    {
+        case SUCCESS:
+            return "success";
+        case SKIPPED:
+            return "skipped";
+        case FAILED:
+            return "failed";
+        case TIMEOUT:
+            return "timeout";
+        case NOT_RUN:
+            return "not run";
+    }
+    return "unknown";
+}
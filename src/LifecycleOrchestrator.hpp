@@ -0,0 +1,161 @@
+#ifndef LIFECYCLEORCHESTRATOR_H
+#define LIFECYCLEORCHESTRATOR_H
+
+#include <rtt/TaskContext.hpp>
+#include <base/Time.hpp>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace orocos_cpp
+{
+
+/**
+ * Runs lifecycle transitions of many tasks concurrently.
+ *
+ * Each transition of a remote task is a blocking CORBA call, and
+ * configureHooks may take seconds. The orchestrator runs the
+ * transition of every task in its own thread, as soon as all tasks
+ * it depends on finished theirs. Configure and start respect the
+ * dependencies, stop and cleanup run in reverse order, i.e. a task
+ * is stopped before the tasks it depends on. This way a bring-up
+ * takes as long as the critical path instead of the sum of all
+ * transitions.
+ *
+ * The tasks are not owned by the orchestrator. They must be
+ * thread safe, which is the case for proxies of remote tasks.
+ * */
+class LifecycleOrchestrator
+{
+public:
+    enum Transition
+    {
+        CONFIGURE,
+        START,
+        STOP,
+        CLEANUP,
+    };
+
+    enum Result
+    {
+        ///the transition was performed and the task reached the target state
+        SUCCESS,
+        ///the task already was in the target state
+        SKIPPED,
+        ///the transition returned false, or the task went into an error state
+        FAILED,
+        ///the transition did not finish within the timeout
+        TIMEOUT,
+        ///not tried, because a task it depends on did not succeed
+        NOT_RUN,
+    };
+
+    struct TimelineEntry
+    {
+        std::string taskName;
+        Transition transition;
+        Result result;
+        ///start and end of the transition, including waiting for the state
+        base::Time start;
+        base::Time end;
+        std::string error;
+    };
+
+    /**
+     * Hook called in the worker thread right before a transition of
+     * a task, e.g. to apply the configuration before configure.
+     * Returning false fails the transition.
+     * */
+    typedef std::function<bool (RTT::TaskContext *task, Transition transition)> Hook;
+
+    LifecycleOrchestrator();
+
+    /**
+     * Adds a task. It is referred to by its name. Ownership is not taken.
+     * */
+    void addTask(RTT::TaskContext *task);
+
+    /**
+     * Declares that task is configured and started after dependsOn,
+     * and stopped and cleaned up before it. Both tasks must have been added.
+     * */
+    void addDependency(const std::string &task, const std::string &dependsOn);
+
+    /**
+     * Timeout of a single transition, including waiting for the target
+     * state. Default is 30 seconds, zero disables the timeout.
+     *
+     * Note that a blocking CORBA call can only be interrupted by the ORB.
+     * On a timeout the tasks depending on the task are not handled,
+     * but the orchestrator waits for the running call to return.
+     * */
+    void setTimeout(const base::Time &timeout);
+
+    /**
+     * Maximum number of transitions running at the same time,
+     * zero means no limit. Default is zero.
+     * */
+    void setMaxParallel(size_t maxParallel);
+
+    void setHook(const Hook &hook);
+
+    /**
+     * Performs the given transition on all tasks, respecting the
+     * dependencies. Tasks already in the target state are skipped.
+     * If a transition fails, the tasks depending on it are not handled,
+     * all other tasks are. The timeline is reset on each call.
+     *
+     * Throws if the dependencies contain a cycle.
+     * @return true if all tasks reached the target state
+     * */
+    bool run(Transition transition);
+
+    bool configure();
+    bool start();
+    bool stop();
+    bool cleanup();
+
+    /**
+     * Polls the state of the given task until it equals the given state.
+     * @return false if the timeout expired or the task went into
+     *         the Exception or FatalError state
+     * */
+    static bool waitForState(RTT::TaskContext *task, RTT::base::TaskCore::TaskState state, const base::Time &timeout);
+
+    /**
+     * Returns the timeline of the last run, ordered by start time
+     * */
+    std::vector<TimelineEntry> getTimeline() const;
+
+    /**
+     * Returns the timeline of the last run as human readable table,
+     * together with the wall time and the sum of all transitions.
+     * */
+    std::string dumpTimeline() const;
+
+    static std::string toString(Transition transition);
+    static std::string toString(Result result);
+
+private:
+    struct Node;
+
+    std::map<std::string, RTT::TaskContext *> tasks;
+    std::vector<std::string> taskOrder;
+    ///task name -> names of the tasks it depends on
+    std::map<std::string, std::set<std::string> > dependencies;
+
+    base::Time timeout;
+    size_t maxParallel;
+    Hook hook;
+
+    std::vector<TimelineEntry> timeline;
+    base::Time runStart;
+    base::Time runEnd;
+
+    std::vector<std::string> getSortedTasks() const;
+};
+
+}//end of namespace
+#endif // LIFECYCLEORCHESTRATOR_H
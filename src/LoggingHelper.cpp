@@ -9,6 +9,10 @@
 #include <lib_config/Bundle.hpp>
 #include "Spawner.hpp"
 #include "PluginHelper.hpp"
+#include "TypekitManifest.hpp"
+#include "Tracing.hpp"
+#include "Executor.hpp"
+#include "PartialTaskContextProxy.hpp"
 
 using namespace orocos_cpp;
 using namespace libConfig;
@@ -18,6 +22,11 @@ LoggingHelper::LoggingHelper() : DEFAULT_LOG_BUFFER_SIZE(100)
 
 }
 
+TransportSelector& LoggingHelper::getTransportSelector()
+{
+    return transportSelector;
+}
+
 bool LoggingHelper::logTasks()
 {
     return logTasks(std::map<std::string, bool>(), true);
@@ -26,13 +35,14 @@ bool LoggingHelper::logTasks()
 
 bool LoggingHelper::logTasks(const std::map<std::string, bool> &loggingEnabledTaskMap, bool logAll)
 {
+    OROCOS_CPP_TRACE_SCOPE("LoggingHelper::logTasks");
     Spawner &spawner(Spawner::getInstace());
     
     std::vector<const Deployment *> depls = spawner.getRunningDeployments();
     
     RTT::plugin::PluginLoader loader;
 
-    if(!RTT::types::TypekitRepository::hasTypekit("rtt-types"))
+    if(!PluginHelper::hasTypekit("rtt-types"))
         PluginHelper::loadTypekitAndTransports("rtt-types");
     
     for(const Deployment *dpl: depls)
@@ -40,17 +50,21 @@ bool LoggingHelper::logTasks(const std::map<std::string, bool> &loggingEnabledTa
         //load all needed typekits
         for(const std::string &tk: dpl->getNeededTypekits())
         {
-            if(!RTT::types::TypekitRepository::hasTypekit(tk))
+            if(!PluginHelper::hasTypekit(tk))
             {
                 
                 std::cout << "Warning, we are missing the typekit " << tk << " loading it " << std::endl;
                 PluginHelper::loadTypekitAndTransports(tk);
             }
 
-            if(!RTT::types::TypekitRepository::hasTypekit(tk))
+            if(!PluginHelper::hasTypekit(tk))
             {
                 std::cout << "Load failed" << std::endl;
             }
+            else
+            {
+                TypekitManifest::recordUse(tk);
+            }
         }
         
         for(const std::string &task: dpl->getTaskNames())
@@ -61,7 +75,9 @@ bool LoggingHelper::logTasks(const std::map<std::string, bool> &loggingEnabledTa
             
             if(logAll)
             {
-                RTT::corba::TaskContextProxy *proxy = RTT::corba::TaskContextProxy::Create(task, false);
+                PartialTaskContextProxy *proxy = PartialTaskContextProxy::Create(task, false, PartialTaskContextProxy::OUTPUT_PORTS);
+                if(!proxy)
+                    throw std::runtime_error("Error, could not create proxy for " + task);
                 logAllPorts(proxy, dpl->getLoggerName(),  std::vector< std::string >(), false);
                 delete proxy;
             }
@@ -70,7 +86,9 @@ bool LoggingHelper::logTasks(const std::map<std::string, bool> &loggingEnabledTa
                 auto it = loggingEnabledTaskMap.find(task);
                 if(it != loggingEnabledTaskMap.end() && it->second)
                 {
-                    RTT::corba::TaskContextProxy *proxy = RTT::corba::TaskContextProxy::Create(task, false);
+                    PartialTaskContextProxy *proxy = PartialTaskContextProxy::Create(task, false, PartialTaskContextProxy::OUTPUT_PORTS);
+                    if(!proxy)
+                        throw std::runtime_error("Error, could not create proxy for " + task);
                     logAllPorts(proxy, dpl->getLoggerName(),  std::vector< std::string >(), false);
                     delete proxy;
                 }
@@ -87,13 +105,14 @@ bool LoggingHelper::logTasks(const std::map<std::string, bool> &loggingEnabledTa
 
 bool LoggingHelper::logTasks(const std::vector< std::string >& excludeList)
 {
+    OROCOS_CPP_TRACE_SCOPE("LoggingHelper::logTasks");
     Spawner &spawner(Spawner::getInstace());
     
     std::vector<const Deployment *> depls = spawner.getRunningDeployments();
     
     RTT::plugin::PluginLoader loader;
 
-    if(!RTT::types::TypekitRepository::hasTypekit("rtt-types"))
+    if(!PluginHelper::hasTypekit("rtt-types"))
         PluginHelper::loadTypekitAndTransports("rtt-types");
     
     for(const Deployment *dpl: depls)
@@ -101,17 +120,21 @@ bool LoggingHelper::logTasks(const std::vector< std::string >& excludeList)
         //load all needed typekits
         for(const std::string &tk: dpl->getNeededTypekits())
         {
-            if(!RTT::types::TypekitRepository::hasTypekit(tk))
+            if(!PluginHelper::hasTypekit(tk))
             {
                 
                 std::cout << "Warning, we are missing the typekit " << tk << " loading it " << std::endl;
                 PluginHelper::loadTypekitAndTransports(tk);
             }
 
-            if(!RTT::types::TypekitRepository::hasTypekit(tk))
+            if(!PluginHelper::hasTypekit(tk))
             {
                 std::cout << "Load failed" << std::endl;
             }
+            else
+            {
+                TypekitManifest::recordUse(tk);
+            }
         }
         
         for(const std::string &task: dpl->getTaskNames())
@@ -123,7 +146,9 @@ bool LoggingHelper::logTasks(const std::vector< std::string >& excludeList)
             auto it = std::find(excludeList.begin(), excludeList.end(), task);
             if(it == excludeList.end())
             {
-                RTT::corba::TaskContextProxy *proxy = RTT::corba::TaskContextProxy::Create(task, false);
+                PartialTaskContextProxy *proxy = PartialTaskContextProxy::Create(task, false, PartialTaskContextProxy::OUTPUT_PORTS);
+                if(!proxy)
+                    throw std::runtime_error("Error, could not create proxy for " + task);
                 logAllPorts(proxy, dpl->getLoggerName(),  excludeList, false);
                 delete proxy;
             }
@@ -139,11 +164,20 @@ bool LoggingHelper::logTasks(const std::vector< std::string >& excludeList)
 
 
 
+std::future<bool> LoggingHelper::logAllPortsAsync(RTT::TaskContext* context, const std::string& loggerName, const std::vector< std::string > excludeList, bool loadTypekits)
+{
+    return Executor::getDefault().submit([this, context, loggerName, excludeList, loadTypekits]() {
+        return logAllPorts(context, loggerName, excludeList, loadTypekits);
+    });
+}
+
 bool LoggingHelper::logAllPorts(RTT::TaskContext* givenContext, const std::string& loggerName, const std::vector< std::string > excludeList, bool loadTypekits)
 {
     RTT::TaskContext* context = givenContext;
     std::string taskName = context->getName();
     
+    OROCOS_CPP_TRACE_SCOPE("LoggingHelper::logAllPorts", taskName);
+
     std::cout << "Tryingt to get Proxy for " << loggerName << std::endl;
 
     if(loadTypekits)
@@ -161,12 +195,15 @@ bool LoggingHelper::logAllPorts(RTT::TaskContext* givenContext, const std::strin
         }
         
         //ugly, but only way I see to ensure that all ports get created
-        context = RTT::corba::TaskContextProxy::Create(taskName, false);
+        context = PartialTaskContextProxy::Create(taskName, false, PartialTaskContextProxy::OUTPUT_PORTS);
+        if(!context)
+            throw std::runtime_error("Error, could not create proxy for " + taskName);
     }
     
     logger::proxies::Logger *logger;
     
     try{
+        OROCOS_CPP_TRACE_SCOPE("TaskContextProxy::Create", loggerName);
         logger = new logger::proxies::Logger(loggerName, false);
     } catch (...)
     {
@@ -218,8 +255,12 @@ bool LoggingHelper::logAllPorts(RTT::TaskContext* givenContext, const std::strin
         outPorts.push_back(outPort);
     }
 
-    logger->synchronize();
+    {
+        OROCOS_CPP_TRACE_SCOPE("LoggingHelper::synchronizeLogger", loggerName);
+        logger->synchronize();
+    }
     
+    OROCOS_CPP_TRACE_SCOPE("LoggingHelper::connectPorts", taskName);
     for(RTT::base::OutputPortInterface *outPort: outPorts)
     {
         //go save and disconnect everyone before doing the connection
@@ -232,7 +273,7 @@ bool LoggingHelper::logAllPorts(RTT::TaskContext* givenContext, const std::strin
         }
         loggerPort->disconnect();
         
-        if(!outPort->connectTo(loggerPort, RTT::ConnPolicy::buffer(DEFAULT_LOG_BUFFER_SIZE)))
+        if(!transportSelector.connect(outPort, loggerPort, taskName + "." + outPort->getName(), RTT::ConnPolicy::buffer(DEFAULT_LOG_BUFFER_SIZE)))
         {
             throw std::runtime_error("Error, could not connect port to logger");
         }
@@ -2,6 +2,8 @@
 #define LOGGINGHELPER_H
 
 #include <rtt/TaskContext.hpp>
+#include "TransportSelector.hpp"
+#include <future>
 
 namespace orocos_cpp
 {
@@ -9,9 +11,24 @@ namespace orocos_cpp
 class LoggingHelper
 {
     const int DEFAULT_LOG_BUFFER_SIZE;
+    TransportSelector transportSelector;
 public:
     LoggingHelper();
+
+    /**
+     * Returns the transport selection used to connect
+     * the ports to the logger. May be used to override
+     * the transport per port.
+     * */
+    TransportSelector &getTransportSelector();
+
     bool logAllPorts(RTT::TaskContext *context,  const std::string &loggerName, const std::vector<std::string> excludeList = std::vector<std::string>(), bool loadTypekits = true);
+
+    /**
+     * Asynchronous variant of logAllPorts, executed by Executor::getDefault().
+     * The helper and the context must stay valid until the future is ready.
+     * */
+    std::future<bool> logAllPortsAsync(RTT::TaskContext *context,  const std::string &loggerName, const std::vector<std::string> excludeList = std::vector<std::string>(), bool loadTypekits = true);
     bool logTasks(const std::map<std::string, bool> &loggingEnabledTaskMap, bool logAll);
     bool logTasks(const std::vector<std::string> &excludeList);
     bool logTasks();
@@ -1 +1,133 @@
 #include "NameService.hpp"
+#include "Executor.hpp"
+#include "Tracing.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+using namespace orocos_cpp;
+
+const size_t NameService::DEFAULT_BATCH_CONCURRENCY;
+
+std::future< RTT::TaskContext* > NameService::getTaskContextAsync(const std::string& taskName)
+{
+    return Executor::getDefault().submit([this, taskName]() {
+        return getTaskContext(taskName);
+    });
+}
+
+int NameService::watch(const WatchCallback& callback)
+{
+    throw std::runtime_error("NameService::watch : Error, this name service does not support watching");
+}
+
+void NameService::unwatch(int watchId)
+{
+}
+
+namespace
+{
+
+/**
+ * Shared by the caller of runConcurrently and the executor jobs
+ * helping it. Jobs that start after all calls were claimed return
+ * without touching func, which may be gone by then.
+ * */
+struct ConcurrentRun
+{
+    ConcurrentRun(size_t count, const std::function<void (size_t)> &func) : next(0), count(count), func(func), finished(0)
+    {
+    }
+
+    void work()
+    {
+        size_t done = 0;
+        for(size_t i = next++; i < count; i = next++)
+        {
+            func(i);
+            done++;
+        }
+
+        if(done)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished += done;
+            if(finished == count)
+                allFinished.notify_all();
+        }
+    }
+
+    std::atomic<size_t> next;
+    const size_t count;
+    const std::function<void (size_t)> &func;
+
+    std::mutex mutex;
+    std::condition_variable allFinished;
+    size_t finished;
+};
+
+}
+
+void NameService::runConcurrently(size_t count, size_t maxConcurrency, const std::function< void (size_t) >& func)
+{
+    //a thread hand over costs more than a lookup answered from a cache
+    const size_t numThreads = std::min(count, std::max<size_t>(maxConcurrency, 1));
+    if(count <= 2 || numThreads == 1)
+    {
+        for(size_t i = 0; i < count; i++)
+            func(i);
+        return;
+    }
+
+    //the calling thread works as well, so the calls finish even if
+    //all threads of the executor are busy, e.g. with our caller
+    std::shared_ptr<ConcurrentRun> run(std::make_shared<ConcurrentRun>(count, func));
+    for(size_t i = 1; i < numThreads; i++)
+        Executor::getDefault().post([run]() { run->work(); });
+    run->work();
+
+    std::unique_lock<std::mutex> lock(run->mutex);
+    run->allFinished.wait(lock, [&run]() { return run->finished == run->count; });
+}
+
+std::vector< bool > NameService::areRegistered(const std::vector< std::string >& names, size_t maxConcurrency)
+{
+    OROCOS_CPP_TRACE_SCOPE("NameService::areRegistered");
+    //std::vector<bool> may not be written concurrently
+    std::vector<char> registered(names.size(), false);
+    runConcurrently(names.size(), maxConcurrency, [this, &names, &registered](size_t i) {
+        try {
+            registered[i] = isRegistered(names[i]);
+        } catch (...)
+        {
+            registered[i] = false;
+        }
+    });
+    return std::vector<bool>(registered.begin(), registered.end());
+}
+
+std::vector< NameService::TaskLookup > NameService::getTaskContexts(const std::vector< std::string >& names, size_t maxConcurrency)
+{
+    OROCOS_CPP_TRACE_SCOPE("NameService::getTaskContexts");
+    std::vector<TaskLookup> results(names.size());
+    runConcurrently(names.size(), maxConcurrency, [this, &names, &results](size_t i) {
+        TaskLookup &result(results[i]);
+        result.taskName = names[i];
+        result.task = nullptr;
+        try {
+            result.task = getTaskContext(names[i]);
+            if(!result.task)
+                result.error = "task " + names[i] + " is not reachable";
+        } catch (const std::exception &e)
+        {
+            result.error = e.what();
+        } catch (...)
+        {
+            result.error = "unknown error while resolving " + names[i];
+        }
+    });
+    return results;
+}
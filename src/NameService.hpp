@@ -3,6 +3,8 @@
 
 #include <vector>
 #include <string>
+#include <functional>
+#include <future>
 
 namespace RTT
 {
@@ -15,6 +17,41 @@ namespace orocos_cpp
 class NameService
 {
 public:
+    static const size_t DEFAULT_BATCH_CONCURRENCY = 16;
+
+    /**
+     * Result of a batch lookup for one task
+     * */
+    struct TaskLookup
+    {
+        std::string taskName;
+        ///proxy of the task, owned by the caller. nullptr on error
+        RTT::TaskContext *task;
+        ///reason why task is nullptr
+        std::string error;
+    };
+
+    /**
+     * Change of a registration, reported to watchers
+     * */
+    struct ChangeEvent
+    {
+        enum Type
+        {
+            ADDED,
+            REMOVED,
+            ///the task was registered again, e.g. after a restart
+            IOR_CHANGED,
+        };
+
+        Type type;
+        std::string taskName;
+        ///new IOR, last known IOR for REMOVED
+        std::string ior;
+    };
+
+    typedef std::function<void (const ChangeEvent &event)> WatchCallback;
+
     virtual ~NameService() {};
     /**
      * Connect to the name service
@@ -28,6 +65,64 @@ public:
     virtual bool isRegistered(const std::string &taskName) = 0;
     
     virtual RTT::TaskContext *getTaskContext(const std::string &taskName) = 0;
+
+    /**
+     * Drops anything the name service remembers about the task,
+     * e.g. because it is about to be restarted. The next lookup
+     * asks the naming server again.
+     * */
+    virtual void invalidate(const std::string &taskName) {};
+
+    /**
+     * Batch variant of isRegistered, the names are checked concurrently
+     * by up to maxConcurrency threads.
+     * The default implementation requires a thread safe isRegistered.
+     * @return one result per name, in the order of names
+     * */
+    virtual std::vector<bool> areRegistered(const std::vector<std::string> &names, size_t maxConcurrency = DEFAULT_BATCH_CONCURRENCY);
+
+    /**
+     * Batch variant of getTaskContext, the tasks are resolved and their
+     * proxies created concurrently by up to maxConcurrency threads.
+     * Errors are reported per task, this method does not throw.
+     * The default implementation requires a thread safe getTaskContext.
+     * @return one result per name, in the order of names
+     * */
+    virtual std::vector<TaskLookup> getTaskContexts(const std::vector<std::string> &names, size_t maxConcurrency = DEFAULT_BATCH_CONCURRENCY);
+
+    /**
+     * Calls getTaskContext in Executor::getDefault(). The name
+     * service must stay valid until the future is ready, and
+     * getTaskContext must be callable from another thread.
+     * */
+    std::future<RTT::TaskContext *> getTaskContextAsync(const std::string &taskName);
+
+    /**
+     * Registers a callback for registration changes. It is called from
+     * a thread of the name service, first with an ADDED event for every
+     * registered task, then for every change. The name service needs to
+     * be connected.
+     * The default implementation throws, as not every name service
+     * supports this.
+     * @return id of the watch, for unwatch()
+     * */
+    virtual int watch(const WatchCallback &callback);
+
+    /**
+     * Removes the watch. A call of the callback that is in progress may
+     * still finish after unwatch returned.
+     * */
+    virtual void unwatch(int watchId);
+
+protected:
+    /**
+     * Calls func(0) ... func(count - 1) using up to maxConcurrency
+     * threads, the calling one and threads of Executor::getDefault().
+     * Up to two calls are made in the calling thread only. The calling
+     * thread takes part in the work, so this may be called from a job
+     * of the executor. Returns when all calls returned. func must not throw.
+     * */
+    static void runConcurrently(size_t count, size_t maxConcurrency, const std::function<void (size_t)> &func);
 };
 
 }//end of namespace
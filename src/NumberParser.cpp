@@ -0,0 +1,364 @@
+#include "NumberParser.hpp"
+#include <boost/numeric/conversion/cast.hpp>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace orocos_cpp;
+
+namespace
+{
+
+//more digits may overflow the 64 bit mantissa
+const int MAX_DIGITS = 19;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+bool isEightDigits(const char *p)
+{
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return !(((value + 0x4646464646464646ULL) | (value - 0x3030303030303030ULL)) & 0x8080808080808080ULL);
+}
+
+/**
+ * Converts eight ASCII digits in one go, by combining neighbouring
+ * digits, then pairs and then quadruples in the lanes of one integer
+ * */
+uint32_t parseEightDigits(const char *p)
+{
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    value -= 0x3030303030303030ULL;
+    value = (value * 10) + (value >> 8);
+    value = (((value & 0x000000FF000000FFULL) * 0x000F424000000064ULL)
+             + (((value >> 16) & 0x000000FF000000FFULL) * 0x0000271000000001ULL)) >> 32;
+    return static_cast<uint32_t>(value);
+}
+#else
+bool isEightDigits(const char *)
+{
+    return false;
+}
+
+uint32_t parseEightDigits(const char *)
+{
+    return 0;
+}
+#endif
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/**
+ * Appends the digits at p to mantissa, leading zeros are not counted
+ * @return false if there are too many significant digits
+ * */
+bool parseDigits(const char *&p, const char *end, uint64_t &mantissa, int &digits)
+{
+    //leading zeros do not add to the precision
+    while(!mantissa && p != end && *p == '0')
+        p++;
+
+    while(end - p >= 8 && isEightDigits(p))
+    {
+        digits += 8;
+        if(digits > MAX_DIGITS)
+            return false;
+        mantissa = mantissa * 100000000ULL + parseEightDigits(p);
+        p += 8;
+    }
+
+    while(p != end && isDigit(*p))
+    {
+        if(++digits > MAX_DIGITS)
+            return false;
+        mantissa = mantissa * 10 + (*p - '0');
+        p++;
+    }
+    return true;
+}
+
+bool parseUnsigned(const char *p, const char *end, uint64_t &dest)
+{
+    if(p == end)
+        return false;
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    if(!parseDigits(p, end, mantissa, digits) || p != end)
+        return false;
+
+    dest = mantissa;
+    return true;
+}
+
+bool parseSigned(const std::string &value, int64_t &dest)
+{
+    const char *p = value.data();
+    const char *end = p + value.size();
+    const bool negative = p != end && *p == '-';
+    if(negative)
+        p++;
+
+    uint64_t magnitude;
+    if(!parseUnsigned(p, end, magnitude))
+        return false;
+
+    const uint64_t limit = static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + (negative ? 1 : 0);
+    if(magnitude > limit)
+        return false;
+
+    dest = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+    return true;
+}
+
+template <typename T>
+bool parseSigned(const std::string &value, T &dest)
+{
+    int64_t result;
+    if(!parseSigned(value, result) || result < std::numeric_limits<T>::min() || result > std::numeric_limits<T>::max())
+        return false;
+    dest = result;
+    return true;
+}
+
+template <typename T>
+bool parseUnsigned(const std::string &value, T &dest)
+{
+    uint64_t result;
+    if(!parseUnsigned(value.data(), value.data() + value.size(), result) || result > std::numeric_limits<T>::max())
+        return false;
+    dest = result;
+    return true;
+}
+
+template <typename T>
+struct FloatLimits;
+
+/**
+ * A float computation is exact if the mantissa and the power of ten are
+ * exactly representable, the one rounding of the multiplication or
+ * division is then correct (Clinger's fast path)
+ * */
+template <>
+struct FloatLimits<double>
+{
+    static const uint64_t MAX_MANTISSA = 1ULL << 53;
+    static const int MAX_EXPONENT = 22;
+};
+
+template <>
+struct FloatLimits<float>
+{
+    static const uint64_t MAX_MANTISSA = 1ULL << 24;
+    static const int MAX_EXPONENT = 10;
+};
+
+template <typename T>
+bool parseFloat(const std::string &value, T &dest)
+{
+    static const T powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                               1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    const char *p = value.data();
+    const char *end = p + value.size();
+    const bool negative = p != end && *p == '-';
+    if(negative)
+        p++;
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    const char *start = p;
+    if(!parseDigits(p, end, mantissa, digits))
+        return false;
+    bool hasDigits = p != start;
+
+    int exponent = 0;
+    if(p != end && *p == '.')
+    {
+        p++;
+        start = p;
+        if(!parseDigits(p, end, mantissa, digits))
+            return false;
+        exponent -= p - start;
+        hasDigits = hasDigits || p != start;
+    }
+
+    if(!hasDigits)
+        return false;
+
+    if(p != end && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        const bool negativeExponent = p != end && *p == '-';
+        if(negativeExponent)
+            p++;
+        if(p == end)
+            return false;
+        int explicitExponent = 0;
+        while(p != end && isDigit(*p))
+        {
+            explicitExponent = explicitExponent * 10 + (*p - '0');
+            if(explicitExponent > 1000)
+                return false;
+            p++;
+        }
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+    }
+
+    if(p != end)
+        return false;
+
+    if(mantissa > FloatLimits<T>::MAX_MANTISSA)
+        return false;
+
+    T result = static_cast<T>(mantissa);
+    if(mantissa)
+    {
+        if(exponent < -FloatLimits<T>::MAX_EXPONENT || exponent > FloatLimits<T>::MAX_EXPONENT)
+            return false;
+        if(exponent < 0)
+            result /= powers[-exponent];
+        else
+            result *= powers[exponent];
+    }
+
+    dest = negative ? -result : result;
+    return true;
+}
+
+}
+
+bool NumberParser::parse(const std::string& value, double& dest)
+{
+    return parseFloat(value, dest);
+}
+
+bool NumberParser::parse(const std::string& value, float& dest)
+{
+    return parseFloat(value, dest);
+}
+
+bool NumberParser::parse(const std::string& value, int64_t& dest)
+{
+    return parseSigned(value, dest);
+}
+
+bool NumberParser::parse(const std::string& value, int32_t& dest)
+{
+    return parseSigned(value, dest);
+}
+
+bool NumberParser::parse(const std::string& value, int16_t& dest)
+{
+    return parseSigned(value, dest);
+}
+
+bool NumberParser::parse(const std::string& value, uint64_t& dest)
+{
+    return parseUnsigned(value.data(), value.data() + value.size(), dest);
+}
+
+bool NumberParser::parse(const std::string& value, uint32_t& dest)
+{
+    return parseUnsigned(value, dest);
+}
+
+bool NumberParser::parse(const std::string& value, uint16_t& dest)
+{
+    return parseUnsigned(value, dest);
+}
+
+namespace orocos_cpp
+{
+
+template <>
+bool parseConfigScalar<uint8_t>(const std::string &conf, uint8_t &dest, std::string &error)
+{
+    uint16_t number;
+    if(NumberParser::parse(conf, number) && number <= std::numeric_limits<uint8_t>::max())
+    {
+        dest = number;
+        return true;
+    }
+
+    try {
+        dest = boost::numeric_cast<uint8_t>(boost::lexical_cast<unsigned int>(conf));
+    } catch (const std::bad_cast &e)
+    {
+        error = e.what();
+        return false;
+    }
+    return true;
+}
+
+template <>
+bool parseConfigScalar<int8_t>(const std::string &conf, int8_t &dest, std::string &error)
+{
+    int16_t number;
+    if(NumberParser::parse(conf, number) && number >= std::numeric_limits<int8_t>::min() && number <= std::numeric_limits<int8_t>::max())
+    {
+        dest = number;
+        return true;
+    }
+
+    try {
+        dest = boost::numeric_cast<int8_t>(boost::lexical_cast<int>(conf));
+    } catch (const std::bad_cast &e)
+    {
+        error = e.what();
+        return false;
+    }
+    return true;
+}
+
+template <>
+bool parseConfigScalar<double>(const std::string &conf, double &dest, std::string &error)
+{
+    if(NumberParser::parse(conf, dest))
+        return true;
+
+    std::string copy = conf;
+    std::transform(copy.begin(), copy.end(), copy.begin(), ::tolower);
+    if(copy.find("nan") != std::string::npos)
+    {
+        dest = std::numeric_limits<double>::quiet_NaN();
+        return true;
+    }
+
+    try {
+        dest = boost::lexical_cast<double>(conf);
+    } catch (const std::bad_cast &e)
+    {
+        error = e.what();
+        return false;
+    }
+    return true;
+}
+
+template <>
+bool parseConfigScalar<bool>(const std::string &conf, bool &dest, std::string &error)
+{
+    std::string copy = conf;
+    std::transform(copy.begin(), copy.end(), copy.begin(), ::tolower);
+    if(copy == "true")
+    {
+        dest = true;
+        return true;
+    }
+    if(copy == "false")
+    {
+        dest = false;
+        return true;
+    }
+
+    int number;
+    if(!parseConfigScalar(conf, number, error))
+        return false;
+    dest = number;
+    return true;
+}
+
+}
@@ -0,0 +1,79 @@
+#ifndef NUMBERPARSER_H
+#define NUMBERPARSER_H
+
+#include <boost/lexical_cast.hpp>
+#include <string>
+#include <typeinfo>
+#include <stdint.h>
+
+namespace orocos_cpp
+{
+
+/**
+ * Exact fast paths for the decimal numbers of configuration files.
+ *
+ * Only plain numbers are accepted: an optional minus, digits, and for
+ * floating point an optional fraction and exponent. Eight digits at a
+ * time are converted with 64 bit integer arithmetic. Floating point
+ * numbers are only converted if the result is exact, i.e. if the
+ * mantissa and the power of ten are exactly representable.
+ *
+ * Everything else (whitespace, signs, hex, inf, nan, too many digits,
+ * large exponents) makes parse return false. Callers then fall back to
+ * boost::lexical_cast, so the results are the same as before.
+ * */
+class NumberParser
+{
+public:
+    static bool parse(const std::string &value, double &dest);
+    static bool parse(const std::string &value, float &dest);
+    static bool parse(const std::string &value, int64_t &dest);
+    static bool parse(const std::string &value, int32_t &dest);
+    static bool parse(const std::string &value, int16_t &dest);
+    static bool parse(const std::string &value, uint64_t &dest);
+    static bool parse(const std::string &value, uint32_t &dest);
+    static bool parse(const std::string &value, uint16_t &dest);
+
+    ///no fast path for other types
+    template <typename T>
+    static bool parse(const std::string &, T &)
+    {
+        return false;
+    }
+};
+
+/**
+ * Converts a scalar of a configuration file into a C++ number.
+ * Shared by the Typelib interpreter and the known type appliers.
+ * @return false and sets error if the value can not be represented
+ * */
+template <typename T>
+bool parseConfigScalar(const std::string &conf, T &dest, std::string &error)
+{
+    if(NumberParser::parse(conf, dest))
+        return true;
+
+    try {
+        dest = boost::lexical_cast<T>(conf);
+    } catch (const std::bad_cast &e)
+    {
+        error = e.what();
+        return false;
+    }
+    return true;
+}
+
+///parsed as number, not as character
+template <>
+bool parseConfigScalar<uint8_t>(const std::string &conf, uint8_t &dest, std::string &error);
+template <>
+bool parseConfigScalar<int8_t>(const std::string &conf, int8_t &dest, std::string &error);
+///accepts any spelling of nan
+template <>
+bool parseConfigScalar<double>(const std::string &conf, double &dest, std::string &error);
+///accepts true/false and numbers
+template <>
+bool parseConfigScalar<bool>(const std::string &conf, bool &dest, std::string &error);
+
+}//end of namespace
+#endif // NUMBERPARSER_H
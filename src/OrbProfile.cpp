@@ -0,0 +1,134 @@
+#include "OrbProfile.hpp"
+#include <rtt/transports/corba/TaskContextServer.hpp>
+#include <boost/lexical_cast.hpp>
+#include <mutex>
+#include <stdexcept>
+#include <stdlib.h>
+
+using namespace orocos_cpp;
+
+namespace
+{
+
+std::mutex defaultProfileMutex;
+
+OrbProfile &defaultProfile()
+{
+    static OrbProfile profile(OrbProfile::fromName(getenv("OROCOS_CPP_ORB_PROFILE") ? getenv("OROCOS_CPP_ORB_PROFILE") : "default"));
+    return profile;
+}
+
+void addOption(std::vector<std::string> &args, const std::string &option, const std::string &value)
+{
+    args.push_back("-ORB" + option);
+    args.push_back(value);
+}
+
+}
+
+OrbProfile::OrbProfile() : name("default"), giopMaxMsgSize(0), threadPerConnection(true), maxServerThreadPoolSize(0),
+                           oneCallPerConnection(true), maxConnectionsPerServer(0)
+{
+}
+
+OrbProfile OrbProfile::tcp()
+{
+    OrbProfile profile;
+    profile.name = "tcp";
+    profile.endPoints.push_back("giop:tcp::");
+    profile.giopMaxMsgSize = 64 * 1024 * 1024;
+    profile.threadPerConnection = false;
+    profile.maxServerThreadPoolSize = 32;
+    profile.oneCallPerConnection = false;
+    profile.maxConnectionsPerServer = 4;
+    return profile;
+}
+
+OrbProfile OrbProfile::unixSocket()
+{
+    OrbProfile profile;
+    profile.name = "unix";
+    profile.endPoints.push_back("giop:unix:");
+    profile.endPoints.push_back("giop:tcp::");
+    profile.clientTransportRules.push_back("* unix,tcp");
+    profile.giopMaxMsgSize = 64 * 1024 * 1024;
+    //few, long living connections, a dedicated thread per connection has the lowest latency
+    profile.threadPerConnection = true;
+    profile.maxServerThreadPoolSize = 100;
+    profile.oneCallPerConnection = false;
+    profile.maxConnectionsPerServer = 4;
+    return profile;
+}
+
+OrbProfile OrbProfile::fromName(const std::string& name)
+{
+    if(name.empty() || name == "default")
+        return OrbProfile();
+    if(name == "tcp")
+        return tcp();
+    if(name == "unix")
+        return unixSocket();
+
+    throw std::runtime_error("OrbProfile::Error, unknown profile '" + name + "', known profiles are default, tcp and unix");
+}
+
+OrbProfile OrbProfile::getDefault()
+{
+    std::lock_guard<std::mutex> lock(defaultProfileMutex);
+    return defaultProfile();
+}
+
+void OrbProfile::setDefault(const OrbProfile& profile)
+{
+    std::lock_guard<std::mutex> lock(defaultProfileMutex);
+    defaultProfile() = profile;
+}
+
+std::vector< std::string > OrbProfile::getArguments() const
+{
+    std::vector<std::string> args;
+    for(const std::string &endPoint: endPoints)
+        addOption(args, "endPoint", endPoint);
+
+    for(const std::string &rule: clientTransportRules)
+        addOption(args, "clientTransportRule", rule);
+
+    if(giopMaxMsgSize)
+        addOption(args, "giopMaxMsgSize", boost::lexical_cast<std::string>(giopMaxMsgSize));
+
+    if(!threadPerConnection)
+        addOption(args, "threadPerConnectionPolicy", "0");
+
+    if(maxServerThreadPoolSize)
+        addOption(args, "maxServerThreadPoolSize", boost::lexical_cast<std::string>(maxServerThreadPoolSize));
+
+    if(!oneCallPerConnection)
+        addOption(args, "oneCallPerConnection", "0");
+
+    if(maxConnectionsPerServer)
+        addOption(args, "maxGIOPConnectionPerServer", boost::lexical_cast<std::string>(maxConnectionsPerServer));
+
+    return args;
+}
+
+int OrbProfile::getArgv(std::vector<std::string>& args, std::vector<char *>& argv) const
+{
+    args = getArguments();
+    args.insert(args.begin(), "orocos_cpp");
+
+    argv.clear();
+    for(std::string &arg: args)
+        argv.push_back(const_cast<char *>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    return args.size();
+}
+
+bool OrbProfile::initRTTOrb() const
+{
+    std::vector<std::string> args;
+    std::vector<char *> argv;
+    const int argc = getArgv(args, argv);
+
+    return RTT::corba::TaskContextServer::InitOrb(argc, argv.data());
+}
@@ -0,0 +1,100 @@
+#ifndef ORBPROFILE_H
+#define ORBPROFILE_H
+
+#include <string>
+#include <vector>
+
+namespace orocos_cpp
+{
+
+/**
+ * Set of omniORB options, used for the local ORB and
+ * passed to spawned deployments.
+ *
+ * Note, there is only one ORB per process. The options take
+ * effect in the first call that initializes the ORB, so the
+ * default profile must be set before any name service is
+ * connected.
+ * */
+class OrbProfile
+{
+public:
+    /**
+     * Profile without any options, omniORB defaults are used.
+     * */
+    OrbProfile();
+
+    /**
+     * TCP endpoints, larger GIOP messages and a shared thread pool.
+     * */
+    static OrbProfile tcp();
+
+    /**
+     * Profile for systems running on a single host. Additionally to
+     * TCP, the ORB listens on a unix socket and clients prefer unix
+     * sockets over TCP, so calls between local processes bypass the
+     * TCP loopback. Remote clients still connect using TCP.
+     * */
+    static OrbProfile unixSocket();
+
+    /**
+     * Returns the profile with the given name, one of
+     * "default", "tcp" or "unix". Throws on unknown names.
+     * */
+    static OrbProfile fromName(const std::string &name);
+
+    /**
+     * Returns the profile used by CorbaNameService, FileNameService and
+     * the Spawner. Initially selected by the environment variable
+     * OROCOS_CPP_ORB_PROFILE, "default" if not set.
+     * */
+    static OrbProfile getDefault();
+    static void setDefault(const OrbProfile &profile);
+
+    /**
+     * Returns the options in the form of omniORB
+     * command line arguments, e.g. "-ORBendPoint giop:unix:"
+     * */
+    std::vector<std::string> getArguments() const;
+
+    /**
+     * Builds a command line for ORB_init from getArguments(), with the
+     * program name "orocos_cpp" in front and a terminating null pointer.
+     * The pointers in argv point into args, which must outlive argv.
+     * @return argc
+     * */
+    int getArgv(std::vector<std::string> &args, std::vector<char *> &argv) const;
+
+    /**
+     * Initializes the ORB of RTT using this profile.
+     * @return false if the ORB was already initialized
+     * */
+    bool initRTTOrb() const;
+
+    ///name of the profile, for display only
+    std::string name;
+
+    ///server endpoints, e.g. "giop:tcp::" or "giop:unix:"
+    std::vector<std::string> endPoints;
+
+    ///client transport rules, e.g. "* unix,tcp"
+    std::vector<std::string> clientTransportRules;
+
+    ///maximum size of a GIOP message in bytes, 0 for the omniORB default (2 MB)
+    size_t giopMaxMsgSize;
+
+    ///if false, incoming calls are served by a thread pool instead of one thread per connection
+    bool threadPerConnection;
+
+    ///maximum number of threads serving calls, 0 for the omniORB default
+    unsigned int maxServerThreadPoolSize;
+
+    ///if false, concurrent calls to the same server share a connection
+    bool oneCallPerConnection;
+
+    ///maximum number of connections to one server, 0 for the omniORB default
+    unsigned int maxConnectionsPerServer;
+};
+
+}//end of namespace
+#endif // ORBPROFILE_H
@@ -0,0 +1,392 @@
+#include "OutputCollector.hpp"
+#include <base/Time.hpp>
+#include <boost/lexical_cast.hpp>
+#include <iostream>
+#include <stdexcept>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <zlib.h>
+
+using namespace orocos_cpp;
+
+namespace
+{
+
+//lines longer than this are written in pieces
+const size_t MAX_LINE_LENGTH = 4096;
+
+}
+
+struct OutputCollector::Stream
+{
+    int fd;
+    const char *tag;
+    ///shared with processes, a replaced process lives until its streams are closed
+    std::shared_ptr<Process> process;
+    std::string partialLine;
+};
+
+struct OutputCollector::Process
+{
+    Process(size_t tailSize) : file(nullptr), gzipFile(nullptr), fileSize(0), openStreams(2), tail(tailSize) {}
+    ~Process()
+    {
+        if(file)
+            fclose(file);
+        if(gzipFile)
+            gzclose(gzipFile);
+    }
+
+    ///guards everything below
+    std::mutex mutex;
+    std::string name;
+    std::string fileName;
+    FILE *file;
+    gzFile gzipFile;
+    size_t fileSize;
+    int openStreams;
+    boost::circular_buffer<char> tail;
+};
+
+OutputCollector::OutputCollector() : maxFileSize(10 * 1024 * 1024), maxFiles(5), compress(false), tailSize(16 * 1024)
+{
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeupFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if(epollFd < 0 || wakeupFd < 0)
+        throw std::runtime_error(std::string("OutputCollector::Error, could not create epoll instance : ") + strerror(errno));
+
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = wakeupFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeupFd, &event);
+
+    //the thread is started by the first addProcess
+}
+
+OutputCollector::~OutputCollector()
+{
+    if(thread.joinable())
+    {
+        uint64_t stop = 1;
+        if(write(wakeupFd, &stop, sizeof(stop)) != sizeof(stop))
+            std::cout << "OutputCollector: Error, could not stop collector thread" << std::endl;
+        thread.join();
+    }
+
+    //the files are closed with the last reference to their process
+    for(std::pair<const int, Stream *> &s: streams)
+    {
+        close(s.first);
+        delete s.second;
+    }
+    processes.clear();
+
+    close(wakeupFd);
+    close(epollFd);
+}
+
+void OutputCollector::setMaxFileSize(size_t size)
+{
+    maxFileSize = size;
+}
+
+void OutputCollector::setMaxFiles(size_t count)
+{
+    maxFiles = count;
+}
+
+void OutputCollector::setCompression(bool compressFiles)
+{
+    compress = compressFiles;
+}
+
+void OutputCollector::setTailSize(size_t size)
+{
+    tailSize = size;
+}
+
+size_t OutputCollector::getTailSize() const
+{
+    return tailSize;
+}
+
+bool OutputCollector::createPipes(int stdoutPipe[2], int stderrPipe[2])
+{
+    if(pipe2(stdoutPipe, O_CLOEXEC))
+        return false;
+
+    if(pipe2(stderrPipe, O_CLOEXEC))
+    {
+        close(stdoutPipe[0]);
+        close(stdoutPipe[1]);
+        return false;
+    }
+    return true;
+}
+
+void OutputCollector::closePipes(int stdoutPipe[2], int stderrPipe[2])
+{
+    for(int i = 0; i < 2; i++)
+    {
+        close(stdoutPipe[i]);
+        close(stderrPipe[i]);
+    }
+}
+
+bool OutputCollector::redirectIntoPipes(int stdoutPipe[2], int stderrPipe[2])
+{
+    //the child outlives the read ends if the spawner exits, its writes
+    //then fail with EPIPE instead of killing it with SIGPIPE.
+    //The ignored disposition is kept across exec
+    struct sigaction ignore;
+    memset(&ignore, 0, sizeof(ignore));
+    ignore.sa_handler = SIG_IGN;
+    sigemptyset(&ignore.sa_mask);
+    sigaction(SIGPIPE, &ignore, nullptr);
+
+    //dup2 clears the close on exec flag of the new descriptor.
+    //Only async signal safe calls, this runs between fork and exec
+    if(dup2(stdoutPipe[1], STDOUT_FILENO) == -1)
+        return false;
+    if(dup2(stderrPipe[1], STDERR_FILENO) == -1)
+        return false;
+    return true;
+}
+
+void OutputCollector::addProcess(const std::string& name, const std::string& fileName, int stdoutPipe[2], int stderrPipe[2])
+{
+    close(stdoutPipe[1]);
+    close(stderrPipe[1]);
+
+    std::shared_ptr<Process> process(std::make_shared<Process>(tailSize));
+    process->name = name;
+    process->fileName = fileName;
+    if(!openFile(*process))
+        std::cout << "OutputCollector: Error, could not open " << fileName << ", only keeping the tail of " << name << std::endl;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    //a previous instance with the same name is kept by its streams
+    processes[name] = process;
+
+    const char *tags[] = {"out", "err"};
+    int fds[] = {stdoutPipe[0], stderrPipe[0]};
+    for(int i = 0; i < 2; i++)
+    {
+        Stream *stream = new Stream();
+        stream->fd = fds[i];
+        stream->tag = tags[i];
+        stream->process = process;
+        streams[fds[i]] = stream;
+
+        fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.fd = fds[i];
+        if(epoll_ctl(epollFd, EPOLL_CTL_ADD, fds[i], &event))
+            std::cout << "OutputCollector: Error, could not watch output of " << name << " : " << strerror(errno) << std::endl;
+    }
+
+    //started on demand, spawners without redirected output need no thread
+    if(!thread.joinable())
+        thread = std::thread(&OutputCollector::run, this);
+}
+
+std::string OutputCollector::getTail(const std::string& name) const
+{
+    std::shared_ptr<Process> process;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = processes.find(name);
+        if(it == processes.end())
+            return std::string();
+        process = it->second;
+    }
+
+    std::lock_guard<std::mutex> lock(process->mutex);
+    return std::string(process->tail.begin(), process->tail.end());
+}
+
+std::string OutputCollector::getFileName(const OutputCollector::Process& process, size_t index) const
+{
+    std::string name = process.fileName;
+    if(index)
+        name += "." + boost::lexical_cast<std::string>(index);
+    if(compress)
+        name += ".gz";
+    return name;
+}
+
+bool OutputCollector::openFile(OutputCollector::Process& process)
+{
+    process.fileSize = 0;
+    if(compress)
+    {
+        //fast compression, the collector thread serves all processes
+        process.gzipFile = gzopen(getFileName(process, 0).c_str(), "wb1");
+        return process.gzipFile != nullptr;
+    }
+
+    process.file = fopen(getFileName(process, 0).c_str(), "we");
+    if(process.file)
+        setvbuf(process.file, nullptr, _IOFBF, 64 * 1024);
+    return process.file != nullptr;
+}
+
+void OutputCollector::closeFile(OutputCollector::Process& process)
+{
+    if(process.file)
+        fclose(process.file);
+    if(process.gzipFile)
+        gzclose(process.gzipFile);
+    process.file = nullptr;
+    process.gzipFile = nullptr;
+}
+
+void OutputCollector::rotate(OutputCollector::Process& process)
+{
+    closeFile(process);
+
+    if(maxFiles)
+    {
+        for(size_t i = maxFiles; i > 1; i--)
+            rename(getFileName(process, i - 1).c_str(), getFileName(process, i).c_str());
+        rename(getFileName(process, 0).c_str(), getFileName(process, 1).c_str());
+    }
+
+    openFile(process);
+}
+
+void OutputCollector::writeLine(OutputCollector::Process& process, const char* tag, const char* data, size_t size)
+{
+    base::Time now = base::Time::now();
+    char prefix[64];
+    int prefixSize = snprintf(prefix, sizeof(prefix), "%lld.%06lld [%s] ",
+                              static_cast<long long>(now.toMicroseconds() / 1000000), static_cast<long long>(now.toMicroseconds() % 1000000), tag);
+
+    process.tail.insert(process.tail.end(), data, data + size);
+    process.tail.push_back('\n');
+
+    if(process.file)
+    {
+        fwrite(prefix, 1, prefixSize, process.file);
+        fwrite(data, 1, size, process.file);
+        fputc('\n', process.file);
+    }
+    else if(process.gzipFile)
+    {
+        gzwrite(process.gzipFile, prefix, prefixSize);
+        gzwrite(process.gzipFile, data, size);
+        gzputc(process.gzipFile, '\n');
+    }
+    else
+        return;
+
+    process.fileSize += prefixSize + size + 1;
+    if(process.fileSize >= maxFileSize)
+        rotate(process);
+}
+
+void OutputCollector::handleInput(OutputCollector::Stream& stream)
+{
+    //one read per event, epoll is level triggered and reports the
+    //rest again, after the other streams were served
+    char buffer[64 * 1024];
+    ssize_t len = read(stream.fd, buffer, sizeof(buffer));
+    if(len < 0 && (errno == EAGAIN || errno == EINTR))
+        return;
+
+    Process &process(*stream.process);
+    std::unique_lock<std::mutex> processLock(process.mutex);
+    if(len > 0)
+    {
+        const char *start = buffer;
+        const char *end = buffer + len;
+        while(start < end)
+        {
+            const char *newLine = static_cast<const char *>(memchr(start, '\n', end - start));
+            if(!newLine)
+            {
+                stream.partialLine.append(start, end);
+                if(stream.partialLine.size() >= MAX_LINE_LENGTH)
+                {
+                    writeLine(process, stream.tag, stream.partialLine.data(), stream.partialLine.size());
+                    stream.partialLine.clear();
+                }
+                break;
+            }
+
+            if(stream.partialLine.empty())
+                writeLine(process, stream.tag, start, newLine - start);
+            else
+            {
+                stream.partialLine.append(start, newLine);
+                writeLine(process, stream.tag, stream.partialLine.data(), stream.partialLine.size());
+                stream.partialLine.clear();
+            }
+            start = newLine + 1;
+        }
+
+        //make the output visible, gzip files are only flushed on close, as flushing degrades the compression
+        if(process.file)
+            fflush(process.file);
+        return;
+    }
+
+    //end of file, the child closed the stream or terminated
+    if(!stream.partialLine.empty())
+        writeLine(process, stream.tag, stream.partialLine.data(), stream.partialLine.size());
+    if(--process.openStreams == 0)
+        closeFile(process);
+    processLock.unlock();
+
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, stream.fd, nullptr);
+    close(stream.fd);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    streams.erase(stream.fd);
+    delete &stream;
+}
+
+void OutputCollector::run()
+{
+    const int maxEvents = 64;
+    epoll_event events[maxEvents];
+
+    while(true)
+    {
+        int count = epoll_wait(epollFd, events, maxEvents, -1);
+        if(count < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            std::cout << "OutputCollector: Error, epoll_wait failed : " << strerror(errno) << std::endl;
+            return;
+        }
+
+        for(int i = 0; i < count; i++)
+        {
+            if(events[i].data.fd == wakeupFd)
+                return;
+
+            //streams are only removed by this thread, the
+            //stream stays valid after the lock is released
+            Stream *stream = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = streams.find(events[i].data.fd);
+                if(it != streams.end())
+                    stream = it->second;
+            }
+            if(stream)
+                handleInput(*stream);
+        }
+    }
+}
@@ -0,0 +1,128 @@
+#ifndef OUTPUTCOLLECTOR_H
+#define OUTPUTCOLLECTOR_H
+
+#include <boost/circular_buffer.hpp>
+#include <sys/types.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace orocos_cpp
+{
+
+/**
+ * Collects stdout and stderr of spawned processes.
+ *
+ * The children write into pipes, so output never blocks on disk
+ * I/O in their (possibly real time) threads. A single thread drains
+ * all pipes using epoll and writes every line, prefixed with a
+ * timestamp and the stream tag, into a log file per process.
+ *
+ * Log files are rotated by size and may be gzip compressed. The
+ * last getTailSize() bytes of each process are kept in memory,
+ * see getTail(). The thread is started when the first process is added.
+ *
+ * Each readiness event is served by a single read, so a process
+ * writing a lot can not starve the others. Files and tails are guarded
+ * per process, adding processes and querying tails do not wait for
+ * file I/O of other processes.
+ *
+ * Note, the read ends of the pipes belong to the collecting process.
+ * If it exits, the output of the children is lost. The children
+ * ignore SIGPIPE, so that they keep running, their writes fail
+ * with EPIPE.
+ * */
+class OutputCollector
+{
+public:
+    OutputCollector();
+    ~OutputCollector();
+
+    /**
+     * Size in bytes after which the log file is rotated. The size
+     * is counted before compression. Default is 10 MB.
+     * */
+    void setMaxFileSize(size_t size);
+
+    /**
+     * Number of rotated files kept besides the current one. Default is 5.
+     * */
+    void setMaxFiles(size_t count);
+
+    /**
+     * If set, the log files are written gzip compressed, with the ending .gz
+     * */
+    void setCompression(bool compress);
+
+    /**
+     * Size of the in memory tail per process. Default is 16 KB.
+     * Only affects processes added afterwards.
+     * */
+    void setTailSize(size_t size);
+    size_t getTailSize() const;
+
+    /**
+     * Creates the pipes for a new child. Must be called before fork.
+     * The read ends are close on exec.
+     * @return false on error
+     * */
+    static bool createPipes(int stdoutPipe[2], int stderrPipe[2]);
+
+    /**
+     * Closes all four ends of the pipes, if the child could not be created.
+     * */
+    static void closePipes(int stdoutPipe[2], int stderrPipe[2]);
+
+    /**
+     * Redirects stdout and stderr into the write ends of the pipes and
+     * ignores SIGPIPE. Must be called in the child after fork, is async
+     * signal safe.
+     * */
+    static bool redirectIntoPipes(int stdoutPipe[2], int stderrPipe[2]);
+
+    /**
+     * Starts collecting the output of a child. Must be called in the
+     * parent after fork. Closes the write ends of the pipes.
+     * @param name The name under which the tail can be queried
+     * @param fileName The log file, without compression ending
+     * */
+    void addProcess(const std::string &name, const std::string &fileName, int stdoutPipe[2], int stderrPipe[2]);
+
+    /**
+     * Returns the last output of the given process.
+     * */
+    std::string getTail(const std::string &name) const;
+
+private:
+    struct Stream;
+    struct Process;
+
+    void run();
+    void handleInput(Stream &stream);
+    void writeLine(Process &process, const char *tag, const char *data, size_t size);
+    bool openFile(Process &process);
+    void closeFile(Process &process);
+    void rotate(Process &process);
+    std::string getFileName(const Process &process, size_t index) const;
+
+    ///guards processes and streams, the processes have their own mutex
+    mutable std::mutex mutex;
+    std::map<std::string, std::shared_ptr<Process> > processes;
+    ///only removed by the collector thread
+    std::map<int, Stream *> streams;
+
+    std::atomic<size_t> maxFileSize;
+    std::atomic<size_t> maxFiles;
+    std::atomic<bool> compress;
+    std::atomic<size_t> tailSize;
+
+    int epollFd;
+    int wakeupFd;
+    std::thread thread;
+};
+
+}//end of namespace
+#endif // OUTPUTCOLLECTOR_H
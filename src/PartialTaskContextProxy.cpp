@@ -0,0 +1,270 @@
+#include "PartialTaskContextProxy.hpp"
+#include "Tracing.hpp"
+#include <rtt/transports/corba/ApplicationServer.hpp>
+#include <rtt/transports/corba/CorbaOperationCallerFactory.hpp>
+#include <rtt/transports/corba/CorbaTypeTransporter.hpp>
+#include <rtt/transports/corba/RemotePorts.hpp>
+#include <rtt/transports/corba/TaskContextProxy.hpp>
+#include <rtt/types/TypeInfoRepository.hpp>
+#include <iostream>
+#include <stdexcept>
+
+using namespace orocos_cpp;
+
+PartialTaskContextProxy::PartialTaskContextProxy(const std::string& name, RTT::corba::CTaskContext_ptr task) :
+    RTT::TaskContext(name), mtask(RTT::corba::CTaskContext::_duplicate(task))
+{
+    dataFlow = mtask->ports();
+    service = mtask->getProvider("this");
+}
+
+PartialTaskContextProxy::~PartialTaskContextProxy()
+{
+    for(RTT::base::PortInterface *port: portProxies)
+    {
+        ports()->removePort(port->getName());
+        delete port;
+    }
+}
+
+PartialTaskContextProxy* PartialTaskContextProxy::Create(const std::string& name, bool is_ior, int elements)
+{
+    OROCOS_CPP_TRACE_SCOPE("PartialTaskContextProxy::Create", name);
+
+    CORBA::ORB_var orb = RTT::corba::ApplicationServer::orb;
+    if(CORBA::is_nil(orb))
+        throw std::runtime_error("PartialTaskContextProxy::Error, the CORBA ORB is not initialized");
+
+    PartialTaskContextProxy *proxy = nullptr;
+    try {
+        CORBA::Object_var object;
+        if(is_ior)
+        {
+            object = orb->string_to_object(name.c_str());
+        }
+        else
+        {
+            CORBA::Object_var rootObj = orb->resolve_initial_references("NameService");
+            CosNaming::NamingContext_var rootContext = CosNaming::NamingContext::_narrow(rootObj);
+            if(CORBA::is_nil(rootContext))
+                return nullptr;
+
+            CosNaming::Name serverName;
+            serverName.length(2);
+            serverName[0].id = CORBA::string_dup("TaskContexts");
+            serverName[1].id = CORBA::string_dup(name.c_str());
+            object = rootContext->resolve(serverName);
+        }
+
+        RTT::corba::CTaskContext_var task = RTT::corba::CTaskContext::_narrow(object.in());
+        if(CORBA::is_nil(task))
+            return nullptr;
+
+        //also verifies that the task is alive
+        CORBA::String_var taskName = task->getName();
+        proxy = new PartialTaskContextProxy(taskName.in(), task.in());
+    } catch (...)
+    {
+        delete proxy;
+        return nullptr;
+    }
+
+    try {
+        proxy->fetch(elements);
+    } catch (...)
+    {
+        delete proxy;
+        return nullptr;
+    }
+    return proxy;
+}
+
+bool PartialTaskContextProxy::isProxy(const RTT::TaskContext* task)
+{
+    return dynamic_cast<const PartialTaskContextProxy *>(task) || dynamic_cast<const RTT::corba::TaskContextProxy *>(task);
+}
+
+RTT::base::PortInterface* PartialTaskContextProxy::createPort(const std::string& name, RTT::corba::CPortType type, const std::string& typeName)
+{
+    const RTT::types::TypeInfo *typeInfo = RTT::types::TypeInfoRepository::Instance()->type(typeName);
+    if(!typeInfo || !typeInfo->getProtocol(ORO_CORBA_PROTOCOL_ID))
+    {
+        std::cout << "PartialTaskContextProxy: Warning, port " << getName() << "." << name << " has type " << typeName
+                  << " which has no CORBA transport, ignoring it" << std::endl;
+        return nullptr;
+    }
+
+    RTT::base::PortInterface *port;
+    if(type == RTT::corba::CInput)
+        port = new RTT::corba::RemoteInputPort(typeInfo, dataFlow.in(), name, RTT::corba::TaskContextProxy::ProxyPOA());
+    else
+        port = new RTT::corba::RemoteOutputPort(typeInfo, dataFlow.in(), name, RTT::corba::TaskContextProxy::ProxyPOA());
+
+    ports()->addPort(*port);
+    portProxies.push_back(port);
+    return port;
+}
+
+RTT::base::PropertyBase* PartialTaskContextProxy::createProperty(const std::string& name, const std::string& description)
+{
+    CORBA::String_var typeName = service->getPropertyTypeName(name.c_str());
+    const RTT::types::TypeInfo *typeInfo = RTT::types::TypeInfoRepository::Instance()->type(typeName.in());
+    RTT::corba::CorbaTypeTransporter *transport = nullptr;
+    if(typeInfo)
+        transport = dynamic_cast<RTT::corba::CorbaTypeTransporter *>(typeInfo->getProtocol(ORO_CORBA_PROTOCOL_ID));
+
+    if(!transport)
+    {
+        std::cout << "PartialTaskContextProxy: Warning, property " << getName() << "." << name << " has type " << typeName.in()
+                  << " which has no CORBA transport, ignoring it" << std::endl;
+        return nullptr;
+    }
+
+    RTT::base::DataSourceBase::shared_ptr ds = transport->createPropertyDataSource(service.in(), name);
+    RTT::base::PropertyBase *property = typeInfo->buildProperty(name, description, ds);
+    if(property)
+        properties()->ownProperty(property);
+    return property;
+}
+
+RTT::base::PortInterface* PartialTaskContextProxy::fetchPort(const std::string& name)
+{
+    RTT::base::PortInterface *port = ports()->getPort(name);
+    if(port)
+        return port;
+
+    OROCOS_CPP_TRACE_SCOPE("PartialTaskContextProxy::fetchPort", name);
+    try {
+        RTT::corba::CPortType type = dataFlow->getPortType(name.c_str());
+        CORBA::String_var typeName = dataFlow->getDataType(name.c_str());
+        return createPort(name, type, typeName.in());
+    } catch (...)
+    {
+        return nullptr;
+    }
+}
+
+RTT::base::PropertyBase* PartialTaskContextProxy::fetchProperty(const std::string& name)
+{
+    RTT::base::PropertyBase *property = getProperty(name);
+    if(property)
+        return property;
+
+    OROCOS_CPP_TRACE_SCOPE("PartialTaskContextProxy::fetchProperty", name);
+    try {
+        if(!service->hasProperty(name.c_str()))
+            return nullptr;
+        //the description is only available through the property list
+        return createProperty(name, std::string());
+    } catch (...)
+    {
+        return nullptr;
+    }
+}
+
+RTT::OperationInterfacePart* PartialTaskContextProxy::fetchOperation(const std::string& name)
+{
+    if(provides()->hasOperation(name))
+        return provides()->getPart(name);
+
+    OROCOS_CPP_TRACE_SCOPE("PartialTaskContextProxy::fetchOperation", name);
+    try {
+        //throws if there is no such operation
+        CORBA::String_var resultType = service->getResultType(name.c_str());
+    } catch (...)
+    {
+        return nullptr;
+    }
+
+    provides()->add(name, new RTT::corba::CorbaOperationCallerFactory(name, service.in(), RTT::corba::TaskContextProxy::ProxyPOA()));
+    return provides()->getPart(name);
+}
+
+void PartialTaskContextProxy::fetch(int elements)
+{
+    OROCOS_CPP_TRACE_SCOPE("PartialTaskContextProxy::fetch", getName());
+
+    if(elements & PORTS)
+    {
+        RTT::corba::CDataFlowInterface::CPortDescriptions_var descriptions = dataFlow->getPortDescriptions();
+        for(CORBA::ULong i = 0; i < descriptions->length(); i++)
+        {
+            const RTT::corba::CPortDescription &description(descriptions[i]);
+            bool wanted = (description.type == RTT::corba::CInput) ? (elements & INPUT_PORTS) : (elements & OUTPUT_PORTS);
+            if(wanted && !ports()->getPort(description.name.in()))
+                createPort(description.name.in(), description.type, description.type_name.in());
+        }
+    }
+
+    if(elements & PROPERTIES)
+    {
+        RTT::corba::CConfigurationInterface::CPropertyNames_var names = service->getPropertyList();
+        for(CORBA::ULong i = 0; i < names->length(); i++)
+        {
+            if(!getProperty(names[i].name.in()))
+                createProperty(names[i].name.in(), names[i].description.in());
+        }
+    }
+
+    if(elements & OPERATIONS)
+    {
+        RTT::corba::COperationInterface::COperationList_var operations = service->getOperations();
+        for(CORBA::ULong i = 0; i < operations->length(); i++)
+        {
+            std::string name(operations[i].in());
+            if(!provides()->hasOperation(name))
+                provides()->add(name, new RTT::corba::CorbaOperationCallerFactory(name, service.in(), RTT::corba::TaskContextProxy::ProxyPOA()));
+        }
+    }
+}
+
+std::string PartialTaskContextProxy::getModelName()
+{
+    //call it directly, this needs neither the operation proxy nor the string typekit
+    RTT::corba::CAnyArguments args;
+    CORBA::Any_var result = service->callOperation("getModelName", args);
+    const char *modelName = nullptr;
+    if(!(result.in() >>= modelName) || !modelName)
+        throw std::runtime_error("PartialTaskContextProxy::Error, getModelName of " + getName() + " did not return a string");
+    return modelName;
+}
+
+bool PartialTaskContextProxy::configure()
+{
+    return mtask->configure();
+}
+
+bool PartialTaskContextProxy::start()
+{
+    return mtask->start();
+}
+
+bool PartialTaskContextProxy::stop()
+{
+    return mtask->stop();
+}
+
+bool PartialTaskContextProxy::cleanup()
+{
+    return mtask->cleanup();
+}
+
+bool PartialTaskContextProxy::isConfigured() const
+{
+    return mtask->isConfigured();
+}
+
+bool PartialTaskContextProxy::isRunning() const
+{
+    return mtask->isRunning();
+}
+
+RTT::TaskContext::TaskState PartialTaskContextProxy::getTaskState() const
+{
+    return TaskState(mtask->getTaskState());
+}
+
+RTT::corba::CTaskContext_ptr PartialTaskContextProxy::server() const
+{
+    return mtask.in();
+}
@@ -0,0 +1,108 @@
+#ifndef PARTIALTASKCONTEXTPROXY_H
+#define PARTIALTASKCONTEXTPROXY_H
+
+#include <rtt/TaskContext.hpp>
+#include <rtt/transports/corba/TaskContextC.h>
+#include <vector>
+
+namespace orocos_cpp
+{
+
+/**
+ * Proxy of a remote task, that only mirrors the interface
+ * elements that are actually used.
+ *
+ * RTT::corba::TaskContextProxy::Create fetches and builds proxies
+ * for all ports, properties, attributes, operations and peers of
+ * a task, which costs several round trips per element. This proxy
+ * starts empty, elements are fetched by category on creation, or
+ * one by one using the fetch methods.
+ *
+ * The lifecycle operations (configure, start, ...) are forwarded
+ * to the remote task.
+ * */
+class PartialTaskContextProxy : public RTT::TaskContext
+{
+public:
+    enum Elements
+    {
+        NONE = 0,
+        OUTPUT_PORTS = 1,
+        INPUT_PORTS = 2,
+        PORTS = OUTPUT_PORTS | INPUT_PORTS,
+        PROPERTIES = 4,
+        OPERATIONS = 8,
+        ALL = PORTS | PROPERTIES | OPERATIONS,
+    };
+
+    /**
+     * Creates a proxy of the given task. The CORBA ORB must be initialized.
+     *
+     * @param name The name of the task at the CORBA naming service, or its IOR
+     * @param is_ior True if name is an IOR
+     * @param elements Bitmask of Elements, that are fetched right away
+     * @return The proxy, or nullptr if the task is not reachable
+     * */
+    static PartialTaskContextProxy *Create(const std::string &name, bool is_ior, int elements = NONE);
+
+    /**
+     * Returns true if the given task is a proxy of a remote task,
+     * either a PartialTaskContextProxy or a RTT::corba::TaskContextProxy
+     * */
+    static bool isProxy(const RTT::TaskContext *task);
+
+    virtual ~PartialTaskContextProxy();
+
+    /**
+     * Returns the port with the given name, fetching it if not done yet.
+     * @return nullptr if the remote task has no such port, or its type is unknown
+     * */
+    RTT::base::PortInterface *fetchPort(const std::string &name);
+
+    /**
+     * Returns the property with the given name, fetching it if not done yet.
+     * @return nullptr if the remote task has no such property, or its type is unknown
+     * */
+    RTT::base::PropertyBase *fetchProperty(const std::string &name);
+
+    /**
+     * Returns the operation with the given name, fetching it if not done yet.
+     * @return nullptr if the remote task has no such operation
+     * */
+    RTT::OperationInterfacePart *fetchOperation(const std::string &name);
+
+    /**
+     * Fetches all elements of the given categories, see Elements
+     * */
+    void fetch(int elements);
+
+    /**
+     * Calls the operation getModelName of the remote task.
+     * */
+    std::string getModelName();
+
+    virtual bool configure();
+    virtual bool start();
+    virtual bool stop();
+    virtual bool cleanup();
+    virtual bool isConfigured() const;
+    virtual bool isRunning() const;
+    virtual TaskState getTaskState() const;
+
+    RTT::corba::CTaskContext_ptr server() const;
+
+private:
+    PartialTaskContextProxy(const std::string &name, RTT::corba::CTaskContext_ptr task);
+
+    RTT::base::PortInterface *createPort(const std::string &name, RTT::corba::CPortType type, const std::string &typeName);
+    RTT::base::PropertyBase *createProperty(const std::string &name, const std::string &description);
+
+    std::vector<RTT::base::PortInterface *> portProxies;
+
+    RTT::corba::CTaskContext_var mtask;
+    RTT::corba::CDataFlowInterface_var dataFlow;
+    RTT::corba::CService_var service;
+};
+
+}//end of namespace
+#endif // PARTIALTASKCONTEXTPROXY_H
@@ -3,6 +3,7 @@
 #include <boost/filesystem.hpp>
 #include <boost/tokenizer.hpp>
 #include <fstream>
+#include "Tracing.hpp"
 
 using namespace orocos_cpp;
 
@@ -18,6 +19,8 @@ bool PkgConfigHelper::solveString(std::string &input, const std::string &replace
 
 bool PkgConfigHelper::parsePkgConfig(const std::string& pkgConfigFileName, const std::vector< std::string > &searchedFields, std::vector< std::string > &result)
 {
+    OROCOS_CPP_TRACE_SCOPE("PkgConfigHelper::parsePkgConfig", pkgConfigFileName);
+
     const char *pkgConfigPath = getenv("PKG_CONFIG_PATH");
     if(!pkgConfigPath)
     {
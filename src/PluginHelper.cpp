@@ -7,48 +7,73 @@
 #include <rtt/plugin/PluginLoader.hpp>
 #include <base/Time.hpp>
 #include "PkgConfigHelper.hpp"
+#include "TypekitManifest.hpp"
+#include "ConcurrentMap.hpp"
+#include "Tracing.hpp"
 #include <iostream>
+#include <mutex>
 
 #define xstr(s) str(s)
 #define str(s) #s
 
 using namespace orocos_cpp;
 
+namespace
+{
+
+/**
+ * Serializes the loading of typekits, they may be loaded by the
+ * TypekitManifest preload thread and the application at the same time
+ * */
+std::mutex &getLoadMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+}
+
 std::vector< std::string > PluginHelper::getNeededTypekits(const std::string& componentName)
 {
     /**
-     * Cache for the needed typekits.
+     * Cache for the needed typekits, shared by all threads.
      */
-    static std::map<std::string, std::vector<std::string> > componentToTypeKitsMap;
+    static ConcurrentMap<std::string, std::vector<std::string> > componentToTypeKitsMap;
 
-    auto it = componentToTypeKitsMap.find(componentName);
-    if(it != componentToTypeKitsMap.end())
-        return it->second;
-    
-    //first we load the typekit
-    std::vector<std::string> pkgConfigFields;
-    pkgConfigFields.push_back("typekits");
-    std::vector<std::string> pkgConfigValues;
+    std::vector< std::string > ret;
+    if(!componentToTypeKitsMap.find(componentName, ret))
+    {
+        OROCOS_CPP_TRACE_SCOPE("PluginHelper::getNeededTypekits", componentName);
 
-    if(!PkgConfigHelper::parsePkgConfig(componentName + std::string("-tasks-") + xstr(OROCOS_TARGET) + std::string(".pc"), pkgConfigFields, pkgConfigValues))
-        throw std::runtime_error("Could not load pkgConfig file for typekit for component " + componentName);
+        //first we load the typekit
+        std::vector<std::string> pkgConfigFields;
+        pkgConfigFields.push_back("typekits");
+        std::vector<std::string> pkgConfigValues;
 
-    boost::char_separator<char> sep(" ");
-    boost::tokenizer<boost::char_separator<char> > typekits(pkgConfigValues[0], sep);
+        if(!PkgConfigHelper::parsePkgConfig(componentName + std::string("-tasks-") + xstr(OROCOS_TARGET) + std::string(".pc"), pkgConfigFields, pkgConfigValues))
+            throw std::runtime_error("Could not load pkgConfig file for typekit for component " + componentName);
 
-    std::vector< std::string > ret;
-    for(const std::string &tk: typekits)
-    {
-        ret.push_back(tk);
+        boost::char_separator<char> sep(" ");
+        boost::tokenizer<boost::char_separator<char> > typekits(pkgConfigValues[0], sep);
+
+        for(const std::string &tk: typekits)
+        {
+            ret.push_back(tk);
+        }
+
+        //if another thread was faster, its result is the same
+        componentToTypeKitsMap.insert(componentName, ret);
     }
-    
-    componentToTypeKitsMap[componentName] = ret;
+
+    for(const std::string &tk: ret)
+        TypekitManifest::recordUse(tk);
     
     return ret;
 }
 
 void PluginHelper::loadAllPluginsInDir(const std::string& path)
 {
+    OROCOS_CPP_TRACE_SCOPE("PluginHelper::loadAllPluginsInDir", path);
     base::Time start = base::Time::now();
     boost::filesystem::path pluginDir(path);
 
@@ -62,6 +87,7 @@ void PluginHelper::loadAllPluginsInDir(const std::string& path)
         if(boost::filesystem::is_regular_file(*it))
         {
 //             std::cout << "Found library " << *it << std::endl;
+            OROCOS_CPP_TRACE_SCOPE("PluginHelper::loadLibrary", it->path().filename().string());
             loader->loadLibrary(it->path().string());
             cnt++;
         }
@@ -71,12 +97,38 @@ void PluginHelper::loadAllPluginsInDir(const std::string& path)
     std::cout << "Loaded " << cnt << " typekits in " << (end - start).toSeconds() << " Seconds " << std::endl; 
 }
 
+bool PluginHelper::hasTypekit(const std::string& componentName)
+{
+    bool loaded;
+    {
+        std::lock_guard<std::mutex> lock(getLoadMutex());
+        loaded = RTT::types::TypekitRepository::hasTypekit(componentName);
+    }
+
+    //callers skip loadTypekitAndTransports for loaded typekits, e.g. the
+    //preloaded ones, which would otherwise never count as used
+    if(loaded)
+        TypekitManifest::recordUse(componentName);
+    return loaded;
+}
+
 bool PluginHelper::loadTypekitAndTransports(const std::string& componentName)
 {
+    bool ret = loadTypekitAndTransportsLocked(componentName);
+    TypekitManifest::recordUse(componentName);
+    return ret;
+}
+
+bool PluginHelper::loadTypekitAndTransportsLocked(const std::string& componentName)
+{
+    std::lock_guard<std::mutex> lock(getLoadMutex());
+
     //already loaded, we can just exit
     if(RTT::types::TypekitRepository::hasTypekit(componentName))
         return true;
     
+    OROCOS_CPP_TRACE_SCOPE("PluginHelper::loadTypekitAndTransports", componentName);
+
     std::vector<std::string> knownTransports;
     knownTransports.push_back("corba");
     knownTransports.push_back("mqueue");
@@ -96,11 +148,17 @@ bool PluginHelper::loadTypekitAndTransports(const std::string& componentName)
         if(!PkgConfigHelper::parsePkgConfig("orocos-rtt-" xstr(OROCOS_TARGET) ".pc", pkgConfigFields, pkgConfigValues))
             throw std::runtime_error("Could not load pkgConfig file for typekit for component " + componentName);
     
-        if(!loader.loadTypekits(pkgConfigValues[0] + "/lib/orocos/gnulinux/"))
-            throw std::runtime_error("Error, failed to load rtt basis typekits");
+        {
+            OROCOS_CPP_TRACE_SCOPE("PluginHelper::loadTypekits", componentName);
+            if(!loader.loadTypekits(pkgConfigValues[0] + "/lib/orocos/gnulinux/"))
+                throw std::runtime_error("Error, failed to load rtt basis typekits");
+        }
 
-        if(!loader.loadPlugins(pkgConfigValues[0] + "/lib/orocos/gnulinux/"))
-            throw std::runtime_error("Error, failed to load rtt basis plugins");
+        {
+            OROCOS_CPP_TRACE_SCOPE("PluginHelper::loadPlugins", componentName);
+            if(!loader.loadPlugins(pkgConfigValues[0] + "/lib/orocos/gnulinux/"))
+                throw std::runtime_error("Error, failed to load rtt basis plugins");
+        }
         
         return true;
     }
@@ -113,8 +171,11 @@ bool PluginHelper::loadTypekitAndTransports(const std::string& componentName)
         throw std::runtime_error("Internal Error while parsing pkgConfig file");
     
         
-    if(!loader.loadLibrary(libDir + "/lib" + componentName + "-typekit-" xstr(OROCOS_TARGET) ".so"))
-        throw std::runtime_error("Error, could not load typekit for component " + componentName);
+    {
+        OROCOS_CPP_TRACE_SCOPE("PluginHelper::loadLibrary", componentName + "-typekit");
+        if(!loader.loadLibrary(libDir + "/lib" + componentName + "-typekit-" xstr(OROCOS_TARGET) ".so"))
+            throw std::runtime_error("Error, could not load typekit for component " + componentName);
+    }
 
     for(const std::string &transport: knownTransports)
     {
@@ -127,6 +188,7 @@ bool PluginHelper::loadTypekitAndTransports(const std::string& componentName)
         
         RTT::plugin::PluginLoader &loader(*RTT::plugin::PluginLoader::Instance());
             
+        OROCOS_CPP_TRACE_SCOPE("PluginHelper::loadLibrary", componentName + "-transport-" + transport);
         if(!loader.loadLibrary(libDir + "/lib" + componentName + "-transport-" + transport + "-" xstr(OROCOS_TARGET) ".so"))
             throw std::runtime_error("Error, could not load transport " + transport + " for component " + componentName);
 
@@ -137,13 +199,14 @@ bool PluginHelper::loadTypekitAndTransports(const std::string& componentName)
 
 //This method loads all typkits required for a task model.
 bool PluginHelper::loadAllTypekitsForModel(const std::string &modelName){
+	OROCOS_CPP_TRACE_SCOPE("PluginHelper::loadAllTypekitsForModel", modelName);
 	std::string componentName = modelName.substr(0, modelName.find_first_of(':'));
 
 	std::vector<std::string> neededTks = PluginHelper::getNeededTypekits(componentName);
 	bool retVal = false;
 	for(const std::string &tk: neededTks)
 	{
-	    if(RTT::types::TypekitRepository::hasTypekit(tk))
+	    if(PluginHelper::hasTypekit(tk))
 	        continue;
 
 	    retVal = true;
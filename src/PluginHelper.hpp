@@ -11,6 +11,7 @@ namespace orocos_cpp
 class PluginHelper
 {
 private:
+    static bool loadTypekitAndTransportsLocked(const std::string &componentName);
 public:
     static void loadAllPluginsInDir(const std::string &path);
 
@@ -20,6 +21,13 @@ public:
      * */
     static bool loadTypekitAndTransports(const std::string &componentName);
 
+    /**
+     * Thread safe version of RTT::types::TypekitRepository::hasTypekit,
+     * typekits may be loaded in the background by TypekitManifest.
+     * A loaded typekit is recorded as used in the manifest.
+     * */
+    static bool hasTypekit(const std::string &componentName);
+
     /**
      * This method loads all typkits required for a task model.
      * All typekits were loaded to properly create a TaskContextProxy for an task of the given model type.
@@ -0,0 +1,331 @@
+#include "ProcessMonitor.hpp"
+#include <boost/lexical_cast.hpp>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+using namespace orocos_cpp;
+
+namespace
+{
+
+/**
+ * Returns the number following the given key, e.g. "Pss:" in
+ * "Pss:                 12 kB", or 0 if the key is not found.
+ * */
+uint64_t parseField(const char *buffer, const char *key)
+{
+    const char *pos = strstr(buffer, key);
+    if(!pos)
+        return 0;
+
+    return strtoull(pos + strlen(key), nullptr, 10);
+}
+
+ssize_t readFile(int fd, char *buffer, size_t size)
+{
+    ssize_t len = pread(fd, buffer, size - 1, 0);
+    if(len < 0)
+        return len;
+    buffer[len] = 0;
+    return len;
+}
+
+}
+
+ProcessSample::ProcessSample() : userTime(0), systemTime(0), cpuUsage(0), rss(0), pss(0), threads(0),
+                                 voluntaryContextSwitches(0), involuntaryContextSwitches(0), minorFaults(0), majorFaults(0)
+{
+}
+
+ProcessMonitor::Process::Process(pid_t pid, size_t historySize) : pid(pid), statFd(-1), statusFd(-1), smapsFd(-1),
+                                                                  alive(false), sampleCount(0), history(historySize)
+{
+}
+
+ProcessMonitor::Process::~Process()
+{
+    close();
+}
+
+bool ProcessMonitor::Process::open()
+{
+    std::string dir = "/proc/" + boost::lexical_cast<std::string>(pid) + "/";
+    statFd = ::open((dir + "stat").c_str(), O_RDONLY | O_CLOEXEC);
+    statusFd = ::open((dir + "status").c_str(), O_RDONLY | O_CLOEXEC);
+    //not available on kernels before 4.14, pss stays 0 then
+    smapsFd = ::open((dir + "smaps_rollup").c_str(), O_RDONLY | O_CLOEXEC);
+
+    alive = statFd >= 0 && statusFd >= 0;
+    return alive;
+}
+
+void ProcessMonitor::Process::close()
+{
+    for(int *fd: {&statFd, &statusFd, &smapsFd})
+    {
+        if(*fd >= 0)
+            ::close(*fd);
+        *fd = -1;
+    }
+    alive = false;
+}
+
+ProcessMonitor::ProcessMonitor(size_t historySize) : historySize(historySize), pssDivider(10), running(false)
+{
+    ticksPerSecond = sysconf(_SC_CLK_TCK);
+    pageSize = sysconf(_SC_PAGESIZE);
+}
+
+ProcessMonitor::~ProcessMonitor()
+{
+    stop();
+    for(std::pair<const std::string, Process *> &p: processes)
+        delete p.second;
+}
+
+void ProcessMonitor::addProcess(pid_t pid, const std::string& name)
+{
+    Process *process = new Process(pid, historySize);
+    if(!process->open())
+        std::cout << "ProcessMonitor: Warning, could not open /proc entries of " << name << " (" << pid << ")" << std::endl;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = processes.find(name);
+    if(it != processes.end())
+    {
+        delete it->second;
+        processes.erase(it);
+    }
+    processes.insert(std::make_pair(name, process));
+}
+
+void ProcessMonitor::removeProcess(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = processes.find(name);
+    if(it == processes.end())
+        return;
+
+    delete it->second;
+    processes.erase(it);
+}
+
+void ProcessMonitor::setPssDivider(size_t divider)
+{
+    if(!divider)
+        throw std::runtime_error("ProcessMonitor::Error, pss divider must be at least 1");
+
+    std::lock_guard<std::mutex> lock(mutex);
+    pssDivider = divider;
+}
+
+bool ProcessMonitor::sampleProcess(ProcessMonitor::Process& process, ProcessSample& sample)
+{
+    char buffer[4096];
+
+    if(readFile(process.statFd, buffer, sizeof(buffer)) <= 0)
+        return false;
+
+    //the process name may contain spaces and braces, the fields start after the last ')'
+    const char *fields = strrchr(buffer, ')');
+    if(!fields)
+        return false;
+
+    //skip ") " and field 3, the state character
+    const char *pos = fields + 2;
+    while(*pos && *pos != ' ')
+        pos++;
+
+    //values[i] holds field i + 4, as numbered in proc(5)
+    unsigned long long values[21] = {0};
+    for(int i = 0; i < 21 && *pos; i++)
+    {
+        char *end;
+        values[i] = strtoull(pos, &end, 10);
+        pos = end;
+    }
+
+    sample.time = base::Time::now();
+    sample.minorFaults = values[10 - 4];
+    sample.majorFaults = values[12 - 4];
+    sample.userTime = static_cast<double>(values[14 - 4]) / ticksPerSecond;
+    sample.systemTime = static_cast<double>(values[15 - 4]) / ticksPerSecond;
+    sample.threads = values[20 - 4];
+    sample.rss = values[24 - 4] * pageSize;
+
+    if(readFile(process.statusFd, buffer, sizeof(buffer)) <= 0)
+        return false;
+
+    sample.voluntaryContextSwitches = parseField(buffer, "\nvoluntary_ctxt_switches:");
+    sample.involuntaryContextSwitches = parseField(buffer, "\nnonvoluntary_ctxt_switches:");
+
+    if(!process.history.empty())
+    {
+        const ProcessSample &last(process.history.back());
+        sample.pss = last.pss;
+        double dt = (sample.time - last.time).toSeconds();
+        if(dt > 0)
+            sample.cpuUsage = (sample.userTime + sample.systemTime - last.userTime - last.systemTime) / dt;
+    }
+
+    if(process.smapsFd >= 0 && process.sampleCount % pssDivider == 0 && readFile(process.smapsFd, buffer, sizeof(buffer)) > 0)
+        sample.pss = parseField(buffer, "\nPss:") * 1024;
+
+    process.sampleCount++;
+    return true;
+}
+
+void ProcessMonitor::sample()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for(std::pair<const std::string, Process *> &p: processes)
+    {
+        Process &process(*p.second);
+        if(!process.alive)
+            continue;
+
+        ProcessSample sample;
+        if(sampleProcess(process, sample))
+            process.history.push_back(sample);
+        else
+            //reads fail with ESRCH once the process is gone, even if the pid gets reused
+            process.close();
+    }
+}
+
+void ProcessMonitor::run(base::Time period)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while(running)
+    {
+        lock.unlock();
+        sample();
+        lock.lock();
+        stopCondition.wait_for(lock, std::chrono::microseconds(period.toMicroseconds()), [this]() { return !running; });
+    }
+}
+
+void ProcessMonitor::start(const base::Time& period)
+{
+    stop();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    running = true;
+    thread = std::thread(&ProcessMonitor::run, this, period);
+}
+
+void ProcessMonitor::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    stopCondition.notify_all();
+
+    if(thread.joinable())
+        thread.join();
+}
+
+std::vector< std::string > ProcessMonitor::getProcessNames() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> ret;
+    for(const std::pair<const std::string, Process *> &p: processes)
+        ret.push_back(p.first);
+    return ret;
+}
+
+bool ProcessMonitor::isAlive(const std::string& name) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = processes.find(name);
+    return it != processes.end() && it->second->alive;
+}
+
+bool ProcessMonitor::getLatest(const std::string& name, ProcessSample& sample) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = processes.find(name);
+    if(it == processes.end() || it->second->history.empty())
+        return false;
+
+    sample = it->second->history.back();
+    return true;
+}
+
+std::vector< ProcessSample > ProcessMonitor::getHistory(const std::string& name) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = processes.find(name);
+    if(it == processes.end())
+        return std::vector<ProcessSample>();
+
+    return std::vector<ProcessSample>(it->second->history.begin(), it->second->history.end());
+}
+
+std::string ProcessMonitor::dumpText() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ostringstream out;
+    out << std::left << std::setw(32) << "name" << std::right << std::setw(8) << "pid" << std::setw(8) << "cpu%"
+        << std::setw(10) << "rss MB" << std::setw(10) << "pss MB" << std::setw(8) << "threads"
+        << std::setw(12) << "vol cs" << std::setw(12) << "invol cs" << std::setw(12) << "min flt" << std::setw(10) << "maj flt" << std::endl;
+
+    for(const std::pair<const std::string, Process *> &p: processes)
+    {
+        out << std::left << std::setw(32) << p.first << std::right << std::setw(8) << p.second->pid;
+        if(p.second->history.empty())
+        {
+            out << (p.second->alive ? "  no samples" : "  terminated") << std::endl;
+            continue;
+        }
+
+        const ProcessSample &s(p.second->history.back());
+        out << std::fixed << std::setprecision(1) << std::setw(8) << s.cpuUsage * 100.0
+            << std::setw(10) << s.rss / (1024.0 * 1024.0) << std::setw(10) << s.pss / (1024.0 * 1024.0)
+            << std::setw(8) << s.threads << std::setw(12) << s.voluntaryContextSwitches << std::setw(12) << s.involuntaryContextSwitches
+            << std::setw(12) << s.minorFaults << std::setw(10) << s.majorFaults;
+        if(!p.second->alive)
+            out << "  terminated";
+        out << std::endl;
+    }
+    return out.str();
+}
+
+std::string ProcessMonitor::dumpJSON() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ostringstream out;
+    out << "{";
+    bool firstProcess = true;
+    for(const std::pair<const std::string, Process *> &p: processes)
+    {
+        if(!firstProcess)
+            out << ",";
+        firstProcess = false;
+
+        out << "\"" << p.first << "\":{\"pid\":" << p.second->pid << ",\"alive\":" << (p.second->alive ? "true" : "false") << ",\"samples\":[";
+        bool firstSample = true;
+        for(const ProcessSample &s: p.second->history)
+        {
+            if(!firstSample)
+                out << ",";
+            firstSample = false;
+
+            out << "{\"time\":" << s.time.toMicroseconds()
+                << ",\"utime\":" << s.userTime << ",\"stime\":" << s.systemTime << ",\"cpu\":" << s.cpuUsage
+                << ",\"rss\":" << s.rss << ",\"pss\":" << s.pss << ",\"threads\":" << s.threads
+                << ",\"vcsw\":" << s.voluntaryContextSwitches << ",\"ivcsw\":" << s.involuntaryContextSwitches
+                << ",\"minflt\":" << s.minorFaults << ",\"majflt\":" << s.majorFaults << "}";
+        }
+        out << "]}";
+    }
+    out << "}";
+    return out.str();
+}
@@ -0,0 +1,150 @@
+#ifndef PROCESSMONITOR_H
+#define PROCESSMONITOR_H
+
+#include <base/Time.hpp>
+#include <boost/circular_buffer.hpp>
+#include <sys/types.h>
+#include <stdint.h>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace orocos_cpp
+{
+
+/**
+ * Resource usage of a process at one point in time.
+ * */
+struct ProcessSample
+{
+    ProcessSample();
+
+    base::Time time;
+
+    ///cpu time spent in user and kernel mode, in seconds
+    double userTime;
+    double systemTime;
+
+    ///cpu usage since the previous sample, 1.0 equals one fully used core
+    double cpuUsage;
+
+    ///resident and proportional set size in bytes. The pss is only
+    ///updated every few samples, see ProcessMonitor::setPssDivider
+    uint64_t rss;
+    uint64_t pss;
+
+    int threads;
+
+    uint64_t voluntaryContextSwitches;
+    uint64_t involuntaryContextSwitches;
+
+    uint64_t minorFaults;
+    uint64_t majorFaults;
+};
+
+/**
+ * Samples the resource usage of a set of processes from /proc.
+ *
+ * The /proc files of each process are kept open and reread
+ * using pread, so a sample costs two or three syscalls per
+ * process and no allocations. /proc/<pid>/smaps_rollup walks
+ * all memory mappings of the process, it is therefore only
+ * read every few samples.
+ * */
+class ProcessMonitor
+{
+public:
+    /**
+     * @param historySize Number of samples kept per process
+     * */
+    ProcessMonitor(size_t historySize = 100);
+    ~ProcessMonitor();
+
+    /**
+     * Adds a process to the monitor. The name is used to query the samples.
+     * */
+    void addProcess(pid_t pid, const std::string &name);
+    void removeProcess(const std::string &name);
+
+    /**
+     * Read smaps_rollup only every divider-th sample. Default is 10.
+     * */
+    void setPssDivider(size_t divider);
+
+    /**
+     * Takes one sample of all processes.
+     * */
+    void sample();
+
+    /**
+     * Starts a thread sampling all processes with the given period.
+     * */
+    void start(const base::Time &period);
+    void stop();
+
+    std::vector<std::string> getProcessNames() const;
+
+    /**
+     * Returns false if the process has terminated, or is not monitored.
+     * */
+    bool isAlive(const std::string &name) const;
+
+    /**
+     * Returns the latest sample of the given process.
+     * @return false if no sample is available
+     * */
+    bool getLatest(const std::string &name, ProcessSample &sample) const;
+
+    /**
+     * Returns all samples of the given process, oldest first.
+     * */
+    std::vector<ProcessSample> getHistory(const std::string &name) const;
+
+    /**
+     * Returns a table with the latest sample of each process.
+     * */
+    std::string dumpText() const;
+
+    /**
+     * Returns the complete history of all processes as JSON.
+     * */
+    std::string dumpJSON() const;
+
+private:
+    struct Process
+    {
+        Process(pid_t pid, size_t historySize);
+        ~Process();
+
+        bool open();
+        void close();
+
+        pid_t pid;
+        int statFd;
+        int statusFd;
+        int smapsFd;
+        bool alive;
+        size_t sampleCount;
+        boost::circular_buffer<ProcessSample> history;
+    };
+
+    bool sampleProcess(Process &process, ProcessSample &sample);
+    void run(base::Time period);
+
+    mutable std::mutex mutex;
+    std::map<std::string, Process *> processes;
+    size_t historySize;
+    size_t pssDivider;
+    long ticksPerSecond;
+    long pageSize;
+
+    std::thread thread;
+    std::condition_variable stopCondition;
+    bool running;
+};
+
+}//end of namespace
+#endif // PROCESSMONITOR_H
@@ -0,0 +1,365 @@
+#include "ProcessPlacement.hpp"
+#include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <iostream>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+//from linux/mempolicy.h, avoids the dependency on libnuma
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+#ifndef MPOL_BIND
+#define MPOL_BIND 2
+#endif
+#ifndef MPOL_INTERLEAVE
+#define MPOL_INTERLEAVE 3
+#endif
+
+using namespace orocos_cpp;
+
+namespace
+{
+
+bool writeFile(const std::string &fileName, const std::string &value)
+{
+    int fd = open(fileName.c_str(), O_WRONLY | O_CLOEXEC);
+    if(fd < 0)
+        return false;
+
+    bool ret = write(fd, value.c_str(), value.size()) == static_cast<ssize_t>(value.size());
+    close(fd);
+    return ret;
+}
+
+/**
+ * Writes "ProcessPlacement: Warning, could not <what> : errno <n>" to
+ * stderr, without allocating memory. Used in the child after fork.
+ * */
+void reportError(const char *what)
+{
+    const int error = errno;
+    char buffer[256];
+    size_t len = 0;
+    const char *parts[] = {"ProcessPlacement: Warning, could not ", what, " : errno "};
+    for(const char *part: parts)
+    {
+        for(const char *c = part; *c && len < sizeof(buffer) - 16; c++)
+            buffer[len++] = *c;
+    }
+
+    char digits[16];
+    size_t count = 0;
+    unsigned int value = error;
+    do {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while(value);
+    while(count)
+        buffer[len++] = digits[--count];
+    buffer[len++] = '\n';
+
+    if(write(STDERR_FILENO, buffer, len) < 0)
+    {
+        //nothing left to report to
+    }
+}
+
+}
+
+PreparedPlacement::PreparedPlacement() : setAffinity(false), memoryMode(0), setNice(false), nice(0),
+                                         setScheduler(false), scheduler(SCHED_OTHER), priority(0)
+{
+    CPU_ZERO(&cpus);
+    memset(memoryNodes, 0, sizeof(memoryNodes));
+}
+
+PlacementPolicy::PlacementPolicy() : scheduler(SCHED_POLICY_INHERIT), priority(0), setNice(false), nice(0),
+                                     memoryPolicy(MEMORY_INHERIT), memoryMax(0), latencyCritical(false)
+{
+}
+
+bool PlacementPolicy::needsCGroup() const
+{
+    return !cpuMax.empty() || memoryMax;
+}
+
+ProcessPlacement::ProcessPlacement() : nextSharedIndex(0), automatic(false), sharedCoresPerDeployment(2), criticalPriority(50)
+{
+    const char *root = getenv("OROCOS_CPP_CGROUP_ROOT");
+    if(root)
+        cgroupRoot = root;
+}
+
+void ProcessPlacement::setPolicy(const std::string& deploymentName, const PlacementPolicy& policy)
+{
+    policies[deploymentName] = policy;
+}
+
+void ProcessPlacement::setLatencyCritical(const std::string& deploymentName, bool critical)
+{
+    if(critical)
+        criticalDeployments.insert(deploymentName);
+    else
+    {
+        criticalDeployments.erase(deploymentName);
+        reservedCpus.erase(deploymentName);
+    }
+}
+
+void ProcessPlacement::setAutomatic(bool automaticMode)
+{
+    automatic = automaticMode;
+}
+
+bool ProcessPlacement::isAutomatic() const
+{
+    return automatic;
+}
+
+void ProcessPlacement::setSharedCoresPerDeployment(int count)
+{
+    if(count < 1)
+        throw std::runtime_error("ProcessPlacement::Error, at least one core per deployment is needed");
+    sharedCoresPerDeployment = count;
+}
+
+int ProcessPlacement::getSharedCoresPerDeployment() const
+{
+    return sharedCoresPerDeployment;
+}
+
+void ProcessPlacement::setCriticalPriority(int priority)
+{
+    criticalPriority = priority;
+}
+
+void ProcessPlacement::setCGroupRoot(const std::string& root)
+{
+    cgroupRoot = root;
+}
+
+const std::string& ProcessPlacement::getCGroupRoot() const
+{
+    return cgroupRoot;
+}
+
+std::vector< int > ProcessPlacement::getAvailableCpus() const
+{
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if(sched_getaffinity(0, sizeof(set), &set))
+        return cpus;
+
+    for(int i = 0; i < CPU_SETSIZE; i++)
+    {
+        if(CPU_ISSET(i, &set))
+            cpus.push_back(i);
+    }
+    return cpus;
+}
+
+PlacementPolicy ProcessPlacement::resolve(const std::string& deploymentName)
+{
+    auto it = policies.find(deploymentName);
+    if(it != policies.end())
+        return it->second;
+
+    PlacementPolicy policy;
+    if(!automatic)
+        return policy;
+
+    std::vector<int> available = getAvailableCpus();
+
+    if(criticalDeployments.count(deploymentName))
+    {
+        auto reserved = reservedCpus.find(deploymentName);
+        if(reserved == reservedCpus.end())
+        {
+            //take the highest core that is not reserved, but always leave one core for the rest
+            for(auto cpu = available.rbegin(); cpu != available.rend() && reservedCpus.size() + 1 < available.size(); cpu++)
+            {
+                bool taken = false;
+                for(const std::pair<const std::string, int> &r: reservedCpus)
+                    taken |= (r.second == *cpu);
+
+                if(!taken)
+                {
+                    reserved = reservedCpus.insert(std::make_pair(deploymentName, *cpu)).first;
+                    break;
+                }
+            }
+        }
+
+        if(reserved != reservedCpus.end())
+        {
+            policy.cpus.push_back(reserved->second);
+            policy.scheduler = PlacementPolicy::SCHED_POLICY_FIFO;
+            policy.priority = criticalPriority;
+            policy.latencyCritical = true;
+            return policy;
+        }
+
+        std::cout << "ProcessPlacement: Warning, no core left to isolate " << deploymentName << ", placing it on the shared cores" << std::endl;
+    }
+
+    std::vector<int> shared;
+    for(int cpu: available)
+    {
+        bool taken = false;
+        for(const std::pair<const std::string, int> &r: reservedCpus)
+            taken |= (r.second == cpu);
+        if(!taken)
+            shared.push_back(cpu);
+    }
+
+    if(shared.empty())
+        return policy;
+
+    for(size_t i = 0; i < std::min<size_t>(sharedCoresPerDeployment, shared.size()); i++)
+        policy.cpus.push_back(shared[(nextSharedIndex + i) % shared.size()]);
+    nextSharedIndex += sharedCoresPerDeployment;
+
+    return policy;
+}
+
+std::string ProcessPlacement::prepareCGroup(const std::string& deploymentName, const PlacementPolicy& policy) const
+{
+    if(!policy.needsCGroup())
+        return std::string();
+
+    if(cgroupRoot.empty())
+    {
+        std::cout << "ProcessPlacement: Warning, cgroup limits for " << deploymentName << " requested, but no cgroup root is set" << std::endl;
+        return std::string();
+    }
+
+    //may fail if already enabled or not delegated, writing the limits will tell
+    writeFile(cgroupRoot + "/cgroup.subtree_control", "+cpu +memory");
+
+    std::string cgroup = cgroupRoot + "/" + deploymentName;
+    if(mkdir(cgroup.c_str(), 0755) && errno != EEXIST)
+    {
+        std::cout << "ProcessPlacement: Warning, could not create cgroup " << cgroup << " : " << strerror(errno) << std::endl;
+        return std::string();
+    }
+
+    if(!policy.cpuMax.empty() && !writeFile(cgroup + "/cpu.max", policy.cpuMax))
+        std::cout << "ProcessPlacement: Warning, could not set cpu.max of " << cgroup << " : " << strerror(errno) << std::endl;
+
+    if(policy.memoryMax && !writeFile(cgroup + "/memory.max", boost::lexical_cast<std::string>(policy.memoryMax)))
+        std::cout << "ProcessPlacement: Warning, could not set memory.max of " << cgroup << " : " << strerror(errno) << std::endl;
+
+    return cgroup;
+}
+
+PreparedPlacement ProcessPlacement::prepare(const PlacementPolicy& policy, const std::string& cgroup)
+{
+    PreparedPlacement prepared;
+
+    //writing 0 moves the writing process
+    if(!cgroup.empty())
+        prepared.cgroupProcs = cgroup + "/cgroup.procs";
+
+    if(!policy.cpus.empty())
+    {
+        prepared.setAffinity = true;
+        for(int cpu: policy.cpus)
+        {
+            if(cpu >= 0 && cpu < CPU_SETSIZE)
+                CPU_SET(cpu, &prepared.cpus);
+        }
+    }
+
+    if(policy.memoryPolicy != PlacementPolicy::MEMORY_INHERIT)
+    {
+        const size_t bits = 8 * sizeof(unsigned long);
+        for(int node: policy.memoryNodes)
+        {
+            if(node >= 0 && static_cast<size_t>(node) < PreparedPlacement::MAX_MEMORY_NODES)
+                prepared.memoryNodes[node / bits] |= 1UL << (node % bits);
+        }
+
+        prepared.memoryMode = MPOL_BIND;
+        if(policy.memoryPolicy == PlacementPolicy::MEMORY_INTERLEAVE)
+            prepared.memoryMode = MPOL_INTERLEAVE;
+        else if(policy.memoryPolicy == PlacementPolicy::MEMORY_PREFERRED)
+            prepared.memoryMode = MPOL_PREFERRED;
+    }
+
+    prepared.setNice = policy.setNice;
+    prepared.nice = policy.nice;
+
+    if(policy.scheduler != PlacementPolicy::SCHED_POLICY_INHERIT)
+    {
+        prepared.setScheduler = true;
+        prepared.scheduler = SCHED_OTHER;
+        prepared.priority = 0;
+        if(policy.scheduler == PlacementPolicy::SCHED_POLICY_FIFO || policy.scheduler == PlacementPolicy::SCHED_POLICY_RR)
+        {
+            prepared.scheduler = policy.scheduler == PlacementPolicy::SCHED_POLICY_FIFO ? SCHED_FIFO : SCHED_RR;
+            prepared.priority = policy.priority;
+        }
+    }
+
+    return prepared;
+}
+
+bool ProcessPlacement::apply(const PreparedPlacement& placement)
+{
+    //only async signal safe calls from here on, see PreparedPlacement
+    bool ret = true;
+
+    if(!placement.cgroupProcs.empty())
+    {
+        int fd = open(placement.cgroupProcs.c_str(), O_WRONLY | O_CLOEXEC);
+        if(fd < 0 || write(fd, "0", 1) != 1)
+        {
+            reportError("join the cgroup");
+            ret = false;
+        }
+        if(fd >= 0)
+            close(fd);
+    }
+
+    if(placement.setAffinity && sched_setaffinity(0, sizeof(placement.cpus), &placement.cpus))
+    {
+        reportError("set cpu affinity");
+        ret = false;
+    }
+
+    if(placement.memoryMode && syscall(SYS_set_mempolicy, placement.memoryMode, placement.memoryNodes, PreparedPlacement::MAX_MEMORY_NODES + 1))
+    {
+        reportError("set memory policy");
+        ret = false;
+    }
+
+    if(placement.setNice && setpriority(PRIO_PROCESS, 0, placement.nice))
+    {
+        reportError("set nice value");
+        ret = false;
+    }
+
+    if(placement.setScheduler)
+    {
+        sched_param param;
+        param.sched_priority = placement.priority;
+
+        //needs CAP_SYS_NICE or a matching RLIMIT_RTPRIO for real time policies
+        if(sched_setscheduler(0, placement.scheduler, &param))
+        {
+            reportError("set scheduler");
+            ret = false;
+        }
+    }
+
+    return ret;
+}
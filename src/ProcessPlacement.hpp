@@ -0,0 +1,194 @@
+#ifndef PROCESSPLACEMENT_H
+#define PROCESSPLACEMENT_H
+
+#include <sched.h>
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace orocos_cpp
+{
+
+/**
+ * Placement of a deployment process: CPU set, scheduling,
+ * memory policy and cgroup v2 limits.
+ *
+ * All members default to 'inherit from the spawning process'.
+ * */
+struct PlacementPolicy
+{
+    enum Scheduler
+    {
+        SCHED_POLICY_INHERIT,
+        SCHED_POLICY_OTHER,
+        SCHED_POLICY_FIFO,
+        SCHED_POLICY_RR,
+    };
+
+    enum MemoryPolicy
+    {
+        MEMORY_INHERIT,
+        MEMORY_BIND,
+        MEMORY_INTERLEAVE,
+        MEMORY_PREFERRED,
+    };
+
+    PlacementPolicy();
+
+    ///cpus the process may run on, empty to inherit
+    std::vector<int> cpus;
+
+    Scheduler scheduler;
+
+    ///real time priority for FIFO and RR
+    int priority;
+
+    bool setNice;
+    int nice;
+
+    MemoryPolicy memoryPolicy;
+
+    ///NUMA nodes for the memory policy
+    std::vector<int> memoryNodes;
+
+    ///cpu.max of the cgroup, e.g. "50000 100000" for half a core, empty for no limit
+    std::string cpuMax;
+
+    ///memory.max of the cgroup in bytes, 0 for no limit
+    uint64_t memoryMax;
+
+    /**
+     * In automatic mode, latency critical deployments get
+     * exclusive cores and real time scheduling.
+     * */
+    bool latencyCritical;
+
+    ///true if any cgroup limit is requested
+    bool needsCGroup() const;
+};
+
+/**
+ * A policy translated into the arguments of the system calls that
+ * apply it. Created in the parent before fork, so that applying it in
+ * the child needs no memory allocation and no locks.
+ * */
+struct PreparedPlacement
+{
+    static const size_t MAX_MEMORY_NODES = 1024;
+
+    PreparedPlacement();
+
+    ///path of cgroup.procs of the cgroup to join, empty for none
+    std::string cgroupProcs;
+
+    bool setAffinity;
+    cpu_set_t cpus;
+
+    ///MPOL_* mode for set_mempolicy, 0 to inherit
+    int memoryMode;
+    unsigned long memoryNodes[MAX_MEMORY_NODES / (8 * sizeof(unsigned long))];
+
+    bool setNice;
+    int nice;
+
+    bool setScheduler;
+    int scheduler;
+    int priority;
+};
+
+/**
+ * Placement policies of the deployments spawned by the Spawner.
+ *
+ * The policies are resolved and prepared in the parent. The child only
+ * applies the prepared placement, using async signal safe system calls,
+ * between fork and exec. The spawner may run several threads at fork
+ * time, so the child must not allocate memory or use iostreams.
+ *
+ * In automatic mode, deployments without explicit policy are placed as follows:
+ * - latency critical deployments get one exclusive core each, taken
+ *   from the top of the available cores, and SCHED_FIFO
+ * - all other deployments are spread round robin over the remaining
+ *   cores, using groups of getSharedCoresPerDeployment() cores
+ * */
+class ProcessPlacement
+{
+public:
+    ProcessPlacement();
+
+    /**
+     * Sets the policy for the deployment with the given name.
+     * Explicit policies take precedence over the automatic placement.
+     * */
+    void setPolicy(const std::string &deploymentName, const PlacementPolicy &policy);
+
+    /**
+     * Marks the given deployment as latency critical for the automatic mode.
+     * */
+    void setLatencyCritical(const std::string &deploymentName, bool critical = true);
+
+    void setAutomatic(bool automatic);
+    bool isAutomatic() const;
+
+    void setSharedCoresPerDeployment(int count);
+    int getSharedCoresPerDeployment() const;
+
+    ///priority used for latency critical deployments in automatic mode
+    void setCriticalPriority(int priority);
+
+    /**
+     * Directory of a delegated cgroup v2 subtree, in which a cgroup per
+     * deployment is created. Defaults to the environment variable
+     * OROCOS_CPP_CGROUP_ROOT. If empty, cgroup limits are ignored.
+     * */
+    void setCGroupRoot(const std::string &root);
+    const std::string &getCGroupRoot() const;
+
+    /**
+     * Returns the policy that will be applied to the given deployment.
+     * In automatic mode this reserves cores for the deployment.
+     * */
+    PlacementPolicy resolve(const std::string &deploymentName);
+
+    /**
+     * Creates the cgroup of the deployment and writes its limits.
+     * Is called in the parent, before fork.
+     * @return the path of the cgroup, or an empty string if none is needed
+     * */
+    std::string prepareCGroup(const std::string &deploymentName, const PlacementPolicy &policy) const;
+
+    /**
+     * Translates the policy into the system call arguments.
+     * Is called in the parent, before fork.
+     * @param cgroup path returned by prepareCGroup
+     * */
+    static PreparedPlacement prepare(const PlacementPolicy &policy, const std::string &cgroup);
+
+    /**
+     * Applies the placement to the calling process. Is called in the
+     * child between fork and exec and is async signal safe. Errors are
+     * written to stderr, but do not abort, as the deployment is still
+     * usable without its placement.
+     * @return true if everything could be applied
+     * */
+    static bool apply(const PreparedPlacement &placement);
+
+private:
+    std::vector<int> getAvailableCpus() const;
+
+    std::map<std::string, PlacementPolicy> policies;
+    std::set<std::string> criticalDeployments;
+
+    //automatic mode: cores reserved for latency critical deployments
+    std::map<std::string, int> reservedCpus;
+    size_t nextSharedIndex;
+
+    bool automatic;
+    int sharedCoresPerDeployment;
+    int criticalPriority;
+    std::string cgroupRoot;
+};
+
+}//end of namespace
+#endif // PROCESSPLACEMENT_H
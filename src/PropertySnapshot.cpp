@@ -0,0 +1,719 @@
+#include "PropertySnapshot.hpp"
+#include "KnownTypes.hpp"
+#include "PartialTaskContextProxy.hpp"
+#include "PluginHelper.hpp"
+#include "Tracing.hpp"
+#include "TypeRegistry.hpp"
+#include <rtt/typelib/TypelibMarshallerBase.hpp>
+#include <rtt/types/TypeInfoRepository.hpp>
+#include <typelib/typemodel.hh>
+#include <typelib/value_ops.hh>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace orocos_cpp;
+
+namespace
+{
+
+const char MAGIC[8] = {'O', 'C', 'P', 'P', 'S', 'N', 'A', 'P'};
+const uint32_t FORMAT_VERSION = 1;
+
+orogen_transports::TypelibMarshallerBase *getMarshaller(const RTT::types::TypeInfo *typeInfo)
+{
+    if(!typeInfo)
+        return nullptr;
+    return dynamic_cast<orogen_transports::TypelibMarshallerBase *>(typeInfo->getProtocol(orogen_transports::TYPELIB_MARSHALLER_ID));
+}
+
+const Typelib::Type *getMarshallingType(orogen_transports::TypelibMarshallerBase *marshaller)
+{
+    return marshaller->getRegistry().get(marshaller->getMarshallingType());
+}
+
+/**
+ * Marshalling sample, that is deleted when the scope is left,
+ * also if Typelib::load or dump throw
+ * */
+class SampleHandle
+{
+    orogen_transports::TypelibMarshallerBase *marshaller;
+    orogen_transports::TypelibMarshallerBase::Handle *handle;
+
+    SampleHandle(const SampleHandle &);
+    SampleHandle &operator=(const SampleHandle &);
+public:
+    explicit SampleHandle(orogen_transports::TypelibMarshallerBase *marshaller) : marshaller(marshaller), handle(marshaller->createSample())
+    {
+    }
+
+    ~SampleHandle()
+    {
+        marshaller->deleteHandle(handle);
+    }
+
+    orogen_transports::TypelibMarshallerBase::Handle *get() const
+    {
+        return handle;
+    }
+};
+
+/**
+ * Flushes the file or directory to disk
+ * */
+bool syncPath(const std::string &path)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        return false;
+
+    bool ret = fsync(fd) == 0;
+    close(fd);
+    return ret;
+}
+
+//FNV-1a
+void hashBytes(uint64_t &hash, const void *data, size_t size)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    for(size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+}
+
+void hashNumber(uint64_t &hash, uint64_t value)
+{
+    hashBytes(hash, &value, sizeof(value));
+}
+
+void hashString(uint64_t &hash, const std::string &value)
+{
+    hashNumber(hash, value.size());
+    hashBytes(hash, value.data(), value.size());
+}
+
+void hashType(uint64_t &hash, const Typelib::Type &type)
+{
+    hashString(hash, type.getName());
+    hashNumber(hash, type.getCategory());
+    hashNumber(hash, type.getSize());
+
+    switch(type.getCategory())
+    {
+        case Typelib::Type::Numeric:
+            hashNumber(hash, static_cast<const Typelib::Numeric &>(type).getNumericCategory());
+            break;
+        case Typelib::Type::Enum:
+            for(const std::pair<const std::string, Typelib::Enum::integral_type> &value: static_cast<const Typelib::Enum &>(type).values())
+            {
+                hashString(hash, value.first);
+                hashNumber(hash, value.second);
+            }
+            break;
+        case Typelib::Type::Array:
+        {
+            const Typelib::Array &array = static_cast<const Typelib::Array &>(type);
+            hashNumber(hash, array.getDimension());
+            hashType(hash, array.getIndirection());
+            break;
+        }
+        case Typelib::Type::Container:
+        {
+            const Typelib::Container &cont = static_cast<const Typelib::Container &>(type);
+            hashString(hash, cont.kind());
+            hashType(hash, cont.getIndirection());
+            break;
+        }
+        case Typelib::Type::Compound:
+            for(const Typelib::Field &field: static_cast<const Typelib::Compound &>(type).getFields())
+            {
+                hashString(hash, field.getName());
+                hashNumber(hash, field.getOffset());
+                hashType(hash, field.getType());
+            }
+            break;
+        default:
+            //pointers are not followed, the name identifies opaques
+            break;
+    }
+}
+
+void writeNumber(std::ostream &out, uint64_t value)
+{
+    out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void writeString(std::ostream &out, const std::string &value)
+{
+    writeNumber(out, value.size());
+    out.write(value.data(), value.size());
+}
+
+bool readNumber(std::istream &in, uint64_t &value)
+{
+    in.read(reinterpret_cast<char *>(&value), sizeof(value));
+    return in.good();
+}
+
+bool readBytes(std::istream &in, uint64_t size, std::string &value)
+{
+    //guard against allocating garbage sizes of a corrupt file
+    if(size > (1ULL << 32))
+        return false;
+    value.resize(size);
+    in.read(&value[0], size);
+    return in.good();
+}
+
+bool readString(std::istream &in, std::string &value)
+{
+    uint64_t size;
+    return readNumber(in, size) && readBytes(in, size, value);
+}
+
+bool isScalar(const Typelib::Type &type)
+{
+    if(type.getCategory() == Typelib::Type::Numeric || type.getCategory() == Typelib::Type::Enum)
+        return true;
+    if(type.getCategory() == Typelib::Type::Container)
+        return static_cast<const Typelib::Container &>(type).kind() == "/std/string";
+    return false;
+}
+
+template<typename T>
+std::string printNumber(const void *data)
+{
+    T value;
+    memcpy(&value, data, sizeof(T));
+    std::ostringstream out;
+    out << std::setprecision(std::numeric_limits<T>::max_digits10) << +value;
+    return out.str();
+}
+
+std::string quote(const std::string &value)
+{
+    std::string quoted("\"");
+    for(char c: value)
+    {
+        switch(c)
+        {
+            case '"': quoted += "\\\""; break;
+            case '\\': quoted += "\\\\"; break;
+            case '\n': quoted += "\\n"; break;
+            case '\t': quoted += "\\t"; break;
+            default: quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+std::string scalarToYAML(const Typelib::Value &value)
+{
+    const Typelib::Type &type(value.getType());
+    const void *data = value.getData();
+    if(type.getCategory() == Typelib::Type::Enum)
+    {
+        Typelib::Enum::integral_type intValue;
+        memcpy(&intValue, data, sizeof(intValue));
+        try {
+            return static_cast<const Typelib::Enum &>(type).get(intValue);
+        } catch (...)
+        {
+            return boost::lexical_cast<std::string>(intValue);
+        }
+    }
+
+    if(type.getCategory() == Typelib::Type::Container)
+        return quote(*static_cast<const std::string *>(data));
+
+    const Typelib::Numeric &num = static_cast<const Typelib::Numeric &>(type);
+    switch(num.getNumericCategory())
+    {
+        case Typelib::Numeric::Float:
+            if(num.getSize() == sizeof(float))
+                return printNumber<float>(data);
+            return printNumber<double>(data);
+        case Typelib::Numeric::SInt:
+            switch(num.getSize())
+            {
+                case 1: return printNumber<int8_t>(data);
+                case 2: return printNumber<int16_t>(data);
+                case 4: return printNumber<int32_t>(data);
+                default: return printNumber<int64_t>(data);
+            }
+        default:
+            switch(num.getSize())
+            {
+                case 1: return printNumber<uint8_t>(data);
+                case 2: return printNumber<uint16_t>(data);
+                case 4: return printNumber<uint32_t>(data);
+                default: return printNumber<uint64_t>(data);
+            }
+    }
+}
+
+void writeYAML(std::ostream &out, const Typelib::Value &value, size_t indent);
+
+void writeSequence(std::ostream &out, uint8_t *elements, size_t count, const Typelib::Type &indirect, size_t indent)
+{
+    if(!count)
+    {
+        out << " []" << std::endl;
+        return;
+    }
+
+    if(isScalar(indirect))
+    {
+        out << " [";
+        for(size_t i = 0; i < count; i++)
+            out << (i ? ", " : "") << scalarToYAML(Typelib::Value(elements + i * indirect.getSize(), indirect));
+        out << "]" << std::endl;
+        return;
+    }
+
+    out << std::endl;
+    for(size_t i = 0; i < count; i++)
+    {
+        out << std::string(indent, ' ') << "-";
+        writeYAML(out, Typelib::Value(elements + i * indirect.getSize(), indirect), indent + 2);
+    }
+}
+
+/**
+ * Writes the value following a key or list marker, including the line break
+ * */
+void writeYAML(std::ostream &out, const Typelib::Value &value, size_t indent)
+{
+    const Typelib::Type &type(value.getType());
+    if(isScalar(type))
+    {
+        out << " " << scalarToYAML(value) << std::endl;
+        return;
+    }
+
+    switch(type.getCategory())
+    {
+        case Typelib::Type::Compound:
+        {
+            const Typelib::Compound &comp = static_cast<const Typelib::Compound &>(type);
+            if(comp.getFields().empty())
+            {
+                out << " {}" << std::endl;
+                return;
+            }
+            out << std::endl;
+            for(const Typelib::Field &field: comp.getFields())
+            {
+                out << std::string(indent, ' ') << field.getName() << ":";
+                writeYAML(out, Typelib::Value(static_cast<uint8_t *>(value.getData()) + field.getOffset(), field.getType()), indent + 2);
+            }
+            return;
+        }
+        case Typelib::Type::Array:
+        {
+            const Typelib::Array &array = static_cast<const Typelib::Array &>(type);
+            writeSequence(out, static_cast<uint8_t *>(value.getData()), array.getDimension(), array.getIndirection(), indent);
+            return;
+        }
+        case Typelib::Type::Container:
+        {
+            const Typelib::Container &cont = static_cast<const Typelib::Container &>(type);
+            if(cont.kind() != "/std/vector")
+                break;
+            const Typelib::Type &indirect(cont.getIndirection());
+            if(indirect.getName() == "/bool")
+            {
+                //std::vector<bool> is packed, write it element by element
+                const std::vector<bool> *bits = static_cast<const std::vector<bool> *>(value.getData());
+                std::vector<uint8_t> elements(bits->begin(), bits->end());
+                writeSequence(out, elements.data(), elements.size(), indirect, indent);
+                return;
+            }
+            //the storage of a typelib vector is a std::vector
+            std::vector<uint8_t> *storage = static_cast<std::vector<uint8_t> *>(value.getData());
+            writeSequence(out, storage->data(), cont.getElementCount(value.getData()), cont.getIndirection(), indent);
+            return;
+        }
+        default:
+            break;
+    }
+
+    out << " ~ # unsupported type " << type.getName() << std::endl;
+}
+
+}
+
+bool PropertySnapshot::addTask(RTT::TaskContext* task)
+{
+    OROCOS_CPP_TRACE_SCOPE("PropertySnapshot::addTask", task->getName());
+
+    PartialTaskContextProxy *partialProxy = dynamic_cast<PartialTaskContextProxy *>(task);
+    if(partialProxy)
+        partialProxy->fetch(PartialTaskContextProxy::PROPERTIES);
+
+    Task snapshot;
+    snapshot.name = task->getName();
+    bool success = true;
+
+    for(RTT::base::PropertyBase *property: *task->properties())
+    {
+        orogen_transports::TypelibMarshallerBase *marshaller = getMarshaller(property->getTypeInfo());
+        if(!marshaller)
+        {
+            std::cout << "PropertySnapshot::addTask : Warning, type " << property->getType() << " of property " << snapshot.name
+                      << "." << property->getName() << " has no typelib transport, skipping it" << std::endl;
+            continue;
+        }
+
+        const Typelib::Type *type = getMarshallingType(marshaller);
+        RTT::base::DataSourceBase::shared_ptr ds = property->getDataSource();
+
+        Property entry;
+        entry.name = property->getName();
+        entry.typeName = property->getTypeInfo()->getTypeName();
+        entry.typeSignature = getTypeSignature(*type);
+
+        std::shared_ptr<KnownTypeHandler> knownType = KnownTypeRegistry::getInstance().get(property->getTypeInfo());
+        if(knownType && knownType->accepts(ds))
+        {
+            //compiled dump, no marshalling sample needed
+            knownType->dump(ds, entry.data);
+        }
+        else if(marshaller->isPlainTypelibType() && !PartialTaskContextProxy::isProxy(task) && ds->getRawPointer())
+        {
+            //the task lives in our process, dump the native storage
+            Typelib::dump(Typelib::Value(ds->getRawPointer(), *type), entry.data);
+        }
+        else
+        {
+            SampleHandle handle(marshaller);
+            if(!marshaller->readDataSource(*ds, handle.get()))
+            {
+                std::cout << "PropertySnapshot::addTask : Error, could not read property " << snapshot.name << "." << entry.name << std::endl;
+                success = false;
+                continue;
+            }
+            marshaller->refreshTypelibSample(handle.get());
+            Typelib::dump(Typelib::Value(marshaller->getTypelibSample(handle.get()), *type), entry.data);
+        }
+
+        snapshot.properties.push_back(entry);
+    }
+
+    for(Task &existing: tasks)
+    {
+        if(existing.name == snapshot.name)
+        {
+            existing = snapshot;
+            return success;
+        }
+    }
+    tasks.push_back(snapshot);
+    return success;
+}
+
+bool PropertySnapshot::restore(RTT::TaskContext* task) const
+{
+    OROCOS_CPP_TRACE_SCOPE("PropertySnapshot::restore", task->getName());
+
+    const Task *snapshot = getTask(task->getName());
+    if(!snapshot)
+    {
+        std::cout << "PropertySnapshot::restore : Error, the snapshot contains no task named " << task->getName() << std::endl;
+        return false;
+    }
+
+    PartialTaskContextProxy *partialProxy = dynamic_cast<PartialTaskContextProxy *>(task);
+    bool success = true;
+
+    for(const Property &entry: snapshot->properties)
+    {
+        RTT::base::PropertyBase *property = task->getProperty(entry.name);
+        if(!property && partialProxy)
+            property = partialProxy->fetchProperty(entry.name);
+        if(!property)
+        {
+            std::cout << "PropertySnapshot::restore : Error, task " << snapshot->name << " has no property " << entry.name << std::endl;
+            success = false;
+            continue;
+        }
+
+        orogen_transports::TypelibMarshallerBase *marshaller = getMarshaller(property->getTypeInfo());
+        const Typelib::Type *type = marshaller ? getMarshallingType(marshaller) : nullptr;
+        if(!type || getTypeSignature(*type) != entry.typeSignature)
+        {
+            std::cout << "PropertySnapshot::restore : Error, type of property " << snapshot->name << "." << entry.name
+                      << " changed since the snapshot was taken, skipping it" << std::endl;
+            success = false;
+            continue;
+        }
+
+        RTT::base::DataSourceBase::shared_ptr ds = property->getDataSource();
+        std::shared_ptr<KnownTypeHandler> knownType = KnownTypeRegistry::getInstance().get(property->getTypeInfo());
+        if(knownType && knownType->accepts(ds))
+        {
+            if(!knownType->load(ds, entry.data))
+            {
+                std::cout << "PropertySnapshot::restore : Error, could not restore property " << snapshot->name << "." << entry.name << std::endl;
+                success = false;
+            }
+            continue;
+        }
+
+        try {
+            if(marshaller->isPlainTypelibType() && !PartialTaskContextProxy::isProxy(task) && ds->getRawPointer())
+            {
+                Typelib::load(Typelib::Value(ds->getRawPointer(), *type), entry.data);
+                //notify the task about the change
+                ds->updated();
+                continue;
+            }
+
+            SampleHandle handle(marshaller);
+            Typelib::load(Typelib::Value(marshaller->getTypelibSample(handle.get()), *type), entry.data);
+            marshaller->refreshOrocosSample(handle.get());
+            marshaller->writeDataSource(*ds, handle.get());
+        } catch (const std::exception &e)
+        {
+            std::cout << "PropertySnapshot::restore : Error, could not restore property " << snapshot->name << "." << entry.name << " : " << e.what() << std::endl;
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+const PropertySnapshot::Task* PropertySnapshot::getTask(const std::string& taskName) const
+{
+    for(const Task &task: tasks)
+    {
+        if(task.name == taskName)
+            return &task;
+    }
+    return nullptr;
+}
+
+bool PropertySnapshot::hasTask(const std::string& taskName) const
+{
+    return getTask(taskName);
+}
+
+const std::vector< PropertySnapshot::Task >& PropertySnapshot::getTasks() const
+{
+    return tasks;
+}
+
+void PropertySnapshot::clear()
+{
+    tasks.clear();
+}
+
+bool PropertySnapshot::save(const std::string& fileName) const
+{
+    OROCOS_CPP_TRACE_SCOPE("PropertySnapshot::save", fileName);
+
+    const std::string tmpName = fileName + ".tmp";
+    {
+        std::ofstream out(tmpName.c_str(), std::ios::binary | std::ios::trunc);
+        if(!out.good())
+        {
+            std::cout << "PropertySnapshot::save : Error, could not open " << tmpName << std::endl;
+            return false;
+        }
+
+        out.write(MAGIC, sizeof(MAGIC));
+        writeNumber(out, FORMAT_VERSION);
+        writeNumber(out, tasks.size());
+        for(const Task &task: tasks)
+        {
+            writeString(out, task.name);
+            writeNumber(out, task.properties.size());
+            for(const Property &property: task.properties)
+            {
+                writeString(out, property.name);
+                writeString(out, property.typeName);
+                writeNumber(out, property.typeSignature);
+                writeNumber(out, property.data.size());
+                out.write(reinterpret_cast<const char *>(property.data.data()), property.data.size());
+            }
+        }
+
+        out.close();
+        if(!out.good())
+        {
+            std::cout << "PropertySnapshot::save : Error, could not write " << tmpName << std::endl;
+            return false;
+        }
+    }
+
+    //the data must be on disk before the rename, otherwise a crash
+    //may leave an empty file instead of the old one
+    if(!syncPath(tmpName))
+    {
+        std::cout << "PropertySnapshot::save : Error, could not sync " << tmpName << " : " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    if(rename(tmpName.c_str(), fileName.c_str()) != 0)
+    {
+        std::cout << "PropertySnapshot::save : Error, could not rename " << tmpName << " to " << fileName << std::endl;
+        return false;
+    }
+
+    //makes the rename itself durable
+    std::string directory = boost::filesystem::path(fileName).parent_path().string();
+    if(directory.empty())
+        directory = ".";
+    if(!syncPath(directory))
+        std::cout << "PropertySnapshot::save : Warning, could not sync directory " << directory << " : " << strerror(errno) << std::endl;
+    return true;
+}
+
+bool PropertySnapshot::load(const std::string& fileName)
+{
+    OROCOS_CPP_TRACE_SCOPE("PropertySnapshot::load", fileName);
+
+    std::ifstream in(fileName.c_str(), std::ios::binary);
+    if(!in.good())
+    {
+        std::cout << "PropertySnapshot::load : Error, could not open " << fileName << std::endl;
+        return false;
+    }
+
+    char magic[sizeof(MAGIC)];
+    in.read(magic, sizeof(magic));
+    uint64_t version;
+    if(!in.good() || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || !readNumber(in, version))
+    {
+        std::cout << "PropertySnapshot::load : Error, " << fileName << " is not a property snapshot" << std::endl;
+        return false;
+    }
+    if(version != FORMAT_VERSION)
+    {
+        std::cout << "PropertySnapshot::load : Error, " << fileName << " has version " << version << ", expected " << FORMAT_VERSION << std::endl;
+        return false;
+    }
+
+    std::vector<Task> loaded;
+    uint64_t numTasks;
+    bool ok = readNumber(in, numTasks);
+    for(uint64_t i = 0; ok && i < numTasks; i++)
+    {
+        Task task;
+        uint64_t numProperties;
+        ok = readString(in, task.name) && readNumber(in, numProperties);
+        for(uint64_t j = 0; ok && j < numProperties; j++)
+        {
+            Property property;
+            uint64_t size;
+            std::string data;
+            ok = readString(in, property.name) && readString(in, property.typeName) && readNumber(in, property.typeSignature)
+                 && readNumber(in, size) && readBytes(in, size, data);
+            property.data.assign(data.begin(), data.end());
+            task.properties.push_back(property);
+        }
+        loaded.push_back(task);
+    }
+
+    if(!ok)
+    {
+        std::cout << "PropertySnapshot::load : Error, " << fileName << " is truncated or corrupt" << std::endl;
+        return false;
+    }
+
+    tasks.swap(loaded);
+    return true;
+}
+
+std::string PropertySnapshot::toYAML(const std::string& taskName, const std::string& sectionName) const
+{
+    const Task *task = getTask(taskName);
+    if(!task)
+        throw std::runtime_error("PropertySnapshot::toYAML : Error, the snapshot contains no task named " + taskName);
+
+    std::ostringstream out;
+    out << "--- name:" << sectionName << std::endl;
+
+    std::unique_ptr<TypeRegistry> typeRegistry;
+    for(const Property &property: task->properties)
+    {
+        out << property.name << ":";
+
+        const RTT::types::TypeInfo *typeInfo = RTT::types::TypeInfoRepository::Instance()->type(property.typeName);
+        if(!typeInfo)
+        {
+            if(!typeRegistry)
+            {
+                typeRegistry.reset(new TypeRegistry());
+                typeRegistry->loadTypelist();
+            }
+            std::string typekit;
+            if(typeRegistry->getTypekitDefiningType(property.typeName, typekit))
+                PluginHelper::loadTypekitAndTransports(typekit);
+            typeInfo = RTT::types::TypeInfoRepository::Instance()->type(property.typeName);
+        }
+
+        orogen_transports::TypelibMarshallerBase *marshaller = getMarshaller(typeInfo);
+        const Typelib::Type *type = marshaller ? getMarshallingType(marshaller) : nullptr;
+        if(!type || getTypeSignature(*type) != property.typeSignature)
+        {
+            out << " ~ # type " << property.typeName << " is unknown or changed" << std::endl;
+            continue;
+        }
+
+        std::vector<uint8_t> buffer(type->getSize());
+        Typelib::Value value(buffer.data(), *type);
+        Typelib::init(value);
+        try {
+            Typelib::load(value, property.data);
+        } catch (...)
+        {
+            //the data does not match the signature, e.g. a truncated file
+            Typelib::destroy(value);
+            out << " ~ # corrupt" << std::endl;
+            continue;
+        }
+        writeYAML(out, value, 2);
+        Typelib::destroy(value);
+    }
+
+    return out.str();
+}
+
+bool PropertySnapshot::exportYAML(const std::string& directory, const std::string& sectionName) const
+{
+    boost::system::error_code error;
+    boost::filesystem::create_directories(directory, error);
+
+    for(const Task &task: tasks)
+    {
+        const std::string fileName = directory + "/" + task.name + ".yml";
+        std::ofstream out(fileName.c_str(), std::ios::trunc);
+        out << toYAML(task.name, sectionName);
+        if(!out.good())
+        {
+            std::cout << "PropertySnapshot::exportYAML : Error, could not write " << fileName << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+uint64_t PropertySnapshot::getTypeSignature(const Typelib::Type& type)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    hashType(hash, type);
+    return hash;
+}
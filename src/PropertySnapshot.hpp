@@ -0,0 +1,107 @@
+#ifndef PROPERTYSNAPSHOT_H
+#define PROPERTYSNAPSHOT_H
+
+#include <rtt/TaskContext.hpp>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace Typelib
+{
+    class Type;
+}
+
+namespace orocos_cpp
+{
+
+/**
+ * Binary snapshot of the properties of one or more tasks.
+ *
+ * The properties are read through the Typelib marshaller and stored
+ * as Typelib dumps. Restoring writes the dumps straight back into the
+ * properties, without any YAML parsing or per field conversion. Each
+ * property carries a signature of its Typelib type, a snapshot is only
+ * restored into properties whose type did not change since.
+ *
+ * Snapshots can be saved to and loaded from a binary file, and
+ * exported as YAML configuration for diffing. Like the Typelib
+ * dumps, the file uses the byte order of the host.
+ * */
+class PropertySnapshot
+{
+public:
+    struct Property
+    {
+        std::string name;
+        ///RTT name of the type, e.g. /base/samples/RigidBodyState
+        std::string typeName;
+        ///see getTypeSignature
+        uint64_t typeSignature;
+        ///Typelib dump of the marshalling type
+        std::vector<uint8_t> data;
+    };
+
+    struct Task
+    {
+        std::string name;
+        std::vector<Property> properties;
+    };
+
+    /**
+     * Reads all properties of the given task into the snapshot. An
+     * existing snapshot of a task with the same name is replaced.
+     * Properties whose type has no Typelib transport are skipped.
+     * @return false if a property could not be read
+     * */
+    bool addTask(RTT::TaskContext *task);
+
+    /**
+     * Writes the snapshot of the task with the same name back into
+     * its properties. Properties whose type signature changed are skipped.
+     * @return false if the snapshot contains no such task, or if a
+     *         property could not be restored
+     * */
+    bool restore(RTT::TaskContext *task) const;
+
+    bool hasTask(const std::string &taskName) const;
+    const std::vector<Task> &getTasks() const;
+    void clear();
+
+    /**
+     * Writes the snapshot to the given file. The file is replaced
+     * atomically, a crash while saving leaves the old file intact.
+     * */
+    bool save(const std::string &fileName) const;
+
+    /**
+     * Replaces the snapshot by the content of the given file.
+     * */
+    bool load(const std::string &fileName);
+
+    /**
+     * Returns the properties of the given task as YAML config section,
+     * in the format of the orogen configuration files. The typekits
+     * of the property types are loaded if needed.
+     * */
+    std::string toYAML(const std::string &taskName, const std::string &sectionName = "snapshot") const;
+
+    /**
+     * Writes the YAML of every task into <directory>/<taskName>.yml
+     * */
+    bool exportYAML(const std::string &directory, const std::string &sectionName = "snapshot") const;
+
+    /**
+     * Hash over the memory layout of the type, i.e. the names, sizes
+     * and offsets of all fields, array sizes, container kinds and enum
+     * values. Two types with the same signature have compatible dumps.
+     * */
+    static uint64_t getTypeSignature(const Typelib::Type &type);
+
+private:
+    std::vector<Task> tasks;
+
+    const Task *getTask(const std::string &taskName) const;
+};
+
+}//end of namespace
+#endif // PROPERTYSNAPSHOT_H
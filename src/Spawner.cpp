@@ -6,6 +6,9 @@
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <iostream>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <stdio.h>
 #include <string.h>
 #include <sys/types.h>
@@ -14,6 +17,9 @@
 #include <boost/lexical_cast.hpp>
 #include <boost/filesystem.hpp>
 #include "CorbaNameService.hpp"
+#include "FileNameService.hpp"
+#include "Tracing.hpp"
+#include "Executor.hpp"
 #include <lib_config/Bundle.hpp>
 #include <signal.h>
 #include <backward/backward.hpp>
@@ -27,6 +33,17 @@ backward::SignalHandling sh;
 
 void shutdownHandler(int signum, siginfo_t *info, void *data);
 
+/**
+ * Async signal safe output, for the child between fork and exec
+ * */
+void writeToStderr(const char *msg)
+{
+    if(write(STDERR_FILENO, msg, strlen(msg)) < 0)
+    {
+        //nothing left to report to
+    }
+}
+
 void restoreSignalHandler(int signum)
 {
     if(sigaction(signum, originalSignalHandler + signum, nullptr))
@@ -66,13 +83,14 @@ void shutdownHandler(int signum, siginfo_t *info, void *data)
     
 }
 
-Spawner::Spawner()
+Spawner::Spawner() : orbProfile(OrbProfile::getDefault())
 {
     //log dir always exists if requested from bundle
     logDir = Bundle::getInstance().getLogDirectory();
 
-    nameService = new CorbaNameService();
-    nameService->connect();
+    corbaNameService = new CorbaNameService();
+    corbaNameService->connect();
+    nameService = corbaNameService;
 
     setSignalHandler(SIGINT);
     setSignalHandler(SIGQUIT);
@@ -81,31 +99,144 @@ Spawner::Spawner()
     setSignalHandler(SIGTERM);
 }
 
-Spawner& Spawner::getInstace()
+void Spawner::setNameService(NameService* ns)
 {
-    static Spawner *instance = nullptr;
-    
-    if(!instance)
+    if(!ns)
+        throw std::runtime_error("Spawner::setNameService: Error, given name service is null");
+
+    if(ns == nameService)
+        return;
+
+    //the own CORBA connection is kept for bridging the registrations
+    if(nameService != corbaNameService)
+        delete nameService;
+    nameService = ns;
+}
+
+std::vector< bool > Spawner::bridgeRegistrations(const std::vector< std::string >& names)
+{
+    std::vector<bool> registered(names.size(), false);
+    FileNameService *fileNameService = dynamic_cast<FileNameService *>(nameService);
+    if(!fileNameService)
+        return registered;
+
+    std::vector<bool> corbaRegistered = corbaNameService->areRegistered(names);
+    for(size_t i = 0; i < names.size(); i++)
     {
-        instance = new Spawner();
+        if(!corbaRegistered[i])
+            continue;
+
+        //answered from the cache filled by areRegistered
+        std::string ior = corbaNameService->getIOR(names[i]);
+        auto pid = taskPids.find(names[i]);
+        if(ior.empty() || pid == taskPids.end())
+            continue;
+
+        registered[i] = fileNameService->publish(names[i], ior, pid->second);
     }
+    return registered;
+}
+
+NameService& Spawner::getNameService()
+{
+    return *nameService;
+}
+
+void Spawner::setOrbProfile(const OrbProfile& profile)
+{
+    orbProfile = profile;
+}
+
+const OrbProfile& Spawner::getOrbProfile() const
+{
+    return orbProfile;
+}
+
+ProcessPlacement& Spawner::getProcessPlacement()
+{
+    return placement;
+}
+
+ProcessMonitor& Spawner::getProcessMonitor()
+{
+    return monitor;
+}
+
+OutputCollector& Spawner::getOutputCollector()
+{
+    return outputCollector;
+}
+
+Spawner& Spawner::getInstace()
+{
+    //initialization of function local statics is thread safe,
+    //the instance is never deleted, as the signal handlers use it
+    static Spawner *instance = new Spawner();
     
     return *instance;
 }
 
 
-Spawner::ProcessHandle::ProcessHandle(Deployment *deploment, bool redirectOutputv, const std::string &logDir) : isRunning(true), deployment(deploment)
+Spawner::ProcessHandle::ProcessHandle(Deployment *deploment, bool redirectOutputv, const std::string &logDir, const std::vector<std::string> &orbArguments, const PlacementPolicy &placement, const std::string &cgroup, OutputCollector *collector) : isRunning(true), deployment(deploment), outputCollector(collector)
 {
     std::string cmd;
     std::vector< std::string > args;
     
     if(!deployment->getExecString(cmd, args))
         throw std::runtime_error("Error, could not get parameters to start deployment " + deployment->getName() );
+
+    //the deployments pass their command line to ORB_init, which removes the ORB options
+    args.insert(args.end(), orbArguments.begin(), orbArguments.end());
+
+    int stdoutPipe[2];
+    int stderrPipe[2];
+    if(!redirectOutputv)
+        outputCollector = nullptr;
+
+    if(redirectOutputv)
+    {
+        //check if directory exists
+        if(!boost::filesystem::exists(logDir))
+        {
+            throw std::runtime_error("Error, log directory '" + logDir + "' does not exist, but it should !");
+        }
+    }
+
+    //The spawner runs several threads (output collector, executor, name
+    //service poller), one of them may hold the malloc or iostream lock
+    //while we fork. Therefore everything the child needs is prepared
+    //here, the child only uses async signal safe system calls.
+    const PreparedPlacement preparedPlacement = ProcessPlacement::prepare(placement, cgroup);
+
+    std::vector<char *> argv;
+    argv.push_back(const_cast<char *>(cmd.c_str()));
+    for(std::string &arg: args)
+        argv.push_back(const_cast<char *>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    //log file for the direct redirection, the child appends its pid
+    const std::string logFilePrefix = logDir + "/" + cmd + "-";
+    std::vector<char> logFileName;
+    if(redirectOutputv && !outputCollector)
+    {
+        logFileName.assign(logFilePrefix.begin(), logFilePrefix.end());
+        logFileName.resize(logFilePrefix.size() + 32, '\0');
+    }
+
+    if(outputCollector)
+    {
+        if(!OutputCollector::createPipes(stdoutPipe, stderrPipe))
+        {
+            throw std::runtime_error(std::string("Error, could not create output pipes : ") + strerror(errno));
+        }
+    }
     
     pid = fork();
     
     if(pid < 0)
     {
+        if(outputCollector)
+            OutputCollector::closePipes(stdoutPipe, stderrPipe);
         throw std::runtime_error("Fork Failed");
     }
     
@@ -113,42 +244,32 @@ Spawner::ProcessHandle::ProcessHandle(Deployment *deploment, bool redirectOutput
     if(pid != 0)
     {
         processName = deploment->getName();
+        if(outputCollector)
+            outputCollector->addProcess(processName, logFilePrefix + boost::lexical_cast<std::string>(pid) + ".txt", stdoutPipe, stderrPipe);
         return;
     }
 
     //child, redirect output
-    if(redirectOutputv)
+    if(outputCollector)
     {
-        //check if directory exists, and create if not
-        if(!boost::filesystem::exists(logDir))
-        {
-            throw std::runtime_error("Error, log directory '" + logDir + "' does not exist, but it should !");
-        }
-        redirectOutput(logDir + "/" + cmd + "-" + boost::lexical_cast<std::string>(getpid()) + ".txt");
-        processName = deploment->getName();
+        if(!OutputCollector::redirectIntoPipes(stdoutPipe, stderrPipe))
+            writeToStderr("Error, could not redirect output into pipes\n");
     }
-    
-    //do the exec
-    
-    char * argv[args.size() + 2];
-
-    argv[0] = const_cast<char *>(cmd.c_str());
-    
-    argv[args.size() +1] = nullptr;
-    
-    for(size_t i = 0; i <  args.size(); i++)
+    else if(!logFileName.empty())
     {
-        argv[i + 1] = const_cast<char *>(args[i].c_str());
+        redirectOutput(logFileName.data(), logFilePrefix.size());
     }
     
-    execvp(cmd.c_str(), argv);
-    
-    //failure case
-    std::cout << "Start of " << cmd << " failed:" << strerror(errno) << std::endl;
-    
-    throw std::runtime_error(std::string("Start of ") + cmd + " failed:" + strerror(errno));
+    ProcessPlacement::apply(preparedPlacement);
+
+    //do the exec
+    execvp(argv[0], argv.data());
     
-    exit(EXIT_FAILURE);
+    //failure case, the child must not return into the code of the spawner
+    writeToStderr("Start of ");
+    writeToStderr(argv[0]);
+    writeToStderr(" failed\n");
+    _exit(EXIT_FAILURE);
 }
 
 bool Spawner::ProcessHandle::alive() const
@@ -177,6 +298,11 @@ bool Spawner::ProcessHandle::alive() const
         int exitStatus = WEXITSTATUS(status);
         std::cout << "Process " << pid << " terminated normaly, return code " << exitStatus << std::endl;
         isRunning = false;
+
+        if(exitStatus && outputCollector)
+        {
+            std::cout << "Last output of " << processName << " :" << std::endl << getOutputTail() << std::endl;
+        }
     }
     
     if(WIFSIGNALED(status))
@@ -194,6 +320,11 @@ bool Spawner::ProcessHandle::alive() const
         {
             std::cout << "Process " << processName << " was terminated by SIG " << sigNum << std::endl;                        
         }
+
+        if(outputCollector)
+        {
+            std::cout << "Last output of " << processName << " :" << std::endl << getOutputTail() << std::endl;
+        }
         
     }
     
@@ -207,6 +338,19 @@ const Deployment& Spawner::ProcessHandle::getDeployment() const
     return *deployment;
 }
 
+pid_t Spawner::ProcessHandle::getPid() const
+{
+    return pid;
+}
+
+std::string Spawner::ProcessHandle::getOutputTail() const
+{
+    if(!outputCollector)
+        return std::string();
+
+    return outputCollector->getTail(processName);
+}
+
 void Spawner::ProcessHandle::sendSigKill() const
 {
     if(kill(pid, SIGKILL))
@@ -241,12 +385,21 @@ Spawner::ProcessHandle &Spawner::spawnTask(const std::string& cmp1, const std::s
 
 Spawner::ProcessHandle& Spawner::spawnDeployment(Deployment* deployment, bool redirectOutput)
 {
-    ProcessHandle *handle = new ProcessHandle(deployment, redirectOutput, logDir);
+    OROCOS_CPP_TRACE_SCOPE("Spawner::spawnDeployment", deployment->getName());
+    PlacementPolicy policy = placement.resolve(deployment->getName());
+    std::string cgroup = placement.prepareCGroup(deployment->getName(), policy);
+    ProcessHandle *handle = new ProcessHandle(deployment, redirectOutput, logDir, orbProfile.getArguments(), policy, cgroup, &outputCollector);
     
     handles.push_back(handle);
+    monitor.addProcess(handle->getPid(), deployment->getName());
 
     for(const std::string &task: deployment->getTaskNames())
     {
+        //a cached registration may belong to a previous run
+        nameService->invalidate(task);
+        if(nameService != corbaNameService)
+            corbaNameService->invalidate(task);
+        taskPids[task] = handle->getPid();
         notReadyList.push_back(task);
     }
     
@@ -277,27 +430,76 @@ bool Spawner::checkAllProcesses()
 
 bool Spawner::allReady()
 {
-    auto it = notReadyList.begin();
-    for(;it != notReadyList.end(); it++)
+    OROCOS_CPP_TRACE_SCOPE("Spawner::allReady");
+    if(notReadyList.empty())
+        return true;
+
+    //all remaining tasks are checked concurrently
+    std::vector<bool> registered = nameService->areRegistered(notReadyList);
+    std::vector<std::string> stillNotReady;
+    for(size_t i = 0; i < notReadyList.size(); i++)
     {
-        if(nameService->isRegistered(*it))
+        if(!registered[i])
+            stillNotReady.push_back(notReadyList[i]);
+    }
+
+    if(!stillNotReady.empty() && nameService != corbaNameService)
+    {
+        std::vector<bool> bridged = bridgeRegistrations(stillNotReady);
+        std::vector<std::string> notBridged;
+        for(size_t i = 0; i < stillNotReady.size(); i++)
         {
-            it = notReadyList.erase(it);
+            if(!bridged[i])
+                notBridged.push_back(stillNotReady[i]);
         }
-        
-        if(it == notReadyList.end())
-            break;
+        stillNotReady.swap(notBridged);
     }
+    notReadyList.swap(stillNotReady);
     
     return notReadyList.empty();
 }
 
+std::future<void> Spawner::waitUntilAllReadyAsync(const base::Time& timeout)
+{
+    return Executor::getDefault().submit([this, timeout]() {
+        waitUntilAllReady(timeout);
+    });
+}
+
 void Spawner::waitUntilAllReady(const base::Time& timeout)
 {
+    OROCOS_CPP_TRACE_SCOPE("Spawner::waitUntilAllReady");
     base::Time start = base::Time::now();
+
+    //wake up on registrations, if the name service can report them.
+    //Shared with the callback, which may still run after unwatch
+    struct Notification
+    {
+        std::mutex mutex;
+        std::condition_variable changed;
+    };
+    std::shared_ptr<Notification> notification(std::make_shared<Notification>());
+    int watchId = -1;
+    try {
+        watchId = nameService->watch([notification](const NameService::ChangeEvent &) {
+            std::lock_guard<std::mutex> lock(notification->mutex);
+            notification->changed.notify_all();
+        });
+    } catch (const std::runtime_error &)
+    {
+    }
+
     while(!allReady())
     {
-        usleep(10000);
+        if(watchId >= 0)
+        {
+            //the timeout covers events that arrive between allReady and the
+            //wait, and name services that notice registrations late
+            std::unique_lock<std::mutex> lock(notification->mutex);
+            notification->changed.wait_for(lock, std::chrono::milliseconds(50));
+        }
+        else
+            usleep(10000);
         
         if(base::Time::now() - start > timeout)
         {
@@ -307,14 +509,20 @@ void Spawner::waitUntilAllReady(const base::Time& timeout)
                 std::cout << "    " << name << std::endl;
             }
             std::cout << "did not register at nameservice" << std::endl;
+            if(watchId >= 0)
+                nameService->unwatch(watchId);
             killAll();
             throw std::runtime_error("Spawner::waitUntilAllReady: Error timeout while waiting for tasks to register at nameservice");
         }
     }
+
+    if(watchId >= 0)
+        nameService->unwatch(watchId);
 }
 
 void Spawner::killAll()
 {
+    OROCOS_CPP_TRACE_SCOPE("Spawner::killAll");
     //ask all processes to terminate
     for(ProcessHandle *handle : handles)
     {
@@ -366,25 +574,41 @@ void Spawner::sendSigTerm()
 }
 
 
-void Spawner::ProcessHandle::redirectOutput(const std::string& filename)
+void Spawner::ProcessHandle::redirectOutput(char* fileName, size_t pidOffset)
 {
-    int newFd = open(filename.c_str(), O_WRONLY | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
-    if(!newFd)
+    //called in the child after fork, only async signal safe calls
+    char digits[32];
+    size_t count = 0;
+    unsigned long value = getpid();
+    do {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while(value);
+
+    char *end = fileName + pidOffset;
+    while(count)
+        *end++ = digits[--count];
+    const char ending[] = ".txt";
+    for(size_t i = 0; i < sizeof(ending); i++)
+        *end++ = ending[i];
+
+    int newFd = open(fileName, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if(newFd < 0)
     {
-        std::cout << "Error, could not redirect cout to " << filename << std::endl;
+        writeToStderr("Error, could not redirect output to ");
+        writeToStderr(fileName);
+        writeToStderr("\n");
         return;
     }
     
-    if(dup2(newFd, fileno(stdout))  == -1)
-    {
-        std::cout << "Error, could not redirect cout to " << filename << std::endl;
-        return;
-    }
-    if(dup2(newFd, fileno(stderr))  == -1)
+    //dup2 clears the close on exec flag of the new descriptors
+    if(dup2(newFd, STDOUT_FILENO) == -1 || dup2(newFd, STDERR_FILENO) == -1)
     {
-        std::cout << "Error, could not redirect cerr to " << filename << std::endl;
-        return;
+        writeToStderr("Error, could not redirect output to ");
+        writeToStderr(fileName);
+        writeToStderr("\n");
     }
+    close(newFd);
 }
 
 std::vector< const Deployment* > Spawner::getRunningDeployments()
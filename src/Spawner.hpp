@@ -7,11 +7,19 @@
 #include <base/Time.hpp>
 #include "NameService.hpp"
 #include "Deployment.hpp"
+#include "OrbProfile.hpp"
+#include "ProcessPlacement.hpp"
+#include "ProcessMonitor.hpp"
+#include "OutputCollector.hpp"
 #include <boost/noncopyable.hpp>
+#include <future>
+#include <map>
 
 namespace orocos_cpp
 {
 
+class CorbaNameService;
+
 class Spawner : public boost::noncopyable
 {
     std::string logDir;
@@ -20,6 +28,25 @@ class Spawner : public boost::noncopyable
     std::vector<std::string> notReadyList;
     
     NameService *nameService;
+
+    //the deployments register at the CORBA naming service. If another
+    //name service is used, their registrations are copied from here
+    CorbaNameService *corbaNameService;
+
+    //pid of the process serving each spawned task
+    std::map<std::string, pid_t> taskPids;
+
+    //ORB options passed to the spawned deployments
+    OrbProfile orbProfile;
+
+    //cpu, scheduling and memory placement of the spawned deployments
+    ProcessPlacement placement;
+
+    //resource usage of the spawned deployments
+    ProcessMonitor monitor;
+
+    //drains the redirected output of the spawned deployments
+    OutputCollector outputCollector;
     
     
     /**
@@ -27,19 +54,49 @@ class Spawner : public boost::noncopyable
      * */
     Spawner();    
 
+    /**
+     * Publishes the CORBA registrations of the given tasks at a
+     * FileNameService, if that is the name service in use.
+     * @return for each task, true if it is registered now
+     * */
+    std::vector<bool> bridgeRegistrations(const std::vector<std::string> &names);
+
 public:
     class ProcessHandle
     {
         mutable bool isRunning;
         pid_t pid;
-        void redirectOutput(const std::string &filename);
+        /**
+         * Redirects stdout and stderr into the given file. Is called in the
+         * child after fork, appends the pid and ".txt" at pidOffset
+         * to the preallocated fileName.
+         * */
+        static void redirectOutput(char *fileName, size_t pidOffset);
         std::string processName;
         
         Deployment *deployment;
+        OutputCollector *outputCollector;
     public:
-        ProcessHandle(Deployment *deployment, bool redirectOutput, const std::string &logDir);
+        /**
+         * @arg orbArguments Additional ORB options appended to the command line
+         * @arg placement Placement applied to the process before exec
+         * @arg cgroup cgroup the process joins before exec, empty for none
+         * @arg outputCollector If given, the redirected output is written into
+         *      pipes drained by the collector, instead of directly into the log file
+         * */
+        ProcessHandle(Deployment *deployment, bool redirectOutput, const std::string &logDir,
+                      const std::vector<std::string> &orbArguments = std::vector<std::string>(),
+                      const PlacementPolicy &placement = PlacementPolicy(), const std::string &cgroup = std::string(),
+                      OutputCollector *outputCollector = nullptr);
         
         const Deployment &getDeployment() const;
+        pid_t getPid() const;
+
+        /**
+         * Returns the last output of the process, if
+         * it is captured by an OutputCollector.
+         * */
+        std::string getOutputTail() const;
         bool alive() const;
         void sendSigInt() const;
         void sendSigTerm() const;
@@ -54,6 +111,52 @@ public:
      * */
     static Spawner &getInstace();
     
+    /**
+     * Replaces the name service used to check if spawned tasks
+     * are reachable. Default is the CorbaNameService.
+     * The spawner takes ownership of the given name service.
+     * The name service needs to be connected.
+     *
+     * The deployments only register at the CORBA naming service. If a
+     * FileNameService is given, the spawner looks up the tasks it spawned
+     * there and publishes their IORs at the FileNameService, under the
+     * pid of the deployment. Other name services are used as they are.
+     * */
+    void setNameService(NameService *nameService);
+
+    /**
+     * Returns the name service used by the spawner.
+     * */
+    NameService &getNameService();
+
+    /**
+     * Sets the ORB options that are passed on the command line
+     * of all deployments spawned afterwards.
+     * Default is OrbProfile::getDefault().
+     * */
+    void setOrbProfile(const OrbProfile &profile);
+    const OrbProfile &getOrbProfile() const;
+
+    /**
+     * Returns the placement policies for the spawned deployments.
+     * Policies are looked up by deployment name and applied
+     * to all deployments spawned afterwards.
+     * */
+    ProcessPlacement &getProcessPlacement();
+
+    /**
+     * Returns the resource monitor. All spawned deployments are
+     * added to it under their deployment name. Call
+     * ProcessMonitor::start to sample them periodically.
+     * */
+    ProcessMonitor &getProcessMonitor();
+
+    /**
+     * Returns the collector of the redirected deployment output,
+     * e.g. to configure rotation and compression.
+     * */
+    OutputCollector &getOutputCollector();
+
     /**
      * This method spawns a default deployment matching the given componente description.
      * If a second argument is given, the task will be renamed to the given name.
@@ -104,6 +207,13 @@ public:
      * be reached.
      * */
     void waitUntilAllReady(const base::Time &timeout);
+
+    /**
+     * Calls waitUntilAllReady in Executor::getDefault(). No tasks
+     * should be spawned or killed until the future is ready. The
+     * runtime error is rethrown by std::future::get.
+     * */
+    std::future<void> waitUntilAllReadyAsync(const base::Time &timeout);
     
     /**
      * This method first sends a sigterm to all processes
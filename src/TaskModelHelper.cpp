@@ -0,0 +1,200 @@
+#include "TaskModelHelper.hpp"
+#include "PkgConfigHelper.hpp"
+#include "Tracing.hpp"
+#include <boost/filesystem.hpp>
+#include <boost/regex.hpp>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <cctype>
+
+#define xstr(s) str(s)
+#define str(s) #s
+
+using namespace orocos_cpp;
+
+std::string TaskModelHelper::getOrogenFile(const std::string& componentName)
+{
+    std::vector<std::string> pkgConfigFields;
+    pkgConfigFields.push_back("prefix");
+    pkgConfigFields.push_back("deffile");
+    std::vector<std::string> pkgConfigValues;
+
+    try {
+        if(PkgConfigHelper::parsePkgConfig(componentName + std::string("-tasks-") + xstr(OROCOS_TARGET) + std::string(".pc"), pkgConfigFields, pkgConfigValues))
+        {
+            std::string deffile = pkgConfigValues[1];
+            PkgConfigHelper::solveString(deffile, "${prefix}", pkgConfigValues[0]);
+            if(boost::filesystem::exists(deffile))
+                return deffile;
+        }
+    } catch (const std::runtime_error &)
+    {
+        //no pkg-config file, try the orogen directory
+    }
+
+    const char *pathsC = getenv("ROCK_PREFIX");
+    if(!pathsC)
+        return std::string();
+
+    boost::filesystem::path candidate(std::string(pathsC) + "/../orogen/" + componentName + ".orogen");
+    if(boost::filesystem::exists(candidate))
+        return candidate.string();
+
+    return std::string();
+}
+
+namespace
+{
+
+std::map<std::string, std::string> createCTypeMap()
+{
+    std::map<std::string, std::string> cTypes;
+    cTypes["int"] = "/int32_t";
+    cTypes["unsigned int"] = "/uint32_t";
+    cTypes["short"] = "/int16_t";
+    cTypes["unsigned short"] = "/uint16_t";
+    cTypes["char"] = "/int8_t";
+    cTypes["unsigned char"] = "/uint8_t";
+    cTypes["long long"] = "/int64_t";
+    cTypes["unsigned long long"] = "/uint64_t";
+    return cTypes;
+}
+
+}
+
+std::string TaskModelHelper::normalizeTypeName(const std::string& typeName)
+{
+    static const std::map<std::string, std::string> cTypes(createCTypeMap());
+
+    std::string name = typeName;
+    auto it = cTypes.find(name);
+    if(it != cTypes.end())
+        return it->second;
+
+    //C++ namespaces to Typelib namespaces
+    size_t pos;
+    while((pos = name.find("::")) != std::string::npos)
+        name.replace(pos, 2, "/");
+
+    //every type name and template argument starts with a '/'
+    std::string ret;
+    bool startOfName = true;
+    for(char c: name)
+    {
+        if(c == ' ')
+            continue;
+        if(startOfName && c != '/' && !isdigit(c))
+            ret.push_back('/');
+        ret.push_back(c);
+        startOfName = (c == '<' || c == ',');
+    }
+    return ret;
+}
+
+bool TaskModelHelper::getPropertyTypes(const std::string& modelName, std::map< std::string, std::string >& propertyTypes)
+{
+    OROCOS_CPP_TRACE_SCOPE("TaskModelHelper::getPropertyTypes", modelName);
+
+    std::string::size_type pos = modelName.find("::");
+    if(pos == std::string::npos)
+        throw std::runtime_error("TaskModelHelper::Error, given model name " + modelName + " is not in the format 'module::TaskSpec'");
+
+    std::string componentName = modelName.substr(0, pos);
+    std::string taskName = modelName.substr(pos + 2);
+
+    std::string orogenFile = getOrogenFile(componentName);
+    if(orogenFile.empty())
+    {
+        std::cout << "TaskModelHelper::Error, could not find orogen file of component " << componentName << std::endl;
+        return false;
+    }
+
+    std::ifstream in(orogenFile.c_str());
+    if(!in.good())
+    {
+        std::cout << "TaskModelHelper::Error, could not open " << orogenFile << std::endl;
+        return false;
+    }
+
+    static const boost::regex taskRegex("^\\s*task_context\\s*\\(?\\s*[\"']([^\"']+)[\"'](.*)$");
+    static const boost::regex subclassesRegex("subclasses\\s*\\(?\\s*:?\\s*[\"']([^\"']+)[\"']");
+    static const boost::regex propertyRegex("^\\s*property\\s*\\(?\\s*[\"']([^\"']+)[\"']\\s*,\\s*[\"']([^\"']+)[\"']");
+    //ruby constructs closed by 'end'
+    static const boost::regex blockStartRegex("(^\\s*(if|unless|while|until|case|begin|def|class|module)\\b)|(\\bdo\\s*(\\|[^|]*\\|)?\\s*(#.*)?$)");
+    static const boost::regex blockEndRegex("^\\s*end\\b");
+    static const boost::regex commentRegex("^\\s*#");
+
+    bool found = false;
+    bool inTask = false;
+    //nesting within the block of the task, 0 if the task has no block
+    int depth = 0;
+    std::string parentModel;
+    std::string line;
+    while(std::getline(in, line))
+    {
+        if(boost::regex_search(line, commentRegex))
+            continue;
+
+        boost::smatch match;
+        if(boost::regex_search(line, match, taskRegex))
+        {
+            inTask = (match[1] == taskName);
+            found |= inTask;
+            depth = boost::regex_search(line, blockStartRegex) ? 1 : 0;
+            boost::smatch parentMatch;
+            std::string rest = match[2];
+            if(inTask && boost::regex_search(rest, parentMatch, subclassesRegex))
+                parentModel = parentMatch[1];
+            continue;
+        }
+
+        if(!inTask)
+            continue;
+
+        if(depth)
+        {
+            if(boost::regex_search(line, blockEndRegex))
+            {
+                depth--;
+                if(!depth)
+                {
+                    //the block of the task is closed
+                    inTask = false;
+                    continue;
+                }
+            }
+            else if(boost::regex_search(line, blockStartRegex))
+                depth++;
+        }
+
+        if(boost::regex_search(line, match, subclassesRegex) && line.find("property") == std::string::npos)
+        {
+            parentModel = match[1];
+            continue;
+        }
+
+        if(boost::regex_search(line, match, propertyRegex))
+            propertyTypes[match[1]] = normalizeTypeName(match[2]);
+    }
+
+    if(!found)
+    {
+        std::cout << "TaskModelHelper::Error, task " << taskName << " not found in " << orogenFile << std::endl;
+        return false;
+    }
+
+    //subclasses within the same project may omit the project name
+    if(!parentModel.empty() && parentModel.find("::") == std::string::npos)
+        parentModel = componentName + "::" + parentModel;
+
+    if(!parentModel.empty() && parentModel != "RTT::TaskContext" && parentModel != modelName)
+    {
+        //properties of the task itself override the ones of the parent
+        std::map<std::string, std::string> parentTypes;
+        if(getPropertyTypes(parentModel, parentTypes))
+            propertyTypes.insert(parentTypes.begin(), parentTypes.end());
+    }
+
+    return true;
+}
@@ -0,0 +1,41 @@
+#ifndef TASKMODELHELPER_H
+#define TASKMODELHELPER_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+namespace orocos_cpp
+{
+
+class TaskModelHelper
+{
+public:
+    /**
+     * Returns the path of the orogen description file (project.orogen)
+     * of the given component. The path is taken from the deffile
+     * field of the tasks pkg-config file, if the field is missing
+     * ROCK_PREFIX/../orogen is searched.
+     * */
+    static std::string getOrogenFile(const std::string &componentName);
+
+    /**
+     * Reads the properties of a task model from the installed orogen
+     * description file, without contacting any running task.
+     * Properties of parent models (subclasses) are included.
+     *
+     * @param modelName The task model e.g. "hokuyo::Task"
+     * @param propertyTypes Will contain property name -> Typelib type name
+     * @return false if the model could not be found
+     * */
+    static bool getPropertyTypes(const std::string &modelName, std::map<std::string, std::string> &propertyTypes);
+
+    /**
+     * Converts a type name as written in an orogen file (e.g. "base::Time",
+     * "std/string", "int") into its Typelib name (e.g. "/base/Time").
+     * */
+    static std::string normalizeTypeName(const std::string &typeName);
+};
+
+}//end of namespace
+#endif // TASKMODELHELPER_H
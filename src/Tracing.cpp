@@ -0,0 +1,249 @@
+#include "Tracing.hpp"
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+using namespace orocos_cpp;
+
+namespace
+{
+
+void writeJsonString(std::ostream &out, const char *str)
+{
+    out << '"';
+    for(const char *c = str; *c; c++)
+    {
+        switch(*c)
+        {
+            case '"':
+                out << "\\\"";
+                break;
+            case '\\':
+                out << "\\\\";
+                break;
+            case '\n':
+                out << "\\n";
+                break;
+            default:
+                if(static_cast<unsigned char>(*c) < 0x20)
+                    out << ' ';
+                else
+                    out << *c;
+        }
+    }
+    out << '"';
+}
+
+void copyDetail(char *dest, const char *src)
+{
+    if(!src)
+    {
+        dest[0] = '\0';
+        return;
+    }
+    strncpy(dest, src, Tracer::MAX_DETAIL_LENGTH - 1);
+    dest[Tracer::MAX_DETAIL_LENGTH - 1] = '\0';
+}
+
+void dumpTraceOnExit()
+{
+    const char *fileName = getenv("OROCOS_CPP_TRACE");
+    if(!fileName || !*fileName)
+        return;
+
+    if(!Tracer::getInstance().dumpChromeTrace(fileName))
+        std::cout << "Tracer: Error, could not write trace to " << fileName << std::endl;
+}
+
+}
+
+Tracer::Tracer() : enabled(false), writeIndex(0)
+{
+    slots = new Slot[BUFFER_SIZE];
+    for(size_t i = 0; i < BUFFER_SIZE; i++)
+        slots[i].sequence.store(0, std::memory_order_relaxed);
+
+    const char *fileName = getenv("OROCOS_CPP_TRACE");
+    if(fileName && *fileName)
+    {
+        enabled.store(true);
+        atexit(dumpTraceOnExit);
+    }
+}
+
+Tracer::~Tracer()
+{
+    delete[] slots;
+}
+
+Tracer& Tracer::getInstance()
+{
+    //never destroyed, spans may still be recorded during static destruction
+    static Tracer *instance = new Tracer();
+    return *instance;
+}
+
+void Tracer::enable()
+{
+    enabled.store(true);
+}
+
+void Tracer::disable()
+{
+    enabled.store(false);
+}
+
+void Tracer::clear()
+{
+    for(size_t i = 0; i < BUFFER_SIZE; i++)
+        slots[i].sequence.store(0, std::memory_order_release);
+}
+
+int64_t Tracer::now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+uint64_t Tracer::getThreadId()
+{
+    static thread_local uint64_t tid = syscall(SYS_gettid);
+    return tid;
+}
+
+void Tracer::record(const char* name, const char* detail, int64_t start, int64_t end)
+{
+    uint64_t idx = writeIndex.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot(slots[idx % BUFFER_SIZE]);
+
+    //seqlock, readers drop slots that changed while they were copied
+    slot.sequence.store(2 * idx + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.event.name = name;
+    copyDetail(slot.event.detail, detail);
+    slot.event.threadId = getThreadId();
+    slot.event.start = start;
+    slot.event.duration = end - start;
+
+    slot.sequence.store(2 * idx + 2, std::memory_order_release);
+}
+
+std::vector< Tracer::Event > Tracer::getEvents() const
+{
+    std::vector<std::pair<uint64_t, Event> > collected;
+    collected.reserve(BUFFER_SIZE);
+
+    for(size_t i = 0; i < BUFFER_SIZE; i++)
+    {
+        const Slot &slot(slots[i]);
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if(before == 0 || before % 2)
+            continue;
+
+        Event copy = slot.event;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(slot.sequence.load(std::memory_order_relaxed) != before)
+            continue;
+
+        collected.push_back(std::make_pair(before, copy));
+    }
+
+    std::sort(collected.begin(), collected.end(),
+              [](const std::pair<uint64_t, Event> &a, const std::pair<uint64_t, Event> &b) { return a.first < b.first; });
+
+    std::vector<Event> ret;
+    ret.reserve(collected.size());
+    for(const std::pair<uint64_t, Event> &e: collected)
+        ret.push_back(e.second);
+
+    return ret;
+}
+
+bool Tracer::dumpChromeTrace(const std::string& fileName) const
+{
+    std::ofstream out(fileName.c_str());
+    if(!out.good())
+        return false;
+
+    pid_t pid = getpid();
+    std::vector<Event> events = getEvents();
+
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    for(const Event &e: events)
+    {
+        if(!first)
+            out << ",";
+        first = false;
+
+        out << "\n{\"name\":";
+        writeJsonString(out, e.name);
+        out << ",\"cat\":\"orocos_cpp\",\"ph\":\"X\",\"ts\":" << e.start
+            << ",\"dur\":" << e.duration
+            << ",\"pid\":" << pid
+            << ",\"tid\":" << e.threadId;
+        if(e.detail[0])
+        {
+            out << ",\"args\":{\"detail\":";
+            writeJsonString(out, e.detail);
+            out << "}";
+        }
+        out << "}";
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}" << std::endl;
+
+    return out.good();
+}
+
+TraceScope::TraceScope(const char* name) : name(name), start(0), active(false)
+{
+    begin(nullptr);
+}
+
+TraceScope::TraceScope(const char* name, const char* detail) : name(name), start(0), active(false)
+{
+    begin(detail);
+}
+
+TraceScope::TraceScope(const char* name, const std::string& detail) : name(name), start(0), active(false)
+{
+    if(Tracer::getInstance().isEnabled())
+        begin(detail.c_str());
+}
+
+void TraceScope::begin(const char* detail)
+{
+    if(!Tracer::getInstance().isEnabled())
+        return;
+
+    active = true;
+    copyDetail(this->detail, detail);
+    start = Tracer::now();
+}
+
+void TraceScope::setDetail(const char* detail)
+{
+    if(active)
+        copyDetail(this->detail, detail);
+}
+
+void TraceScope::setDetail(const std::string& detail)
+{
+    setDetail(detail.c_str());
+}
+
+TraceScope::~TraceScope()
+{
+    if(!active)
+        return;
+
+    Tracer::getInstance().record(name, detail, start, Tracer::now());
+}
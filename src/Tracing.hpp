@@ -0,0 +1,165 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace orocos_cpp
+{
+
+/**
+ * Lightweight tracer for the bring-up phase of a system.
+ *
+ * Spans are recorded into a fixed size, lock free ring buffer
+ * and can be dumped in the Chrome trace event format, which
+ * can be viewed with chrome://tracing or https://ui.perfetto.dev
+ *
+ * The tracer is disabled by default, in this case recording a
+ * span costs one relaxed atomic load. If the environment variable
+ * OROCOS_CPP_TRACE is set, tracing is enabled on startup and the
+ * trace is written to the file given in the variable on exit.
+ * */
+class Tracer
+{
+public:
+    static const size_t MAX_DETAIL_LENGTH = 64;
+
+    struct Event
+    {
+        /**
+         * Name of the span, must be a string literal
+         * */
+        const char *name;
+        /**
+         * Additional information, e.g. the name of the typekit
+         * */
+        char detail[MAX_DETAIL_LENGTH];
+        uint64_t threadId;
+        /**
+         * Start time and duration in microseconds, CLOCK_MONOTONIC
+         * */
+        int64_t start;
+        int64_t duration;
+    };
+
+    /**
+     * Returns the process wide tracer instance
+     * */
+    static Tracer &getInstance();
+
+    bool isEnabled() const
+    {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    void enable();
+    void disable();
+
+    /**
+     * Drops all recorded events
+     * */
+    void clear();
+
+    /**
+     * Records a finished span. If more than BUFFER_SIZE events
+     * are recorded, the oldest ones get overwritten.
+     * */
+    void record(const char *name, const char *detail, int64_t start, int64_t end);
+
+    /**
+     * Returns a copy of all recorded events, ordered by the
+     * time they were recorded.
+     * */
+    std::vector<Event> getEvents() const;
+
+    /**
+     * Writes all recorded events as Chrome trace event JSON
+     * to the given file.
+     * @return false if the file could not be written
+     * */
+    bool dumpChromeTrace(const std::string &fileName) const;
+
+    /**
+     * Returns the current monotonic time in microseconds
+     * */
+    static int64_t now();
+
+    /**
+     * Returns the kernel thread id of the calling thread
+     * */
+    static uint64_t getThreadId();
+
+private:
+    Tracer();
+    ~Tracer();
+
+    static const size_t BUFFER_SIZE = 16384;
+
+    struct Slot
+    {
+        //odd while the slot is written, 0 if never written
+        std::atomic<uint64_t> sequence;
+        Event event;
+    };
+
+    std::atomic<bool> enabled;
+    std::atomic<uint64_t> writeIndex;
+    Slot *slots;
+};
+
+/**
+ * Records the lifetime of this object as span,
+ * if the tracer is enabled.
+ * */
+class TraceScope
+{
+    const char *name;
+    char detail[Tracer::MAX_DETAIL_LENGTH];
+    int64_t start;
+    bool active;
+
+    void begin(const char *detail);
+public:
+    TraceScope(const char *name);
+    TraceScope(const char *name, const char *detail);
+    TraceScope(const char *name, const std::string &detail);
+    ~TraceScope();
+
+    bool isActive() const
+    {
+        return active;
+    }
+
+    /**
+     * Sets the detail of an active span, used by OROCOS_CPP_TRACE_SCOPE
+     * to build the detail only if the tracer is enabled.
+     * */
+    void setDetail(const char *detail);
+    void setDetail(const std::string &detail);
+};
+
+}//end of namespace
+
+#define OROCOS_CPP_TRACE_CONCAT_IMPL(a, b) a##b
+#define OROCOS_CPP_TRACE_CONCAT(a, b) OROCOS_CPP_TRACE_CONCAT_IMPL(a, b)
+
+#define OROCOS_CPP_TRACE_SELECT(_1, _2, MACRO, ...) MACRO
+#define OROCOS_CPP_TRACE_VAR OROCOS_CPP_TRACE_CONCAT(orocosCppTraceScope, __LINE__)
+#define OROCOS_CPP_TRACE_SCOPE_NAME(name) ::orocos_cpp::TraceScope OROCOS_CPP_TRACE_VAR(name)
+#define OROCOS_CPP_TRACE_SCOPE_DETAIL(name, detail) \
+    ::orocos_cpp::TraceScope OROCOS_CPP_TRACE_VAR(name); \
+    if(OROCOS_CPP_TRACE_VAR.isActive()) \
+        OROCOS_CPP_TRACE_VAR.setDetail(detail)
+
+/**
+ * Traces the enclosing scope.
+ * Usage : OROCOS_CPP_TRACE_SCOPE("name") or OROCOS_CPP_TRACE_SCOPE("name", detailExpression)
+ *
+ * The detail expression is only evaluated if the tracer is enabled,
+ * so it may build strings without slowing down untraced runs.
+ * */
+#define OROCOS_CPP_TRACE_SCOPE(...) OROCOS_CPP_TRACE_SELECT(__VA_ARGS__, OROCOS_CPP_TRACE_SCOPE_DETAIL, OROCOS_CPP_TRACE_SCOPE_NAME, unused)(__VA_ARGS__)
+
+#endif // TRACING_H
@@ -7,6 +7,9 @@
 #include <transformer/Transformer.hpp>
 #include <transformer/BroadcastTypes.hpp>
 #include <rtt/transports/corba/TaskContextProxy.hpp>
+#include "Tracing.hpp"
+#include "Executor.hpp"
+#include "PartialTaskContextProxy.hpp"
 
 using namespace orocos_cpp;
 
@@ -15,8 +18,16 @@ TransformerHelper::TransformerHelper(const smurf::Robot& robotConfiguration): co
 }
 
 
+std::future<bool> TransformerHelper::configureTransformerAsync(RTT::TaskContext* task)
+{
+    return Executor::getDefault().submit([this, task]() {
+        return configureTransformer(task);
+    });
+}
+
 bool TransformerHelper::configureTransformer(RTT::TaskContext* task)
 {
+    OROCOS_CPP_TRACE_SCOPE("TransformerHelper::configureTransformer", task->getName());
     const std::string opName("getNeededTransformations");
     
     //test if the task actually uses the transformer
@@ -82,9 +93,9 @@ bool TransformerHelper::configureTransformer(RTT::TaskContext* task)
             }
             
             //get task context and connect them
-            RTT::corba::TaskContextProxy *proxy = NULL;
+            PartialTaskContextProxy *proxy = NULL;
             try {
-                proxy = RTT::corba::TaskContextProxy::Create(prov->providerName, false);
+                proxy = PartialTaskContextProxy::Create(prov->providerName, false);
             } catch (...) {
                 //if below handles the error, nothing to do here
             }
@@ -96,14 +107,14 @@ bool TransformerHelper::configureTransformer(RTT::TaskContext* task)
                 return false;
             }
             
-            RTT::base::PortInterface *port = proxy->getPort(prov->portName);
+            RTT::base::PortInterface *port = proxy->fetchPort(prov->portName);
             if(!port)
             {
                 std::cout << "Error, task " << prov->providerName << " has not port named '" << prov->portName << "'"<< std::endl;
                 throw std::runtime_error("Error, task " + prov->providerName + " has not port named '" + prov->portName + "'");
                 return false;
             }
-            if(!port->connectTo(dynamicTransformsPort, conPolicy))
+            if(!transportSelector.connect(port, dynamicTransformsPort, prov->providerName + "." + prov->portName, conPolicy))
             {
                 throw std::runtime_error("Error, could not connect " + prov->providerName + "." + prov->portName + " to " + task->getName() + "." + dynamicTransformsPort->getName() );
             }
@@ -138,3 +149,8 @@ void TransformerHelper::setConnectionPolicy(RTT::ConnPolicy& policy)
     conPolicy = policy;
 }
 
+TransportSelector& TransformerHelper::getTransportSelector()
+{
+    return transportSelector;
+}
+
@@ -3,6 +3,8 @@
 
 #include <rtt/TaskContext.hpp>
 #include <smurf/Smurf.hpp>
+#include "TransportSelector.hpp"
+#include <future>
 
 namespace orocos_cpp
 {
@@ -12,14 +14,27 @@ class TransformerHelper
 private:
     static const size_t DEFAULT_CONNECTION_BUFFER_SIZE = 500;
     RTT::ConnPolicy conPolicy;
+    TransportSelector transportSelector;
     smurf::Robot robotConfiguration;
 public:
     TransformerHelper(const smurf::Robot &robotConfiguration);
     
     bool configureTransformer(RTT::TaskContext *task);
+
+    /**
+     * Asynchronous variant of configureTransformer, executed by Executor::getDefault().
+     * The helper and the task must stay valid until the future is ready.
+     * */
+    std::future<bool> configureTransformerAsync(RTT::TaskContext *task);
     
     const RTT::ConnPolicy &getConnectionPolicy();
     void setConnectionPolicy(RTT::ConnPolicy &policy);
+
+    /**
+     * Returns the transport selection used to connect the
+     * transformation providers. Ports are named "provider.port".
+     * */
+    TransportSelector &getTransportSelector();
 };
 
 }//end of namespace
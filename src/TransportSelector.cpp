@@ -0,0 +1,144 @@
+#include "TransportSelector.hpp"
+#include "Tracing.hpp"
+#include <rtt/types/TypeInfo.hpp>
+#include <rtt/transports/corba/corba.h>
+#include <rtt/transports/mqueue/MQLib.hpp>
+#include <rtt/typelib/TypelibMarshallerBase.hpp>
+#include <typelib/typemodel.hh>
+#include <iostream>
+
+using namespace orocos_cpp;
+
+namespace
+{
+
+bool isFixedSize(const Typelib::Type &type)
+{
+    switch(type.getCategory())
+    {
+        case Typelib::Type::Numeric:
+        case Typelib::Type::Enum:
+            return true;
+        case Typelib::Type::Array:
+            return isFixedSize(static_cast<const Typelib::Array &>(type).getIndirection());
+        case Typelib::Type::Compound:
+        {
+            const Typelib::Compound::FieldList &fields(static_cast<const Typelib::Compound &>(type).getFields());
+            for(const Typelib::Field &field: fields)
+            {
+                if(!isFixedSize(field.getType()))
+                    return false;
+            }
+            return true;
+        }
+        default:
+            //containers, opaques and pointers
+            return false;
+    }
+}
+
+}
+
+TransportSelector::TransportSelector(TransportSelector::Transport defaultTransport) : defaultTransport(defaultTransport)
+{
+}
+
+void TransportSelector::setDefaultTransport(TransportSelector::Transport transport)
+{
+    defaultTransport = transport;
+}
+
+TransportSelector::Transport TransportSelector::getDefaultTransport() const
+{
+    return defaultTransport;
+}
+
+void TransportSelector::setPortTransport(const std::string& portName, TransportSelector::Transport transport)
+{
+    portTransports[portName] = transport;
+}
+
+void TransportSelector::setPortDataSize(const std::string& portName, int dataSize)
+{
+    portDataSizes[portName] = dataSize;
+}
+
+bool TransportSelector::supportsTransport(const RTT::base::PortInterface* port, int protocolId)
+{
+    const RTT::types::TypeInfo *typeInfo = port->getTypeInfo();
+    if(!typeInfo)
+        return false;
+
+    return typeInfo->getProtocol(protocolId) != nullptr;
+}
+
+bool TransportSelector::hasFixedSize(const RTT::base::PortInterface* port)
+{
+    const RTT::types::TypeInfo *typeInfo = port->getTypeInfo();
+    if(!typeInfo)
+        return false;
+
+    orogen_transports::TypelibMarshallerBase *typelibTransport =
+            dynamic_cast<orogen_transports::TypelibMarshallerBase*>(
+                    typeInfo->getProtocol(orogen_transports::TYPELIB_MARSHALLER_ID));
+    if(!typelibTransport)
+        return false;
+
+    const Typelib::Type *type = typelibTransport->getRegistry().get(typelibTransport->getMarshallingType());
+    return type && isFixedSize(*type);
+}
+
+std::string TransportSelector::toString(TransportSelector::Transport transport)
+{
+    switch(transport)
+    {
+        case AUTO:
+            return "auto";
+        case CORBA:
+            return "corba";
+        case MQUEUE:
+            return "mqueue";
+    }
+    return "unknown";
+}
+
+TransportSelector::Transport TransportSelector::selectTransport(const RTT::base::PortInterface* port, const std::string& portName) const
+{
+    Transport transport = defaultTransport;
+    auto it = portTransports.find(portName);
+    if(it != portTransports.end())
+        transport = it->second;
+
+    if(transport != AUTO)
+        return transport;
+
+    if(!supportsTransport(port, ORO_MQUEUE_PROTOCOL_ID))
+        return CORBA;
+
+    //without a known sample size, variable sized samples may not fit the queue
+    if(portDataSizes.count(portName) || hasFixedSize(port))
+        return MQUEUE;
+
+    return CORBA;
+}
+
+bool TransportSelector::connect(RTT::base::PortInterface* outPort, RTT::base::PortInterface* inPort, const std::string& portName, const RTT::ConnPolicy& policy) const
+{
+    OROCOS_CPP_TRACE_SCOPE("TransportSelector::connect", portName);
+
+    if(selectTransport(outPort, portName) == MQUEUE)
+    {
+        RTT::ConnPolicy mqPolicy(policy);
+        mqPolicy.transport = ORO_MQUEUE_PROTOCOL_ID;
+        auto sizeIt = portDataSizes.find(portName);
+        if(sizeIt != portDataSizes.end())
+            mqPolicy.data_size = sizeIt->second;
+
+        if(outPort->connectTo(inPort, mqPolicy))
+            return true;
+
+        std::cout << "TransportSelector: Warning, mqueue connection of " << portName << " failed, falling back to CORBA" << std::endl;
+    }
+
+    return outPort->connectTo(inPort, policy);
+}
@@ -0,0 +1,88 @@
+#ifndef TRANSPORTSELECTOR_H
+#define TRANSPORTSELECTOR_H
+
+#include <rtt/ConnPolicy.hpp>
+#include <rtt/base/PortInterface.hpp>
+#include <map>
+#include <string>
+
+namespace orocos_cpp
+{
+
+/**
+ * Selects the transport used to connect two ports.
+ *
+ * The default transport is CORBA. In AUTO mode, connections are first
+ * tried using the mqueue transport, if the type of the port supports
+ * it and the size of its samples is known. This is the case for types
+ * of fixed size (no containers or opaques), for other types the
+ * expected sample size must be given using setPortDataSize, otherwise
+ * CORBA is used. As mqueues only work between processes on the same
+ * host, the connection fails for tasks on different hosts, in this
+ * case CORBA is used as well.
+ *
+ * Note, the size of a mqueue message is limited by
+ * /proc/sys/fs/mqueue/msgsize_max.
+ * */
+class TransportSelector
+{
+public:
+    enum Transport
+    {
+        AUTO,
+        CORBA,
+        MQUEUE,
+    };
+
+    TransportSelector(Transport defaultTransport = CORBA);
+
+    void setDefaultTransport(Transport transport);
+    Transport getDefaultTransport() const;
+
+    /**
+     * Overrides the transport for the given port.
+     * @param portName The full name of the output port, e.g. "camera.frame"
+     * */
+    void setPortTransport(const std::string &portName, Transport transport);
+
+    /**
+     * Sets the size of the marshalled sample for mqueue connections
+     * of the given port (ConnPolicy::data_size).
+     * */
+    void setPortDataSize(const std::string &portName, int dataSize);
+
+    /**
+     * Returns the transport that would be tried first for the given port.
+     * */
+    Transport selectTransport(const RTT::base::PortInterface *port, const std::string &portName) const;
+
+    /**
+     * Connects the two ports using the selected transport, with fallback
+     * to CORBA.
+     * @param portName The full name of the output port, used to look up overrides
+     * @return true on success
+     * */
+    bool connect(RTT::base::PortInterface *outPort, RTT::base::PortInterface *inPort, const std::string &portName, const RTT::ConnPolicy &policy) const;
+
+    /**
+     * Returns true if the type of the given port can be transported using
+     * the transport with the given protocol id.
+     * */
+    static bool supportsTransport(const RTT::base::PortInterface *port, int protocolId);
+
+    /**
+     * Returns true if the marshalled samples of the port have a fixed
+     * size, i.e. its typelib type contains no containers or opaques.
+     * */
+    static bool hasFixedSize(const RTT::base::PortInterface *port);
+
+    static std::string toString(Transport transport);
+
+private:
+    Transport defaultTransport;
+    std::map<std::string, Transport> portTransports;
+    std::map<std::string, int> portDataSizes;
+};
+
+}//end of namespace
+#endif // TRANSPORTSELECTOR_H
@@ -8,10 +8,12 @@ namespace orocos_cpp
 
 TypeRegistry::TypeRegistry()
 {
-    typeToTypekit.insert(std::make_pair("int", "rtt-types"));
-    typeToTypekit.insert(std::make_pair("bool", "rtt-types"));
-    typeToTypekit.insert(std::make_pair("string", "rtt-types"));
-    typeToTypekit.insert(std::make_pair("double", "rtt-types"));
+    std::map<std::string, std::string> builtins;
+    builtins.insert(std::make_pair("int", "rtt-types"));
+    builtins.insert(std::make_pair("bool", "rtt-types"));
+    builtins.insert(std::make_pair("string", "rtt-types"));
+    builtins.insert(std::make_pair("double", "rtt-types"));
+    typeToTypekit.insertAll(builtins);
 }
 
 bool TypeRegistry::loadTypelist()
@@ -25,6 +27,9 @@ bool TypeRegistry::loadTypelist()
     boost::filesystem::path orogenPath(std::string(pathsC) + "/../orogen");
     
     std::string ending(".typelist");
+
+    //collected first and published at once, readers never see a partial list
+    std::map<std::string, std::string> loaded;
     
     for(auto it = boost::filesystem::directory_iterator(orogenPath); it != boost::filesystem::directory_iterator(); it++)
     {
@@ -56,23 +61,19 @@ bool TypeRegistry::loadTypelist()
                 std::string typeName = line.substr(0, e);
 //                 std::cout << "Adding " <<  typeName << " to TK " << typeKitName << std::endl;
                 
-                typeToTypekit.insert(std::make_pair(typeName, typeKitName));
+                loaded.insert(std::make_pair(typeName, typeKitName));
             }
         }
     }
+
+    typeToTypekit.insertAll(loaded);
     
     return true;
 }
 
-bool TypeRegistry::getTypekitDefiningType(const std::string& typeName, std::string& typekitName)
+bool TypeRegistry::getTypekitDefiningType(const std::string& typeName, std::string& typekitName) const
 {
-    auto it = typeToTypekit.find(typeName);
-    if(it == typeToTypekit.end())
-        return false;
-    
-    typekitName = it->second;
-    
-    return true;
+    return typeToTypekit.find(typeName, typekitName);
 }
 
 }
\ No newline at end of file
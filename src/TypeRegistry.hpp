@@ -2,19 +2,21 @@
 
 #include <string>
 #include <map>
+#include "ConcurrentMap.hpp"
 
 namespace orocos_cpp
 {
 
 class TypeRegistry
 {
-    std::map<std::string, std::string> typeToTypekit;
+    ///may be read from several threads while a typelist is loaded
+    ConcurrentMap<std::string, std::string> typeToTypekit;
 public:
     TypeRegistry();
     
     bool loadTypelist();
     
-    bool getTypekitDefiningType(const std::string &typeName, std::string &typekitName);
+    bool getTypekitDefiningType(const std::string &typeName, std::string &typekitName) const;
 };
 
 }
@@ -0,0 +1,271 @@
+#include "TypekitManifest.hpp"
+#include "PluginHelper.hpp"
+#include "Tracing.hpp"
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+
+using namespace orocos_cpp;
+
+const unsigned TypekitManifest::MAX_UNUSED_RUNS;
+
+namespace
+{
+
+const char MANIFEST_HEADER[] = "orocos_cpp typekit manifest 1";
+
+struct ManifestState
+{
+    std::mutex mutex;
+    ///empty while not recording
+    std::string fileName;
+    ///manifest of the previous run
+    std::vector<TypekitManifest::Entry> previous;
+    ///typekits used in this run, in order of first use
+    std::vector<std::string> used;
+    std::set<std::string> failed;
+    std::vector<TypekitManifest::Entry> written;
+    std::thread preloader;
+    ///checked by the preloader between typekits
+    std::atomic<bool> stopRequested{false};
+};
+
+ManifestState &getState()
+{
+    static ManifestState state;
+    return state;
+}
+
+///set in the preload thread, its loads are no uses
+thread_local bool isPreloading = false;
+
+bool isEqual(const std::vector<TypekitManifest::Entry> &a, const std::vector<TypekitManifest::Entry> &b)
+{
+    if(a.size() != b.size())
+        return false;
+    for(size_t i = 0; i < a.size(); i++)
+    {
+        if(a[i].typekit != b[i].typekit || a[i].unusedRuns != b[i].unusedRuns)
+            return false;
+    }
+    return true;
+}
+
+}
+
+std::string TypekitManifest::getManifestPath(const std::string& application)
+{
+    std::string cacheDir;
+    const char *xdgCache = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    if(xdgCache && *xdgCache)
+        cacheDir = xdgCache;
+    else if(home)
+        cacheDir = std::string(home) + "/.cache";
+    else
+        cacheDir = "/tmp";
+
+    return cacheDir + "/orocos_cpp/" + application + ".typekits";
+}
+
+bool TypekitManifest::read(const std::string& fileName, std::vector< Entry >& entries)
+{
+    std::ifstream in(fileName.c_str());
+    if(!in.good())
+        return false;
+
+    std::string header;
+    if(!std::getline(in, header) || header != MANIFEST_HEADER)
+    {
+        std::cout << "TypekitManifest::read : Warning, " << fileName << " is no typekit manifest, ignoring it" << std::endl;
+        return false;
+    }
+
+    entries.clear();
+    Entry entry;
+    while(in >> entry.typekit >> entry.unusedRuns)
+        entries.push_back(entry);
+
+    return in.eof();
+}
+
+bool TypekitManifest::write(const std::string& fileName, const std::vector< Entry >& entries)
+{
+    boost::system::error_code error;
+    boost::filesystem::create_directories(boost::filesystem::path(fileName).parent_path(), error);
+
+    const std::string tmpName = fileName + ".tmp";
+    {
+        std::ofstream out(tmpName.c_str(), std::ios::trunc);
+        if(!out.good())
+            return false;
+
+        out << MANIFEST_HEADER << std::endl;
+        for(const Entry &entry: entries)
+            out << entry.typekit << " " << entry.unusedRuns << std::endl;
+
+        if(!out.good())
+        {
+            remove(tmpName.c_str());
+            return false;
+        }
+    }
+
+    if(rename(tmpName.c_str(), fileName.c_str()) != 0)
+    {
+        remove(tmpName.c_str());
+        return false;
+    }
+    return true;
+}
+
+void TypekitManifest::start(const std::string& application, bool preload)
+{
+    ManifestState &state(getState());
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if(!state.fileName.empty())
+        return;
+
+    state.fileName = getManifestPath(application);
+    read(state.fileName, state.previous);
+    state.written = state.previous;
+
+    std::vector<std::string> typekits;
+    for(const Entry &entry: state.previous)
+        typekits.push_back(entry.typekit);
+
+    if(preload && !typekits.empty())
+    {
+        //registered after the state was constructed, so it runs before its destruction
+        if(atexit(&TypekitManifest::stop) != 0)
+        {
+            std::cout << "TypekitManifest::start : Warning, could not register exit handler, not preloading" << std::endl;
+            return;
+        }
+        state.preloader = std::thread(&TypekitManifest::preload, typekits);
+    }
+}
+
+void TypekitManifest::preload(const std::vector< std::string >& typekits)
+{
+    OROCOS_CPP_TRACE_SCOPE("TypekitManifest::preload");
+    isPreloading = true;
+
+    ManifestState &state(getState());
+    for(const std::string &typekit: typekits)
+    {
+        if(state.stopRequested)
+            break;
+
+        std::string error;
+        try {
+            if(!PluginHelper::loadTypekitAndTransports(typekit))
+                error = "loading failed";
+        } catch (const std::runtime_error &e)
+        {
+            error = e.what();
+        }
+
+        if(!error.empty())
+        {
+            std::cout << "TypekitManifest::preload : Warning, could not preload typekit " << typekit << " : " << error << std::endl;
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.failed.insert(typekit);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    save();
+}
+
+void TypekitManifest::waitForPreload()
+{
+    ManifestState &state(getState());
+    std::thread preloader;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        preloader.swap(state.preloader);
+    }
+    if(preloader.joinable())
+        preloader.join();
+}
+
+void TypekitManifest::stop()
+{
+    getState().stopRequested = true;
+    waitForPreload();
+}
+
+void TypekitManifest::recordUse(const std::string& typekit)
+{
+    if(isPreloading)
+        return;
+
+    ManifestState &state(getState());
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if(state.fileName.empty())
+        return;
+    if(std::find(state.used.begin(), state.used.end(), typekit) != state.used.end())
+        return;
+
+    state.used.push_back(typekit);
+    state.failed.erase(typekit);
+    save();
+}
+
+bool TypekitManifest::isRecording()
+{
+    ManifestState &state(getState());
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return !state.fileName.empty();
+}
+
+void TypekitManifest::save()
+{
+    //called with the state locked
+    ManifestState &state(getState());
+
+    //keep the order of the last run, the base typekits come first
+    std::vector<Entry> entries;
+    for(const Entry &entry: state.previous)
+    {
+        Entry updated(entry);
+        if(std::find(state.used.begin(), state.used.end(), entry.typekit) != state.used.end())
+            updated.unusedRuns = 0;
+        else if(state.failed.count(entry.typekit) || ++updated.unusedRuns > MAX_UNUSED_RUNS)
+            continue;
+        entries.push_back(updated);
+    }
+
+    for(const std::string &typekit: state.used)
+    {
+        bool known = false;
+        for(const Entry &entry: state.previous)
+            known = known || entry.typekit == typekit;
+        if(known)
+            continue;
+
+        Entry entry;
+        entry.typekit = typekit;
+        entry.unusedRuns = 0;
+        entries.push_back(entry);
+    }
+
+    if(isEqual(entries, state.written))
+        return;
+
+    if(!write(state.fileName, entries))
+    {
+        std::cout << "TypekitManifest::save : Warning, could not write " << state.fileName << std::endl;
+        return;
+    }
+    state.written = entries;
+}
@@ -0,0 +1,84 @@
+#ifndef TYPEKITMANIFEST_H
+#define TYPEKITMANIFEST_H
+
+#include <string>
+#include <vector>
+
+namespace orocos_cpp
+{
+
+/**
+ * Records the typekits an application uses into a manifest file, and
+ * preloads them on the next start of the application.
+ *
+ * Recording is off until start() is called. From then on, every typekit
+ * that is requested through PluginHelper counts as used, and the
+ * manifest is rewritten whenever a new one shows up. The typekits of the
+ * previous run are loaded in a background thread meanwhile, so that they
+ * are usually present before the first task is contacted. Requests of
+ * the application for a typekit that is still being preloaded simply
+ * wait for it.
+ *
+ * The manifest is reconciled on every run: typekits that fail to load
+ * are dropped, typekits that were not used for MAX_UNUSED_RUNS runs in
+ * a row are dropped, and newly used typekits are added.
+ * */
+class TypekitManifest
+{
+public:
+    static const unsigned MAX_UNUSED_RUNS = 3;
+
+    struct Entry
+    {
+        std::string typekit;
+        ///number of consecutive runs the typekit was preloaded but not used
+        unsigned unusedRuns;
+    };
+
+    /**
+     * Starts recording into the manifest of the given application
+     * and preloads the typekits of the last run in the background.
+     * Calling start again has no effect.
+     * */
+    static void start(const std::string &application, bool preload = true);
+
+    /**
+     * Blocks until the background preload is done
+     * */
+    static void waitForPreload();
+
+    /**
+     * Stops the background preload after the typekit currently loading
+     * and waits for it. Registered with atexit by start, so the
+     * preloader is gone before static destruction begins.
+     * */
+    static void stop();
+
+    /**
+     * Notes that the application needs the given typekit.
+     * Called by PluginHelper, ignored if recording is off.
+     * */
+    static void recordUse(const std::string &typekit);
+
+    static bool isRecording();
+
+    /**
+     * <cache dir>/orocos_cpp/<application>.typekits, where cache dir is
+     * $XDG_CACHE_HOME or $HOME/.cache
+     * */
+    static std::string getManifestPath(const std::string &application);
+
+    static bool read(const std::string &fileName, std::vector<Entry> &entries);
+
+    /**
+     * Writes the manifest, replacing the file atomically
+     * */
+    static bool write(const std::string &fileName, const std::vector<Entry> &entries);
+
+private:
+    static void preload(const std::vector<std::string> &typekits);
+    static void save();
+};
+
+}//end of namespace
+#endif // TYPEKITMANIFEST_H
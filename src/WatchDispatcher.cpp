@@ -0,0 +1,109 @@
+#include "WatchDispatcher.hpp"
+#include <iostream>
+
+using namespace orocos_cpp;
+
+WatchDispatcher::WatchDispatcher() : nextId(0)
+{
+}
+
+int WatchDispatcher::add(const NameService::WatchCallback& callback)
+{
+    std::shared_ptr<Watcher> watcher(std::make_shared<Watcher>());
+    watcher->callback = callback;
+    watcher->initialized = false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    int id = nextId++;
+    watchers[id] = watcher;
+    return id;
+}
+
+bool WatchDispatcher::remove(int watchId)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return watchers.erase(watchId);
+}
+
+bool WatchDispatcher::empty() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return watchers.empty();
+}
+
+std::vector< NameService::ChangeEvent > WatchDispatcher::diff(const Snapshot& from, const Snapshot& to)
+{
+    std::vector<NameService::ChangeEvent> events;
+
+    //both maps are sorted, walk them in parallel
+    Snapshot::const_iterator oldIt = from.begin();
+    Snapshot::const_iterator newIt = to.begin();
+    while(oldIt != from.end() || newIt != to.end())
+    {
+        NameService::ChangeEvent event;
+        if(newIt == to.end() || (oldIt != from.end() && oldIt->first < newIt->first))
+        {
+            event.type = NameService::ChangeEvent::REMOVED;
+            event.taskName = oldIt->first;
+            event.ior = oldIt->second;
+            events.push_back(event);
+            oldIt++;
+        }
+        else if(oldIt == from.end() || newIt->first < oldIt->first)
+        {
+            event.type = NameService::ChangeEvent::ADDED;
+            event.taskName = newIt->first;
+            event.ior = newIt->second;
+            events.push_back(event);
+            newIt++;
+        }
+        else
+        {
+            if(oldIt->second != newIt->second)
+            {
+                event.type = NameService::ChangeEvent::IOR_CHANGED;
+                event.taskName = newIt->first;
+                event.ior = newIt->second;
+                events.push_back(event);
+            }
+            oldIt++;
+            newIt++;
+        }
+    }
+    return events;
+}
+
+void WatchDispatcher::publish(const Snapshot& snapshot)
+{
+    std::vector<NameService::ChangeEvent> events(diff(last, snapshot));
+    last = snapshot;
+
+    std::vector<std::shared_ptr<Watcher> > current;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for(const std::pair<const int, std::shared_ptr<Watcher> > &entry: watchers)
+            current.push_back(entry.second);
+    }
+
+    for(const std::shared_ptr<Watcher> &watcher: current)
+    {
+        const std::vector<NameService::ChangeEvent> *toSend = &events;
+        std::vector<NameService::ChangeEvent> initial;
+        if(!watcher->initialized)
+        {
+            initial = diff(Snapshot(), snapshot);
+            toSend = &initial;
+            watcher->initialized = true;
+        }
+
+        for(const NameService::ChangeEvent &event: *toSend)
+        {
+            try {
+                watcher->callback(event);
+            } catch (const std::exception &e)
+            {
+                std::cout << "WatchDispatcher::publish : Error, watch callback threw " << e.what() << std::endl;
+            }
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef WATCHDISPATCHER_H
+#define WATCHDISPATCHER_H
+
+#include "NameService.hpp"
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace orocos_cpp
+{
+
+/**
+ * Bookkeeping for NameService::watch.
+ *
+ * The backends hand in complete snapshots (task name to IOR) whenever
+ * they notice something, the dispatcher diffs each snapshot against the
+ * previous one and calls the watchers with the resulting events.
+ * Watchers added later first get an ADDED event for every task of the
+ * current snapshot.
+ * */
+class WatchDispatcher
+{
+public:
+    typedef std::map<std::string, std::string> Snapshot;
+
+    WatchDispatcher();
+
+    /**
+     * @return the id of the watch, for remove()
+     * */
+    int add(const NameService::WatchCallback &callback);
+
+    /**
+     * @return false if the id is unknown
+     * */
+    bool remove(int watchId);
+
+    bool empty() const;
+
+    /**
+     * Diffs the snapshot against the last one and notifies the watchers.
+     * Must only be called from one thread at a time, the callbacks are
+     * called from it without any lock held.
+     * */
+    void publish(const Snapshot &snapshot);
+
+    /**
+     * Computes the events leading from one snapshot to the other
+     * */
+    static std::vector<NameService::ChangeEvent> diff(const Snapshot &from, const Snapshot &to);
+
+private:
+    struct Watcher
+    {
+        NameService::WatchCallback callback;
+        ///got the ADDED events of the current snapshot
+        bool initialized;
+    };
+
+    mutable std::mutex mutex;
+    int nextId;
+    std::map<int, std::shared_ptr<Watcher> > watchers;
+    Snapshot last;
+};
+
+}//end of namespace
+#endif // WATCHDISPATCHER_H
@@ -4,6 +4,7 @@
 #include "LoggingHelper.hpp"
 #include <lib_config/Bundle.hpp>
 #include "PluginHelper.hpp"
+#include <unistd.h>
 
 using namespace orocos_cpp;
 
@@ -71,6 +72,28 @@ int main(int argc, char **argv)
 //         }
     }
     
+    //keep printing the changes of the registrations
+    if(argc > 1 && std::string(argv[1]) == "--watch")
+    {
+        ns.watch([](const NameService::ChangeEvent &event) {
+            std::cout << "Task " << event.taskName << " ";
+            switch(event.type)
+            {
+                case NameService::ChangeEvent::ADDED:
+                    std::cout << "added";
+                    break;
+                case NameService::ChangeEvent::REMOVED:
+                    std::cout << "removed";
+                    break;
+                case NameService::ChangeEvent::IOR_CHANGED:
+                    std::cout << "changed IOR";
+                    break;
+            }
+            std::cout << std::endl;
+        });
+        while(true)
+            pause();
+    }
     
     return 0;
 }